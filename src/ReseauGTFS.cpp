@@ -4,6 +4,8 @@
 
 #include "ReseauGTFS.h"
 #include <sys/time.h>
+#include <algorithm>
+#include <tuple>
 
 using namespace std;
 
@@ -33,31 +35,179 @@ double ReseauGTFS::getDistMaxMarche() const
     return distanceMaxMarche;
 }
 
+unsigned int ReseauGTFS::getStationIdOrigine() const
+{
+    return stationIdOrigine;
+}
+
+unsigned int ReseauGTFS::getStationIdDestination() const
+{
+    return stationIdDestination;
+}
+
+const CacheItineraires & ReseauGTFS::getCache() const
+{
+    return m_cache;
+}
+
+//! \brief active ou désactive le cache des itinéraires (actif par défaut)
+//! \post lorsqu'on le désactive, le cache est vidé
+void ReseauGTFS::activerCache(bool p_actif)
+{
+    m_cacheActif = p_actif;
+    if (!p_actif) m_cache.vider();
+}
+
+const GrapheAbstrait & ReseauGTFS::getGraphe() const
+{
+    return *m_leGraphe;
+}
+
+//! \return le sommet du graphe associé à un arrêt des données ayant servi à construire ce réseau
+//! \throws logic_error si l'arrêt n'appartient pas au réseau
+size_t ReseauGTFS::getSommetDeArret(const Arret::Ptr &p_arret) const
+{
+    auto it = m_sommetDeArret.find(p_arret);
+    if (it == m_sommetDeArret.end()) throw logic_error("ReseauGTFS::getSommetDeArret(): arrêt absent du réseau");
+    return it->second;
+}
+
+//! \brief ajoute à p_rapport la mémoire du réseau: celle du graphe (GrapheAbstrait::mesurerMemoire()), puis
+//! reseau.sommetDeArret (l'arène de la table de hachage), reseau.arretDuSommet (les pointeurs; les objets Arret
+//! sont comptés avec les données GTFS), reseau.sommets (station et voyage de chaque sommet), reseau.voyages
+//! (trip_id et ligne de chaque voyage) et reseau.coordonnees (les stations et leurs distances aux points
+//! origine et destination)
+//! \note le cache des itinéraires n'est pas compté: sa taille est bornée par sa capacité
+void ReseauGTFS::mesurerMemoire(RapportMemoire &p_rapport) const
+{
+    m_leGraphe->mesurerMemoire(p_rapport);
+    //les noeuds et les alvéoles de la table proviennent de son arène
+    p_rapport.ajouter("reseau.sommetDeArret", m_arene.getOctetsReserves(), m_sommetDeArret.size());
+    p_rapport.ajouter("reseau.arretDuSommet", octetsVecteur(m_arretDuSommet), m_arretDuSommet.size());
+    p_rapport.ajouter("reseau.sommets", octetsVecteur(m_stationDuSommet) + octetsVecteur(m_voyageDuSommet),
+                      m_stationDuSommet.size());
+    size_t octets = octetsVecteur(m_idDuVoyage) + octetsVecteur(m_ligneDuVoyage);
+    for (const string &id : m_idDuVoyage) octets += octetsChaine(id);
+    p_rapport.ajouter("reseau.voyages", octets, m_idDuVoyage.size());
+    p_rapport.ajouter("reseau.coordonnees", 3 * octetsTas(m_coordsStations.taille() * sizeof(double)) +
+                                            octetsVecteur(m_distancesOrigine) + octetsVecteur(m_distancesDestination),
+                      m_coordsStations.taille());
+}
+
+//! \return le sommet de sortie de la première station de getStations(); ceux des suivantes sont consécutifs, et
+//! les sommets qui précèdent le premier sont ceux des arrêts
+size_t ReseauGTFS::getPremierSommetSortie() const
+{
+    return m_premierSommetSortie;
+}
+
+size_t ReseauGTFS::getNbSommetsSortie() const
+{
+    return m_nbSommetsSortie;
+}
+
+//! \return l'heure d'arrivée de l'arrêt d'un sommet, en secondes depuis minuit
+//! \throws logic_error si le sommet n'est pas celui d'un arrêt
+unsigned int ReseauGTFS::getHeureDuSommet(size_t p_sommet) const
+{
+    if (p_sommet >= m_arretDuSommet.size() || !m_arretDuSommet[p_sommet])
+        throw logic_error("ReseauGTFS::getHeureDuSommet(): le sommet n'est pas celui d'un arrêt");
+    return heureDuSommet(p_sommet);
+}
+
+//! \return l'indice (dans getIdDuVoyage()) du voyage de l'arrêt d'un sommet
+//! \throws logic_error si le sommet n'est pas celui d'un arrêt
+uint32_t ReseauGTFS::getVoyageDuSommet(size_t p_sommet) const
+{
+    if (p_sommet >= m_arretDuSommet.size() || !m_arretDuSommet[p_sommet])
+        throw logic_error("ReseauGTFS::getVoyageDuSommet(): le sommet n'est pas celui d'un arrêt");
+    return m_voyageDuSommet[p_sommet];
+}
+
+//! \return les trip_id des voyages, par indice (Troncon::voyage)
+const vector<string> & ReseauGTFS::getIdDuVoyage() const
+{
+    return m_idDuVoyage;
+}
+
+//! \return l'identifiant de la ligne du voyage d'indice p_voyage
+//! \throws logic_error si l'indice est hors limites
+unsigned int ReseauGTFS::getLigneDuVoyage(uint32_t p_voyage) const
+{
+    if (p_voyage >= m_ligneDuVoyage.size()) throw logic_error("ReseauGTFS::getLigneDuVoyage(): indice hors limites");
+    return m_ligneDuVoyage[p_voyage];
+}
+
+//! \return la vitesse de marche, en km/h
+double ReseauGTFS::getVitesseMarche() const
+{
+    return vitesseDeMarche;
+}
+
+const StatistiquesConstruction & ReseauGTFS::getStatistiquesConstruction() const
+{
+    return m_statsConstruction;
+}
+
+//! \return les compteurs de la dernière recherche effectuée par calculerItineraire() (nuls si l'itinéraire provenait du cache)
+const StatistiquesRecherche & ReseauGTFS::getStatistiquesRecherche() const
+{
+    return m_statsRecherche;
+}
+
 //! \brief construit le réseau GTFS à partir des données GTFS
 //! \param[in] Un objet DonneesGTFS
 //! \throws logic_error si une incohérence est détecté lors de la construction du graphe
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post initialise la variable m_origine_dest_ajoute à false car les points origine et destination ne font pas parti du graphe
 //! \post insère les données requises dans m_arretDuSommet et m_sommetDeArret et construit le graphe m_leGraphe
-ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
-: m_leGraphe(p_gtfs.getNbArrets()), m_origine_dest_ajoute(false)
+//! \post remplit m_stationDuSommet, m_voyageDuSommet, m_idDuVoyage et m_ligneDuVoyage pour le décodage des itinéraires
+//! \param[in] p_renumeroter: si vrai, les sommets sont renumérotés par heure (voir renumeroterSommets())
+//! \param[in] p_largeur: la largeur des numéros de sommets et des poids du graphe (voir creerGraphe());
+//! automatiquement, des poids de 16 bits sont choisis si l'intervalle [getTempsDebut(), getTempsFin()) dure moins de 65535 s
+//! \param[in] p_chemins: si non nul, des chemins à pieds (calculés ou chargés) ajoutés comme transferts supplémentaires
+ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs, bool p_renumeroter, LargeurGraphe p_largeur,
+                       const CheminsPietons *p_chemins)
+: m_sommetDeArret(p_gtfs.getNbArrets() + 2, TableSommets::hasher(), TableSommets::key_equal(),
+                  TableSommets::allocator_type(&m_arene)),
+  m_heureDepart(p_gtfs.getTempsDebut() - Heure(0, 0, 0)), m_origine_dest_ajoute(false),
+  m_cacheActif(true)
 {
 
     m_nbArcsStationsVersDestination = 0;
     m_nbArcsOrigineVersStations = 0;
+    GTFS_STAT(Chronometre chronometre);
+
+    //tout arc relie deux instants de l'intervalle, sauf la marche vers le point destination (bornée par distanceMaxMarche)
+    unsigned int poidsMax = max(static_cast<unsigned int>(p_gtfs.getTempsFin() - p_gtfs.getTempsDebut()),
+                                static_cast<unsigned int>(distanceMaxMarche / vitesseDeMarche * 3600) + 1);
+    const size_t nbSommets = p_gtfs.getNbArrets() + p_gtfs.getStations().size(); //un sommet de sortie par station
+    m_leGraphe = creerGraphe(nbSommets + 2, poidsMax, p_largeur); //+2: les points origine et destination
+    m_leGraphe->resize(p_gtfs.getNbArrets());
+    //les arcs des voyages, d'attente et vers les sommets de sortie; les transferts s'y ajoutent
+    m_leGraphe->reserverArcs(3 * p_gtfs.getNbArrets());
+    m_arretDuSommet.reserve(nbSommets + 2);
+    m_stationDuSommet.reserve(nbSommets + 2);
+    m_voyageDuSommet.reserve(nbSommets + 2);
+    for (const auto &stationPair : p_gtfs.getStations()) m_coordsStations.ajouter(stationPair.second.getCoords());
 
     //ajout des arcs dus aux voyages et mise à jour de m_sommetDeArret ey m_arretDuSommet
 
-    auto voyages = p_gtfs.getVoyages();
+    const auto &voyages = p_gtfs.getVoyages();
 
     for (auto it = voyages.begin() ; it != voyages.end() ; ++it) {
-        std::set<Arret::Ptr, Voyage::compArret> arrets = it->second.getArrets();
+        const std::set<Arret::Ptr, Voyage::compArret> &arrets = it->second.getArrets();
+        uint32_t indiceVoyage = static_cast<uint32_t>(m_idDuVoyage.size());
+        m_idDuVoyage.push_back(it->first);
+        m_ligneDuVoyage.push_back(it->second.getLigne());
 
 
         for (auto it2 = arrets.begin() ; it2 != arrets.end() ; ++it2) {
 
             m_arretDuSommet.push_back(*it2);
             m_sommetDeArret.insert({*it2, (m_arretDuSommet.size() - 1)});
+            m_stationDuSommet.push_back((*it2)->getStationId());
+            m_voyageDuSommet.push_back(indiceVoyage);
 
             if (it2 != arrets.begin()) {
                 Arret::Ptr currentStop = *it2;
@@ -69,7 +219,7 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
                     throw std::logic_error("ReseauGTFS::ReseauGTFS() : Negative weight");
                 }
 
-                m_leGraphe.ajouterArc(m_sommetDeArret[prevStop], m_sommetDeArret[currentStop], weight);
+                m_leGraphe->ajouterArc(m_sommetDeArret[prevStop], m_sommetDeArret[currentStop], weight);
              //   std::cout << "origine: " << m_sommetDeArret[prevStop] << " destination: " << m_sommetDeArret[currentStop] << " poids: " << weight <<std::endl;
             }
 
@@ -77,6 +227,8 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
 
     }
 
+    GTFS_STAT(m_statsConstruction.arcsVoyages = chronometre.arreter("ReseauGTFS::arcsVoyages"));
+
     //ajout des arcs dus aux attentes à chaque station
 
     // std::cout << "-----------------------" << std::endl;
@@ -85,11 +237,11 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
     // std::cout << "-----------------------" << std::endl;
     // std::cout << "-----------------------" << std::endl;
 
-    auto stationMap = p_gtfs.getStations();
+    const auto &stationMap = p_gtfs.getStations();
 
-    for (auto stationPair : stationMap) {
+    for (const auto &stationPair : stationMap) {
 
-        auto stationStops = stationPair.second.getArrets();
+        const auto &stationStops = stationPair.second.getArrets();
 
         for (auto it = stationStops.begin() ; it != stationStops.end() ; ++it) {
 
@@ -102,13 +254,15 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
                 if (weight < 0) {
                     throw std::logic_error("ReseauGTFS::ReseauGTFS() : Negative weight");
                 }
-                m_leGraphe.ajouterArc(m_sommetDeArret[prevStop], m_sommetDeArret[currentStop], weight);
+                m_leGraphe->ajouterArc(m_sommetDeArret[prevStop], m_sommetDeArret[currentStop], weight);
                //std::cout << "origine: " << m_sommetDeArret[prevStop] << " destination: " << m_sommetDeArret[currentStop] << " poids: " << weight <<std::endl;
             }
         }
 
     }
 
+    GTFS_STAT(m_statsConstruction.arcsAttente = chronometre.arreter("ReseauGTFS::arcsAttente"));
+
     //ajouts des arcs dus aux transferts entre stations
 
     // std::cout << "-----------------------" << std::endl;
@@ -117,7 +271,7 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
     // std::cout << "-----------------------" << std::endl;
     // std::cout << "-----------------------" << std::endl;
 
-    auto transferts = p_gtfs.getTransferts();
+    const auto &transferts = p_gtfs.getTransferts();
 
     // for (auto instance : p_gtfs.getTransferts()) {
 
@@ -133,43 +287,120 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
     //                 throw std::logic_error("ReseauGTFS::ReseauGTFS() : Negative weight");
     //             }
 
-    //             m_leGraphe.ajouterArc(m_sommetDeArret[arret.second], m_sommetDeArret[(*closestCandidate).second], weight);
+    //             m_leGraphe->ajouterArc(m_sommetDeArret[arret.second], m_sommetDeArret[(*closestCandidate).second], weight);
     //            // std::cout << "origine: " << m_sommetDeArret[arret.second] << " destination: " << m_sommetDeArret[(*closestCandidate).second] << " poids: " << weight <<std::endl;
     //         }
     //     }
     // }
 
-    for (auto instance : transferts) {
+    for (const auto &instance : transferts) {
+        ajouterArcsTransfert(stationMap, std::get<0>(instance), std::get<1>(instance), std::get<2>(instance));
+    }
+
+    //les chemins à pieds précalculés s'ajoutent comme autant de transferts
+    if (p_chemins) {
+        for (const auto &chemin : p_chemins->getChemins()) {
+            ajouterArcsTransfert(stationMap, std::get<0>(chemin), std::get<1>(chemin), std::get<2>(chemin));
+        }
+    }
+
+    //un sommet de sortie par station, après les arrêts: chaque arrêt y mène sans coût, et une requête n'ajoute
+    //qu'un arc par station proche (de sa sortie vers le point destination) plutôt qu'un arc par arrêt
+    m_premierSommetSortie = m_arretDuSommet.size();
+    m_nbSommetsSortie = stationMap.size();
+    m_leGraphe->resize(m_premierSommetSortie + m_nbSommetsSortie);
+    size_t sortie = m_premierSommetSortie;
+    for (const auto &stationPair : stationMap) {
+        m_arretDuSommet.push_back(Arret::Ptr());
+        m_stationDuSommet.push_back(stationPair.first);
+        m_voyageDuSommet.push_back(Troncon::aucunVoyage);
+        for (const auto &stop : stationPair.second.getArrets())
+            m_leGraphe->ajouterArc(m_sommetDeArret[stop.second], sortie, 0);
+        ++sortie;
+    }
+
+    GTFS_STAT(m_statsConstruction.arcsTransferts = chronometre.arreter("ReseauGTFS::arcsTransferts"));
 
-        unsigned int departure = std::get<0>(instance);
-        unsigned int destination = std::get<1>(instance);
-        unsigned int travelTime = std::get<2>(instance);
-        Station origin = stationMap[departure];
-        Station endPoint = stationMap[destination];
+    if (p_renumeroter)
+    {
+        renumeroterSommets();
+        GTFS_STAT(m_statsConstruction.renumerotation = chronometre.arreter("ReseauGTFS::renumerotation"));
+    }
+
+    m_origine_dest_ajoute = false;
+}
 
-        auto startStops = origin.getArrets();
-        auto destStops = endPoint.getArrets();
+//! \brief ajoute, pour chaque arrêt de la station p_depart, un arc vers le premier arrêt de la station p_arrivee
+//! atteignable après p_duree secondes de marche
+//! \note une station absente de p_stations (sans arrêt) n'a pas d'arc
+//! \throws logic_error si un poids négatif est détecté
+void ReseauGTFS::ajouterArcsTransfert(const std::map<unsigned int, Station> &p_stations, unsigned int p_depart,
+                                      unsigned int p_arrivee, unsigned int p_duree)
+{
+    auto origin = p_stations.find(p_depart);
+    auto endPoint = p_stations.find(p_arrivee);
+    if (origin == p_stations.end() || endPoint == p_stations.end()) return;
 
-        for (auto stop : startStops) {
+    const auto &startStops = origin->second.getArrets();
+    const auto &destStops = endPoint->second.getArrets();
 
-            Heure ETA = stop.second->getHeureArrivee().add_secondes(travelTime);
-            auto closestCandidate = destStops.lower_bound(ETA);
+    for (const auto &stop : startStops) {
 
-            if (closestCandidate != destStops.end()) {
+        Heure ETA = stop.second->getHeureArrivee().add_secondes(p_duree);
+        auto closestCandidate = destStops.lower_bound(ETA);
 
-                int weight = ((*closestCandidate).second->getHeureArrivee() - stop.second->getHeureArrivee());
-                if (weight < 0) {
-                    throw std::logic_error("ReseauGTFS::ReseauGTFS() : Negative weight");
-                }
+        if (closestCandidate != destStops.end()) {
 
-                m_leGraphe.ajouterArc(m_sommetDeArret[stop.second], m_sommetDeArret[(*closestCandidate).second], weight);
-                //std::cout << "origine: " << m_sommetDeArret[stop.second] << " destination: " << m_sommetDeArret[(*closestCandidate).second] << " poids: " << weight <<std::endl;
+            int weight = ((*closestCandidate).second->getHeureArrivee() - stop.second->getHeureArrivee());
+            if (weight < 0) {
+                throw std::logic_error("ReseauGTFS::ReseauGTFS() : Negative weight");
             }
-        }
 
+            m_leGraphe->ajouterArc(m_sommetDeArret[stop.second], m_sommetDeArret[(*closestCandidate).second], weight);
+        }
     }
+}
 
-    m_origine_dest_ajoute = false;
+//! \brief renumérote les sommets par heure d'arrivée, puis par station, puis par voyage
+//! \note tous les arcs du graphe avancent dans le temps et la distance d'un sommet atteint est son heure moins
+//! l'heure de départ: Dijkstra fixe donc les sommets dans l'ordre des nouveaux numéros, ce qui rend séquentiels
+//! les accès à distance[], à predecesseur[] et aux listes d'adjacence (au lieu de l'ordre des trip_id)
+//! \post m_arretDuSommet, m_sommetDeArret, m_stationDuSommet et m_voyageDuSommet sont mis à jour
+//! \post les sommets de sortie (sans heure) restent les derniers, dans l'ordre des stations
+//! \pre les points origine et destination ne sont pas ajoutés
+void ReseauGTFS::renumeroterSommets()
+{
+    const size_t nbSommets = m_arretDuSommet.size();
+    vector<size_t> ordre(nbSommets);
+    vector<unsigned int> heure(nbSommets);
+    for (size_t i = 0; i < nbSommets; ++i)
+    {
+        ordre[i] = i;
+        heure[i] = m_arretDuSommet[i] ? heureDuSommet(i) : numeric_limits<unsigned int>::max();
+    }
+    sort(ordre.begin(), ordre.end(), [&](size_t a, size_t b)
+    {
+        return tie(heure[a], m_stationDuSommet[a], m_voyageDuSommet[a], a) <
+               tie(heure[b], m_stationDuSommet[b], m_voyageDuSommet[b], b);
+    });
+
+    vector<size_t> nouveauNumero(nbSommets);
+    for (size_t j = 0; j < nbSommets; ++j) nouveauNumero[ordre[j]] = j;
+    m_leGraphe->renumeroter(nouveauNumero);
+
+    vector<Arret::Ptr> arretDuSommet(nbSommets);
+    vector<unsigned int> stationDuSommet(nbSommets);
+    vector<uint32_t> voyageDuSommet(nbSommets);
+    for (size_t j = 0; j < nbSommets; ++j)
+    {
+        arretDuSommet[j] = m_arretDuSommet[ordre[j]];
+        stationDuSommet[j] = m_stationDuSommet[ordre[j]];
+        voyageDuSommet[j] = m_voyageDuSommet[ordre[j]];
+        if (arretDuSommet[j]) m_sommetDeArret[arretDuSommet[j]] = j;
+    }
+    m_arretDuSommet.swap(arretDuSommet);
+    m_stationDuSommet.swap(stationDuSommet);
+    m_voyageDuSommet.swap(voyageDuSommet);
 }
 
 //! \brief ajoute des arcs au réseau GTFS à partir des données GTFS
@@ -181,6 +412,7 @@ ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post assigne la variable m_origine_dest_ajoute à true (car les points orignine et destination font parti du graphe)
 //! \post insère dans m_sommetsVersDestination les numéros de sommets connctés au point destination
+//! \post m_cleRequete est la clé de cache de cette requête
 void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
    const Coordonnees &p_pointDestination)
 {
@@ -189,28 +421,42 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
     Arret::Ptr origine(new Arret(stationIdOrigine, Heure(0,0,0), Heure(0,0,0), 0, "42"));
     Arret::Ptr destination(new Arret(stationIdDestination, Heure(0,0,0), Heure(0,0,0), 99999, "45"));
 
-    m_leGraphe.resize(m_leGraphe.getNbSommets() + 2);
+    m_leGraphe->resize(m_leGraphe->getNbSommets() + 2);
     m_arretDuSommet.push_back(origine);
     m_sommetDeArret.insert({origine, (m_arretDuSommet.size() - 1)});
     m_sommetOrigine = m_sommetDeArret[origine];
+    m_stationDuSommet.push_back(stationIdOrigine);
+    m_voyageDuSommet.push_back(Troncon::aucunVoyage);
 
     m_arretDuSommet.push_back(destination);
     m_sommetDeArret.insert({destination, m_arretDuSommet.size() - 1});
     m_sommetDestination = m_sommetDeArret[destination];
+    m_stationDuSommet.push_back(stationIdDestination);
+    m_voyageDuSommet.push_back(Troncon::aucunVoyage);
 
     //ajout des arcs à pieds entre le point source et les arrets des stations atteignables
+    //(distances par lots d'abord; operator- n'est appelé que pour les stations proches)
 
-    auto stationMap = p_gtfs.getStations();
+    const auto &stationMap = p_gtfs.getStations();
+    if (m_coordsStations.taille() != stationMap.size()) {
+        m_coordsStations.vider();
+        for (const auto &stationPair : stationMap) m_coordsStations.ajouter(stationPair.second.getCoords());
+    }
+    m_coordsStations.distancesDepuis(p_pointOrigine, m_distancesOrigine);
+    m_coordsStations.distancesDepuis(p_pointDestination, m_distancesDestination);
+    const double seuil = distanceMaxMarche + TableCoordonnees::margeOperateur;
 
-    for (auto stationPair : stationMap) {
+    size_t indiceStation = 0;
+    for (const auto &stationPair : stationMap) {
 
+        if (m_distancesOrigine[indiceStation++] > seuil) continue;
         Coordonnees stationCoords = stationPair.second.getCoords();
         double distance = stationCoords - p_pointOrigine;
 
         if (distance <= distanceMaxMarche) {
 
             double travelTime = (distance / vitesseDeMarche) * 3600;
-            auto stationStops = stationPair.second.getArrets();
+            const auto &stationStops = stationPair.second.getArrets();
             Heure startingHour = p_gtfs.getTempsDebut().add_secondes(travelTime);
             auto closestCandidate = stationStops.lower_bound(startingHour);
 
@@ -220,7 +466,7 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
                 if (weight < 0) {
                     throw std::logic_error("ReseauGTFS::ajouterArcsOrigineDestination() : Negative weight");
                 }
-                m_leGraphe.ajouterArc(m_sommetOrigine, m_sommetDeArret[(*closestCandidate).second], weight);
+                m_leGraphe->ajouterArc(m_sommetOrigine, m_sommetDeArret[(*closestCandidate).second], weight);
                 //std::cout << "origine: " <<m_sommetOrigine << " destination: " << m_sommetDeArret[(*closestCandidate).second] << " poids: " << weight <<std::endl;
                 ++m_nbArcsOrigineVersStations;
 
@@ -229,42 +475,42 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
     }
 
 
-    //ajout des arcs à pieds des arrêts de certaine stations vers l'arret point destination
+    //ajout des arcs à pieds des sommets de sortie de certaines stations vers l'arret point destination
+    //(les arrêts de la station mènent déjà à son sommet de sortie)
 
-    for (auto stationPair : stationMap) {
+    if (stationMap.size() != m_nbSommetsSortie)
+        throw logic_error("ReseauGTFS::ajouterArcsOrigineDestination(): les données ne sont pas celles du réseau");
+    indiceStation = 0;
+    for (const auto &stationPair : stationMap) {
 
+        size_t sortie = m_premierSommetSortie + indiceStation;
+        if (m_distancesDestination[indiceStation++] > seuil) continue;
+        if (stationPair.second.getArrets().empty()) continue;
         Coordonnees stationCoords = stationPair.second.getCoords();
         double distance = p_pointDestination - stationCoords;
 
         if (distance <= distanceMaxMarche) {
 
-            double travelTime = (distance / vitesseDeMarche) * 3600;
-            auto stationStops = stationPair.second.getArrets();
-
-            for (auto stop : stationStops) {
-
-                int weight = travelTime;
-                m_leGraphe.ajouterArc(m_sommetDeArret[(stop).second], m_sommetDestination, weight);
-                //std::cout << "origine: " << m_sommetDeArret[(stop).second] << " destination: " << m_sommetDestination << " poids: " << weight <<std::endl;
-                ++m_nbArcsStationsVersDestination;
-                m_sommetsVersDestination.push_back(m_sommetDeArret[(stop).second]);
-
-            }
+            int weight = (distance / vitesseDeMarche) * 3600;
+            m_leGraphe->ajouterArc(sortie, m_sommetDestination, weight);
+            ++m_nbArcsStationsVersDestination;
+            m_sommetsVersDestination.push_back(sortie);
         }
     }
 
     m_origine_dest_ajoute = true;
+    m_cleRequete = m_cache.cle(p_pointOrigine, p_pointDestination, p_gtfs.getTempsDebut());
 
 
     // vector<size_t> chemin;
 
-    // unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
+    // unsigned int tempsDuTrajet = m_leGraphe->plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
     // std::cout << "temps trajet" << tempsDuTrajet << std::endl;
 
     // for (size_t i = 0 ; i < chemin.size() ; i = i + 2) {
 
     //     if (i + 1 != chemin.size()) {
-    //     std::cout << chemin[i] << " " << chemin[i + 1] << " " << m_leGraphe.getPoids(chemin[i], chemin[i + 1])<<std::endl;
+    //     std::cout << chemin[i] << " " << chemin[i + 1] << " " << m_leGraphe->getPoids(chemin[i], chemin[i + 1])<<std::endl;
             
     //     }
 
@@ -281,14 +527,17 @@ void ReseauGTFS::enleverArcsOrigineDestination()
 {
 
     for (auto node : m_sommetsVersDestination) {
-        m_leGraphe.enleverArc(node, m_sommetDestination);
+        m_leGraphe->enleverArc(node, m_sommetDestination);
         --m_nbArcsStationsVersDestination;
     }
+    m_sommetsVersDestination.clear();
 
-    m_leGraphe.resize(m_leGraphe.getNbSommets() - 2);
+    m_leGraphe->resize(m_leGraphe->getNbSommets() - 2);
     m_sommetDeArret.erase(m_arretDuSommet[m_sommetOrigine]);
     m_sommetDeArret.erase(m_arretDuSommet[m_sommetDestination]);
     m_arretDuSommet.resize(m_arretDuSommet.size() - 2);
+    m_stationDuSommet.resize(m_stationDuSommet.size() - 2);
+    m_voyageDuSommet.resize(m_voyageDuSommet.size() - 2);
     m_nbArcsOrigineVersStations = 0;
 
     m_origine_dest_ajoute = false;
@@ -301,139 +550,291 @@ void ReseauGTFS::enleverArcsOrigineDestination()
 //! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
 //! \throws logic_error si un problème survient durant l'exécution de la méthode
 void ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution) const
+{
+    Itineraire resultat = calculerItineraire(p_tempsExecution);
+    if (p_afficherItineraire) afficherItineraire(p_gtfs, resultat);
+}
+
+//! \brief Trouve l'itinéraire menant du point d'origine au point destination préalablement choisis, sans rien afficher
+//! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \return l'itinéraire sous forme de tronçons (marche ou autobus)
+//! \note l'itinéraire est d'abord cherché dans m_cache; p_tempsExecution inclut alors seulement le temps de cette recherche
+//! \throws logic_error si un problème survient durant l'exécution de la méthode
+Itineraire ReseauGTFS::calculerItineraire(long &p_tempsExecution) const
 {
     if (!m_origine_dest_ajoute)
         throw logic_error(
-            "ReseauGTFS::afficherItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+            "ReseauGTFS::calculerItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
 
-    vector<size_t> chemin;
+    Itineraire resultat;
 
     timeval tv1;
     timeval tv2;
     if (gettimeofday(&tv1, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv1");
-    unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
-    if (gettimeofday(&tv2, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv2");
-    p_tempsExecution = tempsExecution(tv1, tv2);
-
-    if (tempsDuTrajet == numeric_limits<unsigned int>::max())
+        throw logic_error("ReseauGTFS::calculerItineraire(): gettimeofday() a échoué pour tv1");
+    m_statsRecherche = StatistiquesRecherche();
+    if (!m_cacheActif || !m_cache.chercher(m_cleRequete, resultat))
     {
-        if (p_afficherItineraire)
-            cout << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps" << endl;
-        return;
-    }
-
-    if (tempsDuTrajet == 0)
-    {
-        if (p_afficherItineraire) cout << "Vous êtes déjà situé à la destination demandée" << endl;
-        return;
+        vector<size_t> chemin;
+        unsigned int tempsDuTrajet = m_leGraphe->plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin,
+                                                                m_espaceRecherche, &m_statsRecherche);
+        resultat = decoderChemin(chemin, tempsDuTrajet, m_heureDepart, m_sommetOrigine, m_sommetDestination);
+        if (m_cacheActif) m_cache.inserer(m_cleRequete, resultat);
     }
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("ReseauGTFS::calculerItineraire(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
 
-    //un chemin non trivial a été trouvé
-    if (chemin.size() <= 2)
-        throw logic_error("ReseauGTFS::afficherItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
-    if (m_arretDuSommet[chemin[0]]->getStationId() != stationIdOrigine)
-        throw logic_error("ReseauGTFS::afficherItineraire(): le premier noeud du chemin doit être le point origine");
-    if (m_arretDuSommet[chemin[chemin.size() - 1]]->getStationId() != stationIdDestination)
-        throw logic_error(
-            "ReseauGTFS::afficherItineraire(): le dernier noeud du chemin doit être le point destination");
+    return resultat;
+}
 
-    if (p_afficherItineraire)
+//! \brief Trouve l'itinéraire d'une requête sans ajouter les points origine et destination au graphe
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire le réseau
+//! \param[in] p_depart: l'heure de départ du point origine, dans [getTempsDebut(), getTempsFin()) des données
+//! \param[in,out] p_espace: les tableaux de travail de cette requête
+//! \return le même itinéraire qu'ajouterArcsOrigineDestination() puis calculerItineraire() sur des données dont
+//! l'intervalle commencerait à p_depart (à chemin égal près entre deux chemins de même durée)
+//! \note les arcs à pieds de l'origine et vers la destination deviennent les sources et les cibles de
+//! GrapheAbstrait::plusCourtCheminMultiple() (preparerRequete()): le réseau n'est pas modifié, et plusieurs fils
+//! peuvent l'interroger à la fois (chacun avec son EspaceRequete)
+//! \note si le cache est actif (activerCache()), il est consulté et rempli comme par calculerItineraire(long &),
+//! avec la clé de (p_pointOrigine, p_pointDestination, p_depart); p_espace.stats est alors nul pour un succès
+//! \throws logic_error si les données ne sont pas celles du réseau ou si p_depart est hors de leur intervalle
+Itineraire ReseauGTFS::calculerItineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                          const Coordonnees &p_pointDestination, const Heure &p_depart,
+                                          EspaceRequete &p_espace) const
+{
+    preparerRequete(p_gtfs, p_pointOrigine, p_pointDestination, p_depart, p_espace);
+    Itineraire resultat;
+    const CacheItineraires::Cle cle = m_cache.cle(p_pointOrigine, p_pointDestination, p_depart);
+    if (m_cacheActif && m_cache.chercher(cle, resultat))
     {
-        std::cout << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << "     ITINÉRAIRE      " << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << std::endl;
+        p_espace.stats = StatistiquesRecherche();
+        return resultat;
     }
+    unsigned int tempsDuTrajet = m_leGraphe->plusCourtCheminMultiple(p_espace.sources, p_espace.cibles,
+                                                                     p_espace.chemin, p_espace.recherche,
+                                                                     &p_espace.stats);
+    resultat = decoderRequete(tempsDuTrajet, p_depart, p_espace);
+    if (m_cacheActif) m_cache.inserer(cle, resultat);
+    return resultat;
+}
 
-    if (p_afficherItineraire) cout << "Heure de départ du point d'origine: "  << p_gtfs.getTempsDebut() << endl;
-    Arret::Ptr ptr_a = m_arretDuSommet.at(chemin[0]);
-    Arret::Ptr ptr_b = m_arretDuSommet.at(chemin[1]);
-    if (p_afficherItineraire)
-        cout << "Rendez vous à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
-
-    unsigned int sommet = 1;
-
-    while (sommet < chemin.size() - 1)
+//! \brief Calcule les sources et les cibles d'une requête, sans modifier le réseau
+//! \post p_espace.sources: pour chaque station à distance de marche de l'origine, le premier arrêt atteignable
+//! à pieds après p_depart et la durée depuis p_depart (les arcs qu'ajouterait ajouterArcsOrigineDestination())
+//! \post p_espace.cibles: le sommet de sortie de chaque station à distance de marche de la destination, et la
+//! durée de marche vers celle-ci
+//! \throws logic_error si les données ne sont pas celles du réseau ou si p_depart est hors de leur intervalle
+void ReseauGTFS::preparerRequete(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                 const Coordonnees &p_pointDestination, const Heure &p_depart,
+                                 EspaceRequete &p_espace) const
+{
+    const auto &stationMap = p_gtfs.getStations();
+    if (stationMap.size() != m_nbSommetsSortie || m_coordsStations.taille() != stationMap.size())
+        throw logic_error("ReseauGTFS::preparerRequete(): les données ne sont pas celles du réseau");
+    if (p_depart < p_gtfs.getTempsDebut() || p_depart >= p_gtfs.getTempsFin())
+        throw logic_error("ReseauGTFS::preparerRequete(): l'heure de départ est hors de l'intervalle des données");
+
+    m_coordsStations.distancesDepuis(p_pointOrigine, p_espace.distancesOrigine);
+    m_coordsStations.distancesDepuis(p_pointDestination, p_espace.distancesDestination);
+    const double seuil = distanceMaxMarche + TableCoordonnees::margeOperateur;
+    p_espace.sources.clear();
+    p_espace.cibles.clear();
+
+    //les mêmes arcs à pieds qu'ajouterArcsOrigineDestination(), à partir de p_depart
+    size_t indiceStation = 0;
+    for (const auto &stationPair : stationMap)
     {
-        ptr_a = ptr_b;
-        ++sommet;
-        ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        while (ptr_b->getStationId() == ptr_a->getStationId())
-        {
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        }
-        //on a changé de station
-        if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
+        const size_t i = indiceStation++;
+        const auto &stationStops = stationPair.second.getArrets();
+        if (p_espace.distancesOrigine[i] <= seuil)
         {
-            if (sommet != chemin.size() - 1)
-                throw logic_error(
-                    "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'un changement de station");
-            break;
-        }
-        if (sommet == chemin.size() - 1)
-            throw logic_error("ReseauGTFS::afficherItineraire(): on ne devrait pas être arrivé à destination");
-        //on a changé de station mais sommet n'est pas le noeud destination
-        string voyage_id_a = ptr_a->getVoyageId();
-        string voyage_id_b = ptr_b->getVoyageId();
-        if (voyage_id_a != voyage_id_b) //on a changé de station à pieds
-        {
-            if (p_afficherItineraire)
-                cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
-        }
-        else //on a changé de station avec un voyage
-        {
-            Heure heure = ptr_a->getHeureArrivee();
-            unsigned int ligne_id = p_gtfs.getVoyages().at(voyage_id_a).getLigne();
-            string ligne_numero = p_gtfs.getLignes().at(ligne_id).getNumero();
-            if (p_afficherItineraire)
-                cout << "De cette station, prenez l'autobus numéro " << ligne_numero << " à l'heure " << heure << " "
-            << p_gtfs.getVoyages().at(voyage_id_a) << endl;
-            //maintenant allons à la dernière station de ce voyage
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            while (ptr_b->getVoyageId() == ptr_a->getVoyageId())
+            double distance = stationPair.second.getCoords() - p_pointOrigine;
+            if (distance <= distanceMaxMarche)
             {
-                ptr_a = ptr_b;
-                ++sommet;
-                ptr_b = m_arretDuSommet.at(chemin[sommet]);
+                double travelTime = (distance / vitesseDeMarche) * 3600;
+                auto closestCandidate = stationStops.lower_bound(p_depart.add_secondes(travelTime));
+                if (closestCandidate != stationStops.end())
+                    p_espace.sources.push_back({getSommetDeArret(closestCandidate->second),
+                                                closestCandidate->second->getHeureArrivee() - p_depart});
             }
-            //on a changé de voyage
-            if (p_afficherItineraire)
-                cout << "et arrêtez-vous à la station " << p_gtfs.getStations().at(ptr_a->getStationId()) << " à l'heure "
-            << ptr_a->getHeureArrivee() << endl;
-            if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
+        }
+        if (p_espace.distancesDestination[i] <= seuil && !stationStops.empty())
+        {
+            double distance = p_pointDestination - stationPair.second.getCoords();
+            if (distance <= distanceMaxMarche)
             {
-                if (sommet != chemin.size() - 1)
-                    throw logic_error(
-                        "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'u changement de voyage");
-                break;
-            }
-            if (ptr_a->getStationId() != ptr_b->getStationId()) //alors on s'est rendu à pieds à l'autre station
-                if (p_afficherItineraire)
-                    cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+                int weight = (distance / vitesseDeMarche) * 3600;
+                p_espace.cibles.push_back({m_premierSommetSortie + i, weight});
             }
         }
+    }
+}
 
-        if (p_afficherItineraire)
-        {
-            cout << "Déplacez-vous à pieds de cette station au point destination" << endl;
-            cout << "Heure d'arrivée à la destination: " << p_gtfs.getTempsDebut().add_secondes(tempsDuTrajet) << endl;
-        }
-        unsigned int h = tempsDuTrajet / 3600;
-        unsigned int reste_sec = tempsDuTrajet % 3600;
-        unsigned int m = reste_sec / 60;
-        unsigned int s = reste_sec % 60;
-        if (p_afficherItineraire)
+//! \brief Convertit en itinéraire le chemin trouvé pour les sources et les cibles de preparerRequete()
+//! \param[in] p_tempsDuTrajet: la durée du trajet (numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[in,out] p_espace: p_espace.chemin va d'une source à une cible (un sommet de sortie); il est complété
+//! par les points origine et destination
+//! \throws logic_error si le chemin est incohérent
+Itineraire ReseauGTFS::decoderRequete(unsigned int p_tempsDuTrajet, const Heure &p_depart,
+                                      EspaceRequete &p_espace) const
+{
+    //les points origine et destination, absents du graphe, ont des numéros qu'aucun sommet ne peut avoir
+    const size_t origine = numeric_limits<size_t>::max() - 1;
+    const size_t destination = numeric_limits<size_t>::max();
+    p_espace.chemin.insert(p_espace.chemin.begin(), origine);
+    p_espace.chemin.push_back(destination);
+    return decoderChemin(p_espace.chemin, p_tempsDuTrajet, p_depart - Heure(0, 0, 0), origine, destination);
+}
+
+//! \brief Trouve jusqu'à p_nombre itinéraires différents menant du point d'origine au point destination
+//! \param[in] p_nombre: le nombre maximal d'itinéraires retournés (au moins 1)
+//! \param[in] p_similariteMax: la similarité (similariteVoyages()) maximale d'une alternative avec chacun des
+//! itinéraires déjà retenus, entre 0 et 1
+//! \param[in] p_etirementMax: la durée maximale d'une alternative, en multiple de la durée la plus courte (>= 1)
+//! \param[out] p_tempsExecution: le temps d'exécution des recherches
+//! \return les itinéraires par durée croissante; le premier est celui de calculerItineraire()
+//! \note méthode des sommets intermédiaires (via-node): un arbre de plus courts chemins issu de l'origine et un arbre
+//! menant à la destination, tous deux limités à p_etirementMax fois la durée la plus courte, donnent pour chaque
+//! sommet v le plus court chemin passant par v. La recherche à rebours ne visite que les sommets atteints par la
+//! première (sinon elle parcourrait les arrêts de toute la journée près de la destination). Les sommets sont essayés
+//! par durée croissante de ce chemin; les sommets d'un chemin déjà essayé sont écartés (ils mènent presque toujours
+//! au même plateau). Le coût est celui de quelques recherches, contre une recherche complète par alternative en
+//! retirant des arcs (enleverArc())
+//! \note n'utilise pas m_cache; getStatistiquesRecherche() décrit la recherche du plus court chemin
+//! \throws logic_error si l'origine et la destination n'ont pas été ajoutées ou si un paramètre est hors limites
+vector<Itineraire> ReseauGTFS::calculerAlternatives(size_t p_nombre, double p_similariteMax, double p_etirementMax,
+                                                    long &p_tempsExecution) const
+{
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+            "ReseauGTFS::calculerAlternatives(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+    if (p_nombre == 0 || !(p_similariteMax >= 0 && p_similariteMax <= 1) || !(p_etirementMax >= 1))
+        throw logic_error("ReseauGTFS::calculerAlternatives(): paramètres hors limites");
+
+    timeval tv1;
+    timeval tv2;
+    if (gettimeofday(&tv1, 0) != 0)
+        throw logic_error("ReseauGTFS::calculerAlternatives(): gettimeofday() a échoué pour tv1");
+
+    vector<Itineraire> resultat;
+    vector<size_t> chemin;
+    unsigned int duree = m_leGraphe->plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin,
+                                                     m_espaceRecherche, &m_statsRecherche);
+    resultat.push_back(decoderChemin(chemin, duree, m_heureDepart, m_sommetOrigine, m_sommetDestination));
+    if (p_nombre > 1 && resultat[0].atteignable && duree > 0)
+    {
+        const unsigned int borne = static_cast<unsigned int>(
+            min<double>(duree * p_etirementMax, numeric_limits<unsigned int>::max() - 1));
+        vector<unsigned int> distanceAvant, distanceArriere;
+        vector<size_t> parentAvant, parentArriere;
+        m_leGraphe->arbrePlusCourtsChemins(m_sommetOrigine, false, borne, distanceAvant, parentAvant);
+        m_leGraphe->arbrePlusCourtsChemins(m_sommetDestination, true, borne, distanceArriere, parentArriere,
+                                           &distanceAvant);
+
+        typedef pair<unsigned int, size_t> Candidat; //(durée du chemin passant par le sommet, sommet)
+        vector<Candidat> candidats;
+        for (size_t v = 0; v < distanceAvant.size(); ++v)
+            if (distanceAvant[v] <= borne && distanceArriere[v] <= borne - distanceAvant[v])
+                candidats.push_back(Candidat(distanceAvant[v] + distanceArriere[v], v));
+        sort(candidats.begin(), candidats.end());
+
+        vector<bool> essaye(distanceAvant.size(), false);
+        for (size_t s : chemin) essaye[s] = true;
+        for (auto &c : candidats)
         {
-            cout << "Durée du trajet: " << h << " heures, " << m << " minutes, " << s << " secondes" << endl;
+            if (resultat.size() >= p_nombre) break;
+            if (essaye[c.second]) continue;
+            bool simple = cheminVia(c.second, parentAvant, parentArriere, chemin);
+            for (size_t s : chemin) essaye[s] = true;
+            if (!simple) continue;
+            Itineraire alternative = decoderChemin(chemin, c.first, m_heureDepart, m_sommetOrigine,
+                                                   m_sommetDestination);
+            bool differente = true;
+            for (auto &r : resultat)
+                if (similariteVoyages(alternative, r) > p_similariteMax)
+                {
+                    differente = false;
+                    break;
+                }
+            if (differente) resultat.push_back(alternative);
         }
-
     }
 
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("ReseauGTFS::calculerAlternatives(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+    return resultat;
+}
+
+//! \brief Construit le chemin de l'origine à la destination passant par p_via, à partir des deux arbres
+//! \param[in] p_parentAvant, p_parentArriere: les arbres issus de l'origine et menant à la destination
+//! (arbrePlusCourtsChemins())
+//! \param[out] p_chemin: les sommets du chemin
+//! \return faux si le chemin passe deux fois par un même sommet (il n'est alors pas retenu)
+bool ReseauGTFS::cheminVia(size_t p_via, const vector<size_t> &p_parentAvant, const vector<size_t> &p_parentArriere,
+                           vector<size_t> &p_chemin) const
+{
+    p_chemin.clear();
+    for (size_t s = p_via; s != numeric_limits<size_t>::max(); s = p_parentAvant[s]) p_chemin.push_back(s);
+    reverse(p_chemin.begin(), p_chemin.end());
+    size_t debutArriere = p_chemin.size();
+    for (size_t s = p_parentArriere[p_via]; s != numeric_limits<size_t>::max(); s = p_parentArriere[s])
+        p_chemin.push_back(s);
+    //les deux moitiés sont sans répétition (ce sont des chemins d'arbres): on ne compare que l'une à l'autre
+    vector<size_t> avant(p_chemin.begin(), p_chemin.begin() + debutArriere);
+    sort(avant.begin(), avant.end());
+    for (size_t i = debutArriere; i < p_chemin.size(); ++i)
+        if (binary_search(avant.begin(), avant.end(), p_chemin[i])) return false;
+    return true;
+}
+
+//! \brief les sommets du graphe (sans les points origine et destination, que ::decoderChemin() reconnaît)
+class ReseauGTFS::Sommets : public SommetsHoraires
+{
+public:
+    explicit Sommets(const ReseauGTFS &p_reseau) : m_reseau(p_reseau) {}
+    bool estSommetSortie(size_t p_sommet) const { return m_reseau.estSommetSortie(p_sommet); }
+    unsigned int stationDuSommet(size_t p_sommet) const { return m_reseau.m_stationDuSommet[p_sommet]; }
+    uint32_t voyageDuSommet(size_t p_sommet) const { return m_reseau.m_voyageDuSommet[p_sommet]; }
+    unsigned int heureDuSommet(size_t p_sommet) const { return m_reseau.heureDuSommet(p_sommet); }
+    unsigned int ligneDuVoyage(uint32_t p_voyage) const { return m_reseau.m_ligneDuVoyage[p_voyage]; }
+
+private:
+    const ReseauGTFS &m_reseau;
+};
+
+//! \brief Convertit un chemin du graphe en itinéraire (voir ::decoderChemin())
+Itineraire ReseauGTFS::decoderChemin(const vector<size_t> &p_chemin, unsigned int p_tempsDuTrajet,
+                                     unsigned int p_heureDepart, size_t p_origine, size_t p_destination) const
+{
+    return ::decoderChemin(Sommets(*this), p_chemin, p_tempsDuTrajet, p_heureDepart, p_origine, p_destination);
+}
 
+//! \brief Affiche un itinéraire obtenu par ReseauGTFS::calculerItineraire()
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire ce réseau
+//! \param[in] p_itineraire: l'itinéraire à afficher
+//! \param[in] p_flux: le flux de sortie
+void ReseauGTFS::afficherItineraire(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire, std::ostream &p_flux) const
+{
+    ::afficherItineraire(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+//! \brief Écrit un itinéraire obtenu par ReseauGTFS::calculerItineraire() en JSON (sur une seule ligne)
+void ReseauGTFS::ecrireItineraireJSON(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire,
+                                      std::ostream &p_flux) const
+{
+    ::ecrireItineraireJSON(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+//! \return vrai si p_sommet est le sommet de sortie d'une station (voir le constructeur)
+bool ReseauGTFS::estSommetSortie(size_t p_sommet) const
+{
+    return p_sommet >= m_premierSommetSortie && p_sommet < m_premierSommetSortie + m_nbSommetsSortie;
+}
+
+unsigned int ReseauGTFS::heureDuSommet(size_t p_sommet) const
+{
+    return static_cast<unsigned int>(m_arretDuSommet[p_sommet]->getHeureArrivee() - Heure(0, 0, 0));
+}
@@ -7,36 +7,114 @@
 
 #include "DonneesGTFS.h"
 #include "graphe.h"
+#include "cacheItineraires.h"
+#include "itineraire.h"
+#include "statistiques.h"
+#include "arene.h"
+#include "tableCoordonnees.h"
+#include "cheminsPietons.h"
 
 
+//! \brief Les tableaux de travail d'une requête de ReseauGTFS::calculerItineraire() qui ne modifie pas le réseau
+//! (un par fil d'exécution); ils sont réutilisés d'une requête à l'autre
+struct EspaceRequete
+{
+    EspaceRecherche recherche;
+    std::vector<double> distancesOrigine; //par station: distance (TableCoordonnees) au point origine
+    std::vector<double> distancesDestination;
+    std::vector<std::pair<size_t, unsigned int> > sources; //(arrêt atteint à pieds, durée depuis le départ)
+    std::vector<std::pair<size_t, unsigned int> > cibles; //(sommet de sortie, durée de marche vers la destination)
+    std::vector<size_t> chemin;
+    StatistiquesRecherche stats; //compteurs de la dernière recherche (si GTFS_STATS est défini)
+};
+
 class ReseauGTFS
 {
 
 public:
-    ReseauGTFS(const DonneesGTFS &);
+    ReseauGTFS(const DonneesGTFS &, bool = true, LargeurGraphe = LargeurGraphe::automatique,
+               const CheminsPietons * = nullptr);
     void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
     void enleverArcsOrigineDestination();
     void itineraire(const DonneesGTFS &, bool, long &) const;
+    Itineraire calculerItineraire(long &) const;
+    Itineraire calculerItineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                                  EspaceRequete &) const;
+    void preparerRequete(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                         EspaceRequete &) const;
+    Itineraire decoderRequete(unsigned int, const Heure &, EspaceRequete &) const;
+    std::vector<Itineraire> calculerAlternatives(size_t, double, double, long &) const;
+    void afficherItineraire(const DonneesGTFS &, const Itineraire &, std::ostream & = std::cout) const;
+    void ecrireItineraireJSON(const DonneesGTFS &, const Itineraire &, std::ostream &) const;
     size_t getNbArcsOrigineVersStations() const;
     size_t getNbArcsStationsVersDestination() const;
     double getDistMaxMarche() const;
+    unsigned int getStationIdOrigine() const;
+    unsigned int getStationIdDestination() const;
+    const CacheItineraires & getCache() const;
+    void activerCache(bool);
+    const StatistiquesConstruction & getStatistiquesConstruction() const;
+    const StatistiquesRecherche & getStatistiquesRecherche() const;
+    const GrapheAbstrait & getGraphe() const;
+    size_t getSommetDeArret(const Arret::Ptr &) const;
+    void mesurerMemoire(RapportMemoire &) const;
+    size_t getPremierSommetSortie() const;
+    size_t getNbSommetsSortie() const;
+    unsigned int getHeureDuSommet(size_t) const;
+    uint32_t getVoyageDuSommet(size_t) const;
+    const std::vector<std::string> & getIdDuVoyage() const;
+    unsigned int getLigneDuVoyage(uint32_t) const;
+    double getVitesseMarche() const;
 
 private:
-    Graphe m_leGraphe;
+    class Sommets; //les tableaux par sommet, vus par ::decoderChemin()
+
+    Itineraire decoderChemin(const std::vector<size_t> &, unsigned int, unsigned int, size_t, size_t) const;
+    bool cheminVia(size_t, const std::vector<size_t> &, const std::vector<size_t> &, std::vector<size_t> &) const;
+    unsigned int heureDuSommet(size_t) const;
+    bool estSommetSortie(size_t) const;
+    void renumeroterSommets();
+    void ajouterArcsTransfert(const std::map<unsigned int, Station> &, unsigned int, unsigned int, unsigned int);
+
+    typedef std::unordered_map<Arret::Ptr, size_t, std::hash<Arret::Ptr>, std::equal_to<Arret::Ptr>,
+                               AllocateurArene<std::pair<const Arret::Ptr, size_t> > > TableSommets;
+
+    std::unique_ptr<GrapheAbstrait> m_leGraphe; //la largeur des sommets et des poids est choisie selon la taille des données
     std::vector<Arret::Ptr> m_arretDuSommet; //m_arretDuSommet[i] est le pointeur (shared_ptr) de l'arret (associé au sommet i du graphe
-    std::unordered_map<Arret::Ptr,size_t> m_sommetDeArret; //m_sommetDeArret[a_ptr] est le sommet du graphe associé au pointeur de l'arret a_ptr
-    std::vector<size_t> m_sommetsVersDestination; //Chaque élément est un sommet possédant un arc vers la destination
+    Arene m_arene; //les noeuds de m_sommetDeArret (déclarée avant lui: détruite après)
+    TableSommets m_sommetDeArret; //m_sommetDeArret[a_ptr] est le sommet du graphe associé au pointeur de l'arret a_ptr
+    std::vector<unsigned int> m_stationDuSommet; //m_stationDuSommet[i] est le stationId de l'arret associé au sommet i
+    std::vector<uint32_t> m_voyageDuSommet; //m_voyageDuSommet[i] est l'indice (dans m_idDuVoyage) du voyage de l'arret associé au sommet i
+    std::vector<std::string> m_idDuVoyage; //m_idDuVoyage[v] est le trip_id du voyage d'indice v
+    std::vector<unsigned int> m_ligneDuVoyage; //m_ligneDuVoyage[v] est l'identifiant de la ligne du voyage d'indice v
+    unsigned int m_heureDepart; //l'heure de départ du point origine (getTempsDebut()), en secondes depuis minuit
+    std::vector<size_t> m_sommetsVersDestination; //Chaque élément est un sommet (de sortie) possédant un arc vers la destination
+    size_t m_premierSommetSortie; //le sommet de sortie de la première station de getStations(); les suivants sont consécutifs
+    size_t m_nbSommetsSortie; //un par station: tous les arrêts de la station y mènent avec un poids nul
+    TableCoordonnees m_coordsStations; //les coordonnées des stations, dans l'ordre de getStations()
+    std::vector<double> m_distancesOrigine; //par station (même ordre): distance (TableCoordonnees) au point origine
+    std::vector<double> m_distancesDestination;
 
     bool m_origine_dest_ajoute; //indique si on a ajouté le point origine, le point destination, et les arcs correspondants
     size_t m_sommetOrigine; //le sommet du graphe qui représente le point d'origine
     size_t m_sommetDestination; //le sommet du graphe qui représente le point destination
     size_t m_nbArcsOrigineVersStations; //le nombre d'arcs du point origine vers des stations
-    size_t m_nbArcsStationsVersDestination; //le nombre d'arcs d'une station vers le point destination
+    size_t m_nbArcsStationsVersDestination; //le nombre d'arcs d'une station (sommet de sortie) vers le point destination
+
+    mutable CacheItineraires m_cache; //itinéraires déjà calculés sur ce réseau; détruit avec lui lorsqu'on le reconstruit
+    bool m_cacheActif; //indique si calculerItineraire() consulte et remplit m_cache
+    CacheItineraires::Cle m_cleRequete; //la clé (quantifiée) de la requête origine/destination courante
+
+    StatistiquesConstruction m_statsConstruction; //durée des phases du constructeur (si GTFS_STATS est défini)
+    mutable StatistiquesRecherche m_statsRecherche; //compteurs de la dernière recherche (si GTFS_STATS est défini)
+    mutable EspaceRecherche m_espaceRecherche; //les tableaux de travail de calculerItineraire(long &) et de
+                                               //calculerAlternatives(), qui modifient déjà le réseau d'une requête
 
     const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia */
     const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
-    const unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
-    const unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
+    //numéros de stationID donnés à l'arret fantôme de départ et aux arrets fantômes de destination
+    const unsigned int stationIdOrigine = Troncon::stationOrigine;
+    const unsigned int stationIdDestination = Troncon::stationDestination;
 
 };
 
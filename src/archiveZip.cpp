@@ -0,0 +1,236 @@
+//
+//  archiveZip.cpp
+//  Lecture en flux des fichiers d'une archive .zip (méthodes stockée et deflate, via zlib)
+//
+
+#include "archiveZip.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <zlib.h>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t signatureFinRepertoire = 0x06054b50;
+    const uint32_t signatureRepertoire = 0x02014b50;
+    const uint32_t signatureEntete = 0x04034b50;
+    const size_t tailleBloc = 1 << 18;
+
+    //les entiers du format zip sont petit-boutistes
+    uint16_t lire16(const unsigned char *p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t lire32(const unsigned char *p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    void lireA(ifstream &p_fichier, uint64_t p_position, unsigned char *p_tampon, size_t p_taille,
+               const string &p_chemin)
+    {
+        p_fichier.clear();
+        p_fichier.seekg(static_cast<streamoff>(p_position));
+        if (!p_fichier.read(reinterpret_cast<char *>(p_tampon), static_cast<streamsize>(p_taille)))
+            throw logic_error("ArchiveZip: archive tronquée: " + p_chemin);
+    }
+}
+
+//! \brief ouvre une archive et lit son répertoire central
+//! \throws logic_error si le fichier ne peut être lu ou n'est pas une archive zip prise en charge
+ArchiveZip::ArchiveZip(const string &p_chemin)
+    : m_chemin(p_chemin)
+{
+    ifstream fichier(p_chemin.c_str(), ios::binary);
+    if (!fichier) throw logic_error("ArchiveZip: impossible d'ouvrir " + p_chemin);
+    fichier.seekg(0, ios::end);
+    const uint64_t tailleArchive = static_cast<uint64_t>(fichier.tellg());
+
+    //la fin du répertoire central: 22 octets suivis d'un commentaire d'au plus 65535 octets
+    const uint64_t tailleQueue = min<uint64_t>(tailleArchive, 22 + 65535);
+    vector<unsigned char> queue(tailleQueue);
+    lireA(fichier, tailleArchive - tailleQueue, queue.data(), queue.size(), p_chemin);
+    size_t fin = string::npos;
+    for (size_t i = tailleQueue >= 22 ? tailleQueue - 22 + 1 : 0; i-- > 0;)
+        if (lire32(&queue[i]) == signatureFinRepertoire)
+        {
+            fin = i;
+            break;
+        }
+    if (fin == string::npos) throw logic_error("ArchiveZip: " + p_chemin + " n'est pas une archive zip");
+
+    const uint16_t nbEntrees = lire16(&queue[fin + 10]);
+    const uint32_t tailleRepertoire = lire32(&queue[fin + 12]);
+    const uint32_t positionRepertoire = lire32(&queue[fin + 16]);
+    if (nbEntrees == 0xFFFF || positionRepertoire == 0xFFFFFFFF)
+        throw logic_error("ArchiveZip: les archives ZIP64 ne sont pas prises en charge: " + p_chemin);
+    if (static_cast<uint64_t>(positionRepertoire) + tailleRepertoire > tailleArchive)
+        throw logic_error("ArchiveZip: répertoire central invalide: " + p_chemin);
+
+    vector<unsigned char> repertoire(tailleRepertoire);
+    lireA(fichier, positionRepertoire, repertoire.data(), repertoire.size(), p_chemin);
+    size_t p = 0;
+    for (uint16_t i = 0; i < nbEntrees; ++i)
+    {
+        if (p + 46 > repertoire.size() || lire32(&repertoire[p]) != signatureRepertoire)
+            throw logic_error("ArchiveZip: répertoire central invalide: " + p_chemin);
+        Entree entree;
+        const uint16_t drapeaux = lire16(&repertoire[p + 8]);
+        entree.methode = lire16(&repertoire[p + 10]);
+        entree.crc = lire32(&repertoire[p + 16]);
+        entree.tailleCompressee = lire32(&repertoire[p + 20]);
+        entree.taille = lire32(&repertoire[p + 24]);
+        const uint16_t longueurNom = lire16(&repertoire[p + 28]);
+        const uint16_t longueurExtra = lire16(&repertoire[p + 30]);
+        const uint16_t longueurCommentaire = lire16(&repertoire[p + 32]);
+        entree.positionEntete = lire32(&repertoire[p + 42]);
+        if (p + 46 + longueurNom > repertoire.size())
+            throw logic_error("ArchiveZip: répertoire central invalide: " + p_chemin);
+        entree.nom.assign(reinterpret_cast<const char *>(&repertoire[p + 46]), longueurNom);
+        p += 46 + longueurNom + longueurExtra + longueurCommentaire;
+
+        if (entree.taille == 0xFFFFFFFF || entree.tailleCompressee == 0xFFFFFFFF || entree.positionEntete == 0xFFFFFFFF)
+            throw logic_error("ArchiveZip: les archives ZIP64 ne sont pas prises en charge: " + p_chemin);
+        if (drapeaux & 1) entree.methode = 0xFFFF; //chiffré: refusé à l'extraction
+        m_entrees.push_back(entree);
+    }
+}
+
+//! \return vrai si p_chemin désigne un fichier dont l'extension est .zip
+bool ArchiveZip::estArchive(const string &p_chemin)
+{
+    if (p_chemin.size() < 4) return false;
+    string extension = p_chemin.substr(p_chemin.size() - 4);
+    transform(extension.begin(), extension.end(), extension.begin(), [](char c)
+    {
+        return static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    });
+    return extension == ".zip" && ifstream(p_chemin.c_str()).good();
+}
+
+//! \return l'entrée nommée p_nom, à la racine de l'archive ou dans un de ses dossiers (nullptr si absente)
+const ArchiveZip::Entree *ArchiveZip::chercher(const string &p_nom) const
+{
+    for (auto &e : m_entrees)
+        if (e.nom == p_nom) return &e;
+    for (auto &e : m_entrees) //une archive d'un dossier préfixe les noms par ce dossier
+        if (e.nom.size() > p_nom.size() && e.nom.compare(e.nom.size() - p_nom.size(), p_nom.size(), p_nom) == 0 &&
+            e.nom[e.nom.size() - p_nom.size() - 1] == '/')
+            return &e;
+    return nullptr;
+}
+
+const ArchiveZip::Entree &ArchiveZip::trouver(const string &p_nom) const
+{
+    const Entree *entree = chercher(p_nom);
+    if (!entree) throw logic_error("ArchiveZip: " + p_nom + " est absent de " + m_chemin);
+    return *entree;
+}
+
+bool ArchiveZip::contient(const string &p_nom) const
+{
+    return chercher(p_nom) != nullptr;
+}
+
+//! \return la taille décompressée du fichier p_nom
+//! \throws logic_error si p_nom est absent de l'archive
+uint64_t ArchiveZip::getTaille(const string &p_nom) const
+{
+    return trouver(p_nom).taille;
+}
+
+//! \brief décompresse le fichier p_nom par blocs, livrés dans l'ordre à p_recepteur
+//! \note une exception lancée par p_recepteur interrompt l'extraction et est propagée
+//! \throws logic_error si p_nom est absent, utilise une méthode non prise en charge, est corrompu
+//! (deflate invalide, taille ou CRC-32 incorrect)
+void ArchiveZip::extraire(const string &p_nom, const Recepteur &p_recepteur) const
+{
+    const Entree &entree = trouver(p_nom);
+    if (entree.methode != 0 && entree.methode != 8)
+        throw logic_error("ArchiveZip: méthode de compression non prise en charge pour " + p_nom);
+
+    ifstream fichier(m_chemin.c_str(), ios::binary);
+    if (!fichier) throw logic_error("ArchiveZip: impossible d'ouvrir " + m_chemin);
+    unsigned char entete[30];
+    lireA(fichier, entree.positionEntete, entete, sizeof(entete), m_chemin);
+    if (lire32(entete) != signatureEntete) throw logic_error("ArchiveZip: entête local invalide pour " + p_nom);
+    fichier.seekg(static_cast<streamoff>(entree.positionEntete) + 30 + lire16(&entete[26]) + lire16(&entete[28]));
+
+    vector<unsigned char> compresse(tailleBloc), sortie(tailleBloc);
+    uint32_t aLire = entree.tailleCompressee;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64_t produit = 0;
+
+    if (entree.methode == 0)
+    {
+        while (aLire > 0)
+        {
+            size_t n = min<size_t>(aLire, tailleBloc);
+            if (!fichier.read(reinterpret_cast<char *>(compresse.data()), static_cast<streamsize>(n)))
+                throw logic_error("ArchiveZip: archive tronquée: " + m_chemin);
+            aLire -= static_cast<uint32_t>(n);
+            crc = crc32(crc, compresse.data(), static_cast<uInt>(n));
+            produit += n;
+            p_recepteur(reinterpret_cast<const char *>(compresse.data()), n);
+        }
+    }
+    else
+    {
+        z_stream flux;
+        flux.zalloc = Z_NULL;
+        flux.zfree = Z_NULL;
+        flux.opaque = Z_NULL;
+        flux.next_in = Z_NULL;
+        flux.avail_in = 0;
+        if (inflateInit2(&flux, -MAX_WBITS) != Z_OK) throw logic_error("ArchiveZip: échec de l'initialisation de zlib");
+        try
+        {
+            int etat = Z_OK;
+            while (etat != Z_STREAM_END)
+            {
+                if (flux.avail_in == 0)
+                {
+                    if (aLire == 0) throw logic_error("ArchiveZip: données deflate tronquées pour " + p_nom);
+                    size_t n = min<size_t>(aLire, tailleBloc);
+                    if (!fichier.read(reinterpret_cast<char *>(compresse.data()), static_cast<streamsize>(n)))
+                        throw logic_error("ArchiveZip: archive tronquée: " + m_chemin);
+                    aLire -= static_cast<uint32_t>(n);
+                    flux.next_in = compresse.data();
+                    flux.avail_in = static_cast<uInt>(n);
+                }
+                flux.next_out = sortie.data();
+                flux.avail_out = static_cast<uInt>(sortie.size());
+                etat = inflate(&flux, Z_NO_FLUSH);
+                if (etat != Z_OK && etat != Z_STREAM_END)
+                    throw logic_error("ArchiveZip: données deflate invalides pour " + p_nom);
+                size_t n = sortie.size() - flux.avail_out;
+                if (n > 0)
+                {
+                    crc = crc32(crc, sortie.data(), static_cast<uInt>(n));
+                    produit += n;
+                    p_recepteur(reinterpret_cast<const char *>(sortie.data()), n);
+                }
+            }
+        }
+        catch (...)
+        {
+            inflateEnd(&flux);
+            throw;
+        }
+        inflateEnd(&flux);
+    }
+
+    if (produit != entree.taille || crc != entree.crc)
+        throw logic_error("ArchiveZip: " + p_nom + " est corrompu (taille ou CRC-32 incorrect)");
+}
+
+const std::string &ArchiveZip::getChemin() const
+{
+    return m_chemin;
+}
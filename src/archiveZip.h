@@ -0,0 +1,49 @@
+//
+//  archiveZip.h
+//  Lecture en flux des fichiers d'une archive .zip (méthodes stockée et deflate, via zlib)
+//
+
+#ifndef TP2_ARCHIVEZIP_H
+#define TP2_ARCHIVEZIP_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+//! \brief Archive .zip ouverte en lecture: seul le répertoire central est chargé en mémoire
+//! \note chaque fichier est décompressé par blocs et livré à un récepteur au fur et à mesure;
+//! le contenu décompressé n'est jamais écrit sur disque ni gardé en entier en mémoire
+//! \note les archives ZIP64 (fichiers de plus de 4 Go) et chiffrées ne sont pas prises en charge
+class ArchiveZip
+{
+public:
+    typedef std::function<void(const char *, size_t)> Recepteur;
+
+    explicit ArchiveZip(const std::string &p_chemin);
+    bool contient(const std::string &p_nom) const;
+    void extraire(const std::string &p_nom, const Recepteur &p_recepteur) const;
+    uint64_t getTaille(const std::string &p_nom) const;
+    const std::string &getChemin() const;
+
+    static bool estArchive(const std::string &p_chemin);
+
+private:
+    struct Entree
+    {
+        std::string nom;
+        uint16_t methode; //0: stockée, 8: deflate
+        uint32_t crc;
+        uint32_t tailleCompressee;
+        uint32_t taille;
+        uint32_t positionEntete; //position de l'entête local dans l'archive
+    };
+
+    const Entree &trouver(const std::string &p_nom) const;
+    const Entree *chercher(const std::string &p_nom) const;
+
+    std::string m_chemin;
+    std::vector<Entree> m_entrees;
+};
+
+#endif //TP2_ARCHIVEZIP_H
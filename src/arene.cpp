@@ -0,0 +1,96 @@
+//
+//  arene.cpp
+//  Arène d'allocation par gros blocs pour les structures du réseau (conteneurs à noeuds)
+//
+
+#include "arene.h"
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+using namespace std;
+
+//! \param[in] p_tailleBloc: la taille, en octets, des blocs demandés au système
+Arene::Arene(size_t p_tailleBloc)
+    : m_tailleBloc(p_tailleBloc), m_octetsReserves(0), m_courant(nullptr), m_fin(nullptr),
+      m_libres(tailleRecyclableMax / granularite + 1, nullptr)
+{
+}
+
+Arene::~Arene()
+{
+    vider();
+}
+
+//! \brief rend tous les blocs au système
+//! \pre aucun objet alloué dans l'arène n'est encore utilisé
+void Arene::vider()
+{
+    for (char *bloc : m_blocs) free(bloc);
+    m_blocs.clear();
+    m_octetsReserves = 0;
+    m_courant = m_fin = nullptr;
+    m_libres.assign(m_libres.size(), nullptr);
+}
+
+//! \brief alloue p_taille octets alignés sur p_alignement (une puissance de 2 au plus égale à alignof(max_align_t))
+//! \throws bad_alloc si le système ne peut fournir un nouveau bloc
+void *Arene::allouer(size_t p_taille, size_t p_alignement)
+{
+    if (p_taille == 0) p_taille = 1;
+    size_t arrondie = (p_taille + granularite - 1) / granularite * granularite;
+    if (arrondie <= tailleRecyclableMax)
+    {
+        Libre *&libre = m_libres[arrondie / granularite];
+        if (libre)
+        {
+            void *adresse = libre;
+            libre = libre->suivant;
+            return adresse;
+        }
+        //pour pouvoir la recycler dans la même classe, quel que soit l'alignement de la prochaine demande: une
+        //grande allocation de taille quelconque a pu laisser m_courant sur un alignement plus faible
+        p_taille = arrondie;
+        p_alignement = alignof(max_align_t);
+    }
+
+    uintptr_t debut = (reinterpret_cast<uintptr_t>(m_courant) + p_alignement - 1) & ~(uintptr_t(p_alignement) - 1);
+    if (!m_courant || debut + p_taille > reinterpret_cast<uintptr_t>(m_fin))
+    {
+        size_t taille = p_taille + p_alignement > m_tailleBloc ? p_taille + p_alignement : m_tailleBloc;
+        char *bloc = static_cast<char *>(malloc(taille));
+        if (!bloc) throw bad_alloc();
+        m_blocs.push_back(bloc);
+        m_octetsReserves += taille;
+        m_courant = bloc;
+        m_fin = bloc + taille;
+        debut = (reinterpret_cast<uintptr_t>(m_courant) + p_alignement - 1) & ~(uintptr_t(p_alignement) - 1);
+    }
+    m_courant = reinterpret_cast<char *>(debut + p_taille);
+    return reinterpret_cast<void *>(debut);
+}
+
+//! \brief rend une allocation de p_taille octets faite par allouer()
+//! \note les petites allocations sont recyclées; les grandes ne sont récupérées qu'à la destruction de l'arène
+void Arene::liberer(void *p_adresse, size_t p_taille)
+{
+    if (!p_adresse) return;
+    if (p_taille == 0) p_taille = 1;
+    size_t arrondie = (p_taille + granularite - 1) / granularite * granularite;
+    if (arrondie > tailleRecyclableMax) return;
+    Libre *libre = static_cast<Libre *>(p_adresse);
+    libre->suivant = m_libres[arrondie / granularite];
+    m_libres[arrondie / granularite] = libre;
+}
+
+size_t Arene::getNbBlocs() const
+{
+    return m_blocs.size();
+}
+
+size_t Arene::getOctetsReserves() const
+{
+    return m_octetsReserves;
+}
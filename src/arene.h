@@ -0,0 +1,104 @@
+//
+//  arene.h
+//  Arène d'allocation par gros blocs pour les structures du réseau (conteneurs à noeuds)
+//
+
+#ifndef TP2_ARENE_H
+#define TP2_ARENE_H
+
+#include <vector>
+#include <cstddef>
+
+//! \brief Arène: découpe de gros blocs de mémoire, libérés tous ensemble à sa destruction
+//! \note une allocation rendue (liberer()) est recyclée pour une allocation suivante de même taille (les petites
+//! allocations sont toutes alignées sur alignof(max_align_t), pour convenir à tout alignement demandé);
+//! les blocs eux-mêmes ne sont rendus au système qu'à la destruction de l'arène (ou par vider())
+//! \note une arène n'est pas protégée contre les accès concurrents
+class Arene
+{
+public:
+    explicit Arene(size_t p_tailleBloc = 1 << 20);
+    ~Arene();
+
+    void *allouer(size_t p_taille, size_t p_alignement);
+    void liberer(void *p_adresse, size_t p_taille);
+    void vider();
+
+    size_t getNbBlocs() const;
+    size_t getOctetsReserves() const;
+
+private:
+    Arene(const Arene &);
+    Arene &operator=(const Arene &);
+
+    static const size_t granularite = 16; //les tailles recyclables sont arrondies à un multiple de granularite
+    static const size_t tailleRecyclableMax = 512;
+
+    struct Libre
+    {
+        Libre *suivant;
+    };
+
+    std::vector<char *> m_blocs;
+    size_t m_tailleBloc;
+    size_t m_octetsReserves;
+    char *m_courant; //le prochain octet libre du bloc courant
+    char *m_fin; //la fin du bloc courant
+    std::vector<Libre *> m_libres; //m_libres[c]: les allocations rendues de la classe de taille c
+};
+
+//! \brief allocateur standard (std::allocator_traits) dont la mémoire provient d'une Arene
+//! \note l'arène doit survivre à tous les conteneurs qui l'utilisent
+template<typename T>
+class AllocateurArene
+{
+public:
+    typedef T value_type;
+
+    explicit AllocateurArene(Arene *p_arene) : m_arene(p_arene)
+    {
+    }
+
+    template<typename U>
+    AllocateurArene(const AllocateurArene<U> &p_autre) : m_arene(p_autre.getArene())
+    {
+    }
+
+    T *allocate(size_t p_nb)
+    {
+        return static_cast<T *>(m_arene->allouer(p_nb * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p_adresse, size_t p_nb)
+    {
+        m_arene->liberer(p_adresse, p_nb * sizeof(T));
+    }
+
+    Arene *getArene() const
+    {
+        return m_arene;
+    }
+
+    template<typename U>
+    struct rebind
+    {
+        typedef AllocateurArene<U> other;
+    };
+
+private:
+    Arene *m_arene;
+};
+
+template<typename T, typename U>
+bool operator==(const AllocateurArene<T> &a, const AllocateurArene<U> &b)
+{
+    return a.getArene() == b.getArene();
+}
+
+template<typename T, typename U>
+bool operator!=(const AllocateurArene<T> &a, const AllocateurArene<U> &b)
+{
+    return a.getArene() != b.getArene();
+}
+
+#endif //TP2_ARENE_H
@@ -0,0 +1,864 @@
+//
+//  bench.cpp
+//  Banc d'essai reproductible: chargement, construction du graphe et requêtes origine/destination
+//
+//  Usage: bench_exe [dossier_gtfs ou archive.zip] [--repetitions N] [--paires N] [--graine S]
+//                   [--fils N] [--pas S] [--patrons fichier] [--fenetre S] [--pietons km]
+//                   [--matrice S] [--seau S] [--tranche S]
+//  Chaque scénario écrit une ligne JSON sur la sortie standard; les messages de progression vont sur cerr.
+//
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <climits>
+#include <new>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "reseauStations.h"
+#include "patronsTransfert.h"
+#include "chargementGTFS.h"
+#include "fluxGTFS.h"
+#include "gestionnaireReseau.h"
+#include "lotRequetes.h"
+#include "matriceTemps.h"
+#include "statistiques.h"
+#include "memoire.h"
+#include "tableCoordonnees.h"
+#include "cheminsPietons.h"
+#include "archiveZip.h"
+#include "tranchesHoraires.h"
+
+using namespace std;
+
+namespace
+{
+    //le nombre d'appels à operator new depuis le démarrage (voir les remplacements globaux plus bas)
+    atomic<unsigned long> nbAllocations(0);
+}
+
+//remplacements globaux de new/delete: ils comptent les allocations du banc d'essai seulement
+//(GCC ne voit pas que new et delete sont remplacés ensemble et signale free() sur un pointeur de new)
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void *operator new(size_t p_taille)
+{
+    ++nbAllocations;
+    void *p = malloc(p_taille ? p_taille : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+    struct Configuration
+    {
+        string dossier = "RTC-9dec-24fev";
+        unsigned int repetitions = 5;
+        unsigned int nbPaires = 1000;
+        unsigned long graine = 42;
+        unsigned int nbFils = 0; //précalcul des patrons de transfert (0: autant que de coeurs)
+        unsigned int pas = 0; //pas d'échantillonnage des patrons de transfert, en secondes
+        string fichierPatrons; //si non vide, les patrons y sont sauvegardés puis rechargés
+        unsigned int fenetre = 72000; //durée de l'intervalle [heureDebut, heureFin), en secondes
+        double rayonPietons = 0.5; //rayon des chemins à pieds entre stations, en km
+        unsigned int dureeMatrice = 7200; //durée maximale des trajets de la matrice de station à station (0: aucune)
+        unsigned int largeurSeau = 300; //largeur des seaux de Graphe::distancesParSeaux(), en secondes
+        unsigned int largeurTranche = TranchesHoraires::largeurParDefaut; //largeur des tranches horaires, en secondes
+    };
+
+    //les paramètres de main.cpp
+    const Date date(2017, 2, 9);
+    const Date lendemain(2017, 2, 10); //pour le flux partagé entre deux dates
+    const Heure heureDebut(8, 30, 0);
+
+    //la mémoire résidente de chaque scénario, de la fin du scénario précédent (ou du démarrage) à son rapport
+    EchantillonneurMemoire &suiviMemoire()
+    {
+        static EchantillonneurMemoire echantillonneur(5);
+        return echantillonneur;
+    }
+
+    //la valeur au rang p (0 <= p <= 1) des durées triées
+    long rang(const vector<long> &p_triees, double p)
+    {
+        if (p_triees.empty()) return 0;
+        size_t i = static_cast<size_t>(p * (p_triees.size() - 1) + 0.5);
+        return p_triees[i];
+    }
+
+    //! \brief écrit la ligne JSON d'un scénario, puis commence la période de mémoire du scénario suivant
+    //! \param[in] p_durees: les durées (en microsecondes) dans l'ordre d'exécution; la première (premiere_us) n'est
+    //! pas comptée dans la médiane à chaud
+    //! \param[in] p_extra: des champs JSON supplémentaires (déjà formatés, chacun précédé d'une virgule)
+    //! \param[in] p_froides: les durées des exécutions à froid (précédées chacune de refroidir()), s'il y en a
+    //! \note memoire_debut_ko et memoire_pointe_ko: la mémoire résidente au début du scénario et son pic pendant
+    //! celui-ci (suiviMemoire())
+    void rapporter(const string &p_scenario, const vector<long> &p_durees, const string &p_extra = "",
+                   const vector<long> &p_froides = vector<long>())
+    {
+        vector<long> chaudes(p_durees.begin() + (p_durees.size() > 1 ? 1 : 0), p_durees.end());
+        sort(chaudes.begin(), chaudes.end());
+        vector<long> toutes(p_durees);
+        sort(toutes.begin(), toutes.end());
+        cout << "{\"scenario\":\"" << p_scenario << "\",\"repetitions\":" << p_durees.size()
+             << ",\"premiere_us\":" << (p_durees.empty() ? 0 : p_durees.front())
+             << ",\"mediane_chaud_us\":" << rang(chaudes, 0.5);
+        if (!p_froides.empty())
+        {
+            vector<long> froides(p_froides);
+            sort(froides.begin(), froides.end());
+            cout << ",\"repetitions_froides\":" << froides.size() << ",\"mediane_froide_us\":" << rang(froides, 0.5);
+        }
+        cout << ",\"p95_us\":" << rang(toutes, 0.95)
+             << ",\"max_us\":" << (toutes.empty() ? 0 : toutes.back())
+             << ",\"memoire_debut_ko\":" << suiviMemoire().getDebut()
+             << ",\"memoire_pointe_ko\":" << suiviMemoire().getPointe() << p_extra << "}" << endl;
+        suiviMemoire().reinitialiser();
+    }
+
+    //! \brief prépare une exécution à froid: les fichiers de la source GTFS sont retirés du cache de pages du
+    //! système (si le système de fichiers le permet: pas sur tmpfs), et les caches du processeur sont évincés par
+    //! le parcours d'un tampon plus grand qu'eux
+    void refroidir(const Configuration &p_config)
+    {
+        vector<string> fichiers;
+        if (ArchiveZip::estArchive(p_config.dossier))
+            fichiers.push_back(p_config.dossier);
+        else if (DIR *dossier = opendir(p_config.dossier.c_str()))
+        {
+            while (dirent *entree = readdir(dossier))
+                if (entree->d_name[0] != '.') fichiers.push_back(p_config.dossier + "/" + entree->d_name);
+            closedir(dossier);
+        }
+        for (const string &fichier : fichiers)
+        {
+            int descripteur = open(fichier.c_str(), O_RDONLY);
+            if (descripteur < 0) continue;
+            posix_fadvise(descripteur, 0, 0, POSIX_FADV_DONTNEED);
+            close(descripteur);
+        }
+        //le tampon est alloué une fois, avant le premier scénario: il compte dans la mémoire au début de chaque
+        //scénario, mais n'en gonfle pas le pic
+        static vector<char> tampon(64 << 20, 1);
+        volatile char somme = 0;
+        for (size_t i = 0; i < tampon.size(); i += 64) somme += tampon[i];
+    }
+
+    unique_ptr<DonneesGTFS> charger(const Configuration &p_config, bool p_prefiltrer = true)
+    {
+        unique_ptr<DonneesGTFS> donnees(new DonneesGTFS(date, heureDebut, heureDebut.add_secondes(p_config.fenetre)));
+        chargerDonneesGTFS(*donnees, p_config.dossier, nullptr, p_prefiltrer);
+        return donnees;
+    }
+
+    //exécute une requête complète (ajout des arcs, recherche, retrait des arcs) et retourne sa durée
+    //Reseau est ReseauGTFS ou ReseauStations
+    template<typename Reseau>
+    long requete(Reseau &p_reseau, const DonneesGTFS &p_donnees, const Coordonnees &p_origine,
+                 const Coordonnees &p_destination, StatistiquesRecherche &p_stats)
+    {
+        Chronometre chronometre;
+        long tempsRecherche;
+        p_reseau.ajouterArcsOrigineDestination(p_donnees, p_origine, p_destination);
+        p_reseau.calculerItineraire(tempsRecherche);
+        p_reseau.enleverArcsOrigineDestination();
+        p_stats = p_reseau.getStatistiquesRecherche();
+        return chronometre.ecoule();
+    }
+
+    //moyennes des compteurs de recherche (seulement si GTFS_STATS est défini, sinon ils sont nuls)
+    string champsRecherche(const vector<StatistiquesRecherche> &p_stats)
+    {
+        ostringstream extra;
+#ifndef GTFS_STATS
+        return extra.str();
+#endif
+        if (p_stats.empty()) return extra.str();
+        double fixes = 0, relaches = 0, tailleMax = 0;
+        for (auto &s : p_stats)
+        {
+            fixes += s.sommetsFixes;
+            relaches += s.arcsRelaches;
+            tailleMax += s.tailleMaxFile;
+        }
+        extra << ",\"sommets_fixes_moyen\":" << fixes / p_stats.size() << ",\"arcs_relaches_moyen\":"
+              << relaches / p_stats.size() << ",\"taille_max_file_moyenne\":" << tailleMax / p_stats.size();
+        return extra.str();
+    }
+
+    template<typename Reseau>
+    void scenarioOD(const string &p_nom, Reseau &p_reseau, const DonneesGTFS &p_donnees,
+                    const Coordonnees &p_origine, const Coordonnees &p_destination, const Configuration &p_config)
+    {
+        vector<long> durees, froides;
+        vector<StatistiquesRecherche> stats(p_config.repetitions);
+        for (unsigned int i = 0; i < p_config.repetitions; ++i)
+        {
+            refroidir(p_config);
+            froides.push_back(requete(p_reseau, p_donnees, p_origine, p_destination, stats[i]));
+        }
+        for (unsigned int i = 0; i < p_config.repetitions; ++i)
+            durees.push_back(requete(p_reseau, p_donnees, p_origine, p_destination, stats[i]));
+        rapporter(p_nom, durees, champsRecherche(stats), froides);
+    }
+
+    //compteurs matériels d'un scénario (vide s'ils ne sont pas disponibles)
+    string champsMateriel(const CompteursMateriel &p_compteurs, size_t p_nbRequetes)
+    {
+        ostringstream extra;
+        if (!p_compteurs.disponible() || p_nbRequetes == 0) return extra.str();
+        extra << ",\"cycles_par_requete\":" << p_compteurs.getCycles() / p_nbRequetes
+              << ",\"instructions_par_requete\":" << p_compteurs.getInstructions() / p_nbRequetes
+              << ",\"defauts_cache_par_requete\":" << p_compteurs.getDefautsCache() / p_nbRequetes;
+        return extra.str();
+    }
+
+    //exécute une requête par paire origine/destination et écrit la ligne JSON du scénario
+    template<typename Reseau>
+    void scenarioPaires(const string &p_nom, Reseau &p_reseau, const DonneesGTFS &p_donnees,
+                        const vector<pair<Coordonnees, Coordonnees> > &p_paires, const string &p_extra = "")
+    {
+        vector<long> durees;
+        vector<StatistiquesRecherche> stats(p_paires.size());
+        durees.reserve(p_paires.size());
+        CompteursMateriel compteurs;
+        unsigned long allocations = nbAllocations;
+        compteurs.demarrer();
+        for (size_t i = 0; i < p_paires.size(); ++i)
+            durees.push_back(requete(p_reseau, p_donnees, p_paires[i].first, p_paires[i].second, stats[i]));
+        compteurs.arreter();
+        allocations = nbAllocations - allocations;
+        ostringstream extra;
+        if (!p_paires.empty()) extra << ",\"allocations_par_requete\":" << allocations / p_paires.size();
+        rapporter(p_nom, durees, champsRecherche(stats) + champsMateriel(compteurs, p_paires.size()) + extra.str() + p_extra);
+    }
+
+    Configuration lireConfiguration(int argc, char *argv[])
+    {
+        Configuration config;
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            if (arg == "--repetitions" && i + 1 < argc) config.repetitions = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--paires" && i + 1 < argc) config.nbPaires = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--graine" && i + 1 < argc) config.graine = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--fils" && i + 1 < argc) config.nbFils = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--pas" && i + 1 < argc) config.pas = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--patrons" && i + 1 < argc) config.fichierPatrons = argv[++i];
+            else if (arg == "--fenetre" && i + 1 < argc) config.fenetre = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--pietons" && i + 1 < argc) config.rayonPietons = strtod(argv[++i], nullptr);
+            else if (arg == "--matrice" && i + 1 < argc) config.dureeMatrice = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--seau" && i + 1 < argc) config.largeurSeau = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--tranche" && i + 1 < argc) config.largeurTranche = strtoul(argv[++i], nullptr, 10);
+            else config.dossier = arg;
+        }
+        if (config.repetitions == 0) config.repetitions = 1;
+        return config;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Configuration config = lireConfiguration(argc, argv);
+    cerr << "Banc d'essai sur " << config.dossier << " (" << config.repetitions << " répétitions, "
+         << config.nbPaires << " paires aléatoires, graine " << config.graine << ")" << endl;
+
+    //chargement complet des données, à froid (fichiers hors du cache de pages) puis à chaud
+    refroidir(config);
+    suiviMemoire().reinitialiser();
+    vector<long> durees, froides;
+    unique_ptr<DonneesGTFS> donnees;
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        donnees.reset();
+        refroidir(config);
+        Chronometre chronometre;
+        donnees = charger(config);
+        froides.push_back(chronometre.ecoule());
+    }
+    unsigned long allocations = 0; //les allocations de la dernière répétition
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        donnees.reset();
+        allocations = nbAllocations;
+        Chronometre chronometre;
+        donnees = charger(config);
+        durees.push_back(chronometre.ecoule());
+        allocations = nbAllocations - allocations;
+    }
+    {
+        ostringstream extra;
+        extra << ",\"arrets\":" << donnees->getNbArrets() << ",\"voyages\":" << donnees->getNbVoyages()
+              << ",\"stations\":" << donnees->getNbStations() << ",\"allocations\":" << allocations;
+        rapporter("chargement", durees, extra.str(), froides);
+    }
+
+    //le même chargement sans le préfiltre de stop_times.txt
+    durees.clear();
+    froides.clear();
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        refroidir(config);
+        Chronometre chronometre;
+        charger(config, false);
+        froides.push_back(chronometre.ecoule());
+    }
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        Chronometre chronometre;
+        charger(config, false);
+        durees.push_back(chronometre.ecoule());
+    }
+    rapporter("chargement_sans_prefiltre", durees, "", froides);
+
+    //flux partagé: stop_times.txt est lu une fois, puis on produit les données de deux dates
+    {
+        Chronometre chronometre;
+        FluxGTFS flux(config.dossier);
+        durees.assign(1, chronometre.ecoule());
+        ostringstream extra;
+        extra << ",\"horaires\":" << flux.getNbHoraires() << ",\"octets_texte\":" << flux.getTailleTexte();
+        rapporter("chargement_flux", durees, extra.str());
+
+        durees.clear();
+        for (unsigned int i = 0; i < config.repetitions; ++i)
+        {
+            Chronometre chronometreDates;
+            flux.donneesDeLaDate(date, heureDebut, heureDebut.add_secondes(config.fenetre));
+            flux.donneesDeLaDate(lendemain, heureDebut, heureDebut.add_secondes(config.fenetre));
+            durees.push_back(chronometreDates.ecoule());
+        }
+        rapporter("donnees_deux_dates_flux", durees);
+    }
+
+    //construction du graphe, à froid (caches du processeur évincés) puis à chaud; chaque répétition construit un
+    //nouveau réseau
+    durees.clear();
+    froides.clear();
+    unique_ptr<ReseauGTFS> reseau;
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        reseau.reset();
+        refroidir(config);
+        Chronometre chronometre;
+        reseau.reset(new ReseauGTFS(*donnees));
+        froides.push_back(chronometre.ecoule());
+    }
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        reseau.reset();
+        allocations = nbAllocations;
+        Chronometre chronometre;
+        reseau.reset(new ReseauGTFS(*donnees));
+        durees.push_back(chronometre.ecoule());
+        allocations = nbAllocations - allocations;
+    }
+    {
+        ostringstream extra;
+        extra << ",\"octets_par_arc\":" << reseau->getGraphe().getTailleArc() << ",\"allocations\":" << allocations;
+        rapporter("construction", durees, extra.str(), froides);
+    }
+
+    //mémoire par composant (données GTFS et réseau), rapportée au nombre d'arrêts pour comparer des flux de tailles
+    //différentes; la durée est celle du parcours des structures
+    {
+        RapportMemoire memoire;
+        Chronometre chronometre;
+        mesurerMemoire(*donnees, memoire);
+        reseau->mesurerMemoire(memoire);
+        durees.assign(1, chronometre.ecoule());
+        ostringstream extra;
+        memoire.ecrireChampsJSON(extra);
+        extra << ",\"arrets\":" << donnees->getNbArrets() << ",\"octets_par_arret\":"
+              << (donnees->getNbArrets() ? memoire.getTotal() / donnees->getNbArrets() : 0);
+        rapporter("memoire", durees, extra.str());
+    }
+
+    //chemins à pieds entre stations voisines (index spatial), puis le graphe qui les ajoute aux transferts
+    CheminsPietons chemins(*donnees, config.rayonPietons);
+    durees.clear();
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        Chronometre chronometre;
+        chemins.calculer(config.nbFils);
+        durees.push_back(chronometre.ecoule());
+    }
+    {
+        ostringstream extra;
+        extra << ",\"rayon_km\":" << config.rayonPietons << ",\"chemins\":" << chemins.getNbChemins()
+              << ",\"transferts\":" << donnees->getNbTransferts();
+        rapporter("chemins_pietons", durees, extra.str());
+
+        const char *dossierTemporaire = getenv("TMPDIR");
+        const string fichier = string(dossierTemporaire && *dossierTemporaire ? dossierTemporaire : "/tmp") + "/" +
+                               chemins.getNomCache();
+        chemins.sauvegarder(fichier);
+        Chronometre chronometre;
+        CheminsPietons relus(*donnees, config.rayonPietons);
+        relus.charger(fichier);
+        durees.assign(1, chronometre.ecoule());
+        remove(fichier.c_str());
+        rapporter("chemins_pietons_cache", durees);
+    }
+    unique_ptr<ReseauGTFS> reseauPietons;
+    durees.clear();
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        reseauPietons.reset();
+        Chronometre chronometre;
+        reseauPietons.reset(new ReseauGTFS(*donnees, true, LargeurGraphe::automatique, &chemins));
+        durees.push_back(chronometre.ecoule());
+    }
+    rapporter("construction_pietons", durees);
+    reseauPietons->activerCache(false);
+
+    //matrice des durées de station à station (une recherche par station), puis accès aléatoires au fichier 16 bits
+    if (config.dureeMatrice > 0)
+    {
+        MatriceTemps matrice;
+        durees.clear();
+        Chronometre chronometre;
+        matrice.calculer(*donnees, *reseau, heureDebut, config.dureeMatrice, config.nbFils);
+        durees.push_back(chronometre.ecoule());
+        size_t atteintes = 0;
+        const size_t n = matrice.getNbStations();
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                if (matrice.getDuree(i, j) != MatriceTemps::inatteignable) ++atteintes;
+        ostringstream extra;
+        extra << ",\"stations\":" << n << ",\"paires_atteintes\":" << atteintes;
+        rapporter("matrice_temps", durees, extra.str());
+
+        const char *dossierTemporaire = getenv("TMPDIR");
+        const string fichier = string(dossierTemporaire && *dossierTemporaire ? dossierTemporaire : "/tmp") +
+                               "/matrice-bench.bin";
+        matrice.sauvegarder(fichier, MatriceTemps::Codage::quantifie16);
+        MatriceTemps projetee;
+        projetee.charger(fichier);
+        mt19937 generateurMatrice(config.graine);
+        uniform_int_distribution<size_t> indice(0, n - 1);
+        const unsigned int nbAcces = 1000000;
+        unsigned long somme = 0;
+        chronometre = Chronometre();
+        for (unsigned int k = 0; k < nbAcces; ++k)
+            somme += projetee.getDuree(indice(generateurMatrice), indice(generateurMatrice));
+        durees.assign(1, chronometre.ecoule());
+        remove(fichier.c_str());
+        ostringstream extraFichier;
+        extraFichier << ",\"acces\":" << nbAcces << ",\"pas\":" << projetee.getPas() << ",\"somme\":" << somme;
+        rapporter("matrice_temps_acces_16bits", durees, extraFichier.str());
+    }
+
+    //distances vers tous les sommets depuis quelques arrêts: Dijkstra séquentiel contre delta-stepping de 1 à N fils
+    {
+        const GrapheAbstrait &graphe = reseau->getGraphe();
+        vector<size_t> racines;
+        mt19937 generateurRacines(config.graine);
+        vector<const Station *> sources;
+        for (auto &station : donnees->getStations()) sources.push_back(&station.second);
+        uniform_int_distribution<size_t> indice(0, sources.size() - 1);
+        for (unsigned int essai = 0; racines.size() < 8 && essai < 1000; ++essai)
+        {
+            const multimap<Heure, Arret::Ptr> &arrets = sources[indice(generateurRacines)]->getArrets();
+            auto premier = arrets.lower_bound(heureDebut);
+            if (premier != arrets.end()) racines.push_back(reseau->getSommetDeArret(premier->second));
+        }
+
+        vector<vector<unsigned int> > reference(racines.size());
+        vector<size_t> parent;
+        durees.clear();
+        for (unsigned int r = 0; r < config.repetitions; ++r)
+        {
+            Chronometre chronometre;
+            for (size_t k = 0; k < racines.size(); ++k)
+                graphe.arbrePlusCourtsChemins(racines[k], false, UINT_MAX, reference[k], parent);
+            durees.push_back(chronometre.ecoule());
+        }
+        ostringstream extraReference;
+        extraReference << ",\"racines\":" << racines.size() << ",\"sommets\":" << graphe.getNbSommets();
+        rapporter("distances_sequentielles", durees, extraReference.str());
+
+        const unsigned int nbCoeurs = max(1u, thread::hardware_concurrency());
+        const unsigned int maxFils = config.nbFils ? config.nbFils : nbCoeurs;
+        long medianeUnFil = 0;
+        vector<unsigned int> distance;
+        //1, 2, 4, ... fils, puis maxFils
+        for (unsigned int nbFils = 1;; nbFils = min(2 * nbFils, maxFils))
+        {
+            bool identiques = true;
+            durees.clear();
+            for (unsigned int r = 0; r < config.repetitions; ++r)
+            {
+                Chronometre chronometre;
+                for (size_t k = 0; k < racines.size(); ++k)
+                {
+                    graphe.distancesParSeaux(racines[k], config.largeurSeau, nbFils, distance);
+                    if (distance != reference[k]) identiques = false;
+                }
+                durees.push_back(chronometre.ecoule());
+            }
+            vector<long> triees(durees.begin() + (durees.size() > 1 ? 1 : 0), durees.end());
+            sort(triees.begin(), triees.end());
+            const long mediane = rang(triees, 0.5);
+            if (nbFils == 1) medianeUnFil = mediane;
+            ostringstream extra;
+            extra << ",\"fils\":" << nbFils << ",\"coeurs\":" << nbCoeurs << ",\"largeur_seau\":" << config.largeurSeau
+                  << ",\"acceleration\":" << (mediane ? static_cast<double>(medianeUnFil) / mediane : 0.0)
+                  << ",\"identiques\":" << (identiques ? "true" : "false");
+            rapporter("distances_par_seaux", durees, extra.str());
+            if (nbFils == maxFils) break;
+        }
+    }
+
+    //le même graphe sans renumérotation des sommets (ordre des trip_id), pour mesurer l'effet de la localité
+    unique_ptr<ReseauGTFS> reseauNonRenumerote(new ReseauGTFS(*donnees, false));
+    reseauNonRenumerote->activerCache(false);
+
+    //le même graphe avec les largeurs d'origine (sommets size_t, poids unsigned int)
+    unique_ptr<ReseauGTFS> reseauEtendu(new ReseauGTFS(*donnees, true, LargeurGraphe::etendue));
+    reseauEtendu->activerCache(false);
+    {
+        RapportMemoire memoire;
+        Chronometre chronometre;
+        reseauEtendu->mesurerMemoire(memoire);
+        durees.assign(1, chronometre.ecoule());
+        ostringstream extra;
+        memoire.ecrireChampsJSON(extra);
+        rapporter("memoire_reseau_largeurs_etendues", durees, extra.str());
+    }
+
+    //construction du modèle par stations
+    durees.clear();
+    unique_ptr<ReseauStations> stations;
+    for (unsigned int i = 0; i < config.repetitions; ++i)
+    {
+        stations.reset();
+        Chronometre chronometre;
+        stations.reset(new ReseauStations(*donnees));
+        durees.push_back(chronometre.ecoule());
+    }
+    {
+        ostringstream extra;
+        extra << ",\"sommets\":" << stations->getNbSommets() << ",\"arcs\":" << stations->getNbArcs()
+              << ",\"connexions\":" << stations->getNbConnexions();
+        rapporter("construction_stations", durees, extra.str());
+    }
+
+    //distances entre toutes les paires de stations: Coordonnees::operator- contre TableCoordonnees (par jeu d'instructions)
+    {
+        vector<Coordonnees> points;
+        for (auto &station : donnees->getStations()) points.push_back(station.second.getCoords());
+        const size_t n = points.size();
+        vector<double> reference(n * n), matrice;
+        durees.clear();
+        for (unsigned int r = 0; r < config.repetitions; ++r)
+        {
+            Chronometre chronometre;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j) reference[i * n + j] = points[i] - points[j];
+            durees.push_back(chronometre.ecoule());
+        }
+        ostringstream extraReference;
+        extraReference << ",\"paires\":" << n * n;
+        rapporter("distances_operateur", durees, extraReference.str());
+
+        TableCoordonnees table(points);
+        const JeuInstructions jeuParDefaut = TableCoordonnees::getJeuInstructions();
+        const JeuInstructions jeux[] = {JeuInstructions::scalaire, JeuInstructions::sse2, JeuInstructions::avx};
+        const char *noms[] = {"distances_table_scalaire", "distances_table_sse2", "distances_table_avx"};
+        for (size_t k = 0; k < 3; ++k)
+        {
+            if (!TableCoordonnees::estDisponible(jeux[k])) continue;
+            TableCoordonnees::choisirJeuInstructions(jeux[k]);
+            durees.clear();
+            for (unsigned int r = 0; r < config.repetitions; ++r)
+            {
+                Chronometre chronometre;
+                table.distancesEntre(table, matrice);
+                durees.push_back(chronometre.ecoule());
+            }
+            double ecartMax = 0; //operator- donne parfois NaN pour une station et elle-même
+            for (size_t i = 0; i < n * n; ++i)
+                if (reference[i] == reference[i]) ecartMax = max(ecartMax, fabs(reference[i] - matrice[i]));
+            ostringstream extra;
+            extra << ",\"paires\":" << n * n << ",\"ecart_max_km\":" << ecartMax;
+            rapporter(noms[k], durees, extra.str());
+        }
+        TableCoordonnees::choisirJeuInstructions(jeuParDefaut);
+    }
+
+    //précalcul des patrons de transfert (une seule fois: c'est l'étape hors ligne)
+    PatronsTransfert patrons(*donnees, *stations);
+    {
+        Chronometre chronometre;
+        patrons.precalculer(config.nbFils, config.pas);
+        durees.assign(1, chronometre.ecoule());
+        ostringstream extra;
+        extra << ",\"noeuds\":" << patrons.getNbNoeuds() << ",\"lignes_directes\":" << patrons.getNbLignesDirectes()
+              << ",\"pas\":" << config.pas;
+        rapporter("precalcul_patrons", durees, extra.str());
+    }
+    if (!config.fichierPatrons.empty())
+    {
+        patrons.sauvegarder(config.fichierPatrons);
+        Chronometre chronometre;
+        patrons.charger(config.fichierPatrons);
+        durees.assign(1, chronometre.ecoule());
+        rapporter("chargement_patrons", durees);
+    }
+
+    //on mesure la recherche elle-même, pas le cache
+    reseau->activerCache(false);
+
+    //les deux cas documentés dans main.cpp
+    Coordonnees ste_foy(46.758029, -71.336759); //Int. Chemin ste-Foy et Quatre-Bourgeois
+    Coordonnees videotron(46.829049, -71.248305); //Centre Videotron
+    scenarioOD("cas1_stefoy_videotron", *reseau, *donnees, ste_foy, videotron, config);
+    scenarioOD("cas2_videotron_stefoy", *reseau, *donnees, videotron, ste_foy, config);
+    scenarioOD("cas1_stefoy_videotron_stations", *stations, *donnees, ste_foy, videotron, config);
+    scenarioOD("cas2_videotron_stefoy_stations", *stations, *donnees, videotron, ste_foy, config);
+    scenarioOD("cas1_stefoy_videotron_patrons", patrons, *donnees, ste_foy, videotron, config);
+    scenarioOD("cas2_videotron_stefoy_patrons", patrons, *donnees, videotron, ste_foy, config);
+
+    //paires origine/destination aléatoires (graine fixe) dans le rectangle englobant les stations
+    double latMin = 90, latMax = -90, lonMin = 180, lonMax = -180;
+    for (auto &station : donnees->getStations())
+    {
+        const Coordonnees &c = station.second.getCoords();
+        latMin = min(latMin, c.getLatitude());
+        latMax = max(latMax, c.getLatitude());
+        lonMin = min(lonMin, c.getLongitude());
+        lonMax = max(lonMax, c.getLongitude());
+    }
+    mt19937 generateur(config.graine);
+    uniform_real_distribution<double> lat(latMin, latMax);
+    uniform_real_distribution<double> lon(lonMin, lonMax);
+    vector<pair<Coordonnees, Coordonnees> > paires;
+    for (unsigned int i = 0; i < config.nbPaires; ++i)
+    {
+        Coordonnees origine(lat(generateur), lon(generateur));
+        Coordonnees destination(lat(generateur), lon(generateur));
+        paires.push_back(make_pair(origine, destination));
+    }
+    scenarioPaires("od_aleatoires", *reseau, *donnees, paires);
+    scenarioPaires("od_aleatoires_sans_renumerotation", *reseauNonRenumerote, *donnees, paires);
+    {
+        //les mêmes paires avec les chemins à pieds; on compte les itinéraires plus rapides grâce à eux
+        unsigned int ameliores = 0;
+        for (auto &p : paires)
+        {
+            long temps;
+            reseau->ajouterArcsOrigineDestination(*donnees, p.first, p.second);
+            reseauPietons->ajouterArcsOrigineDestination(*donnees, p.first, p.second);
+            if (reseauPietons->calculerItineraire(temps).duree < reseau->calculerItineraire(temps).duree) ++ameliores;
+            reseau->enleverArcsOrigineDestination();
+            reseauPietons->enleverArcsOrigineDestination();
+        }
+        ostringstream extra;
+        extra << ",\"ameliores\":" << ameliores;
+        scenarioPaires("od_aleatoires_pietons", *reseauPietons, *donnees, paires, extra.str());
+    }
+    {
+        //les mêmes paires, jusqu'à 5 itinéraires différents par paire (au plus 30% plus longs, moitié des voyages en commun)
+        durees.clear();
+        size_t nbItineraires = 0;
+        for (auto &p : paires)
+        {
+            Chronometre chronometre;
+            long temps;
+            reseau->ajouterArcsOrigineDestination(*donnees, p.first, p.second);
+            nbItineraires += reseau->calculerAlternatives(5, 0.5, 1.3, temps).size();
+            reseau->enleverArcsOrigineDestination();
+            durees.push_back(chronometre.ecoule());
+        }
+        ostringstream extra;
+        if (!paires.empty()) extra << ",\"itineraires_moyens\":" << static_cast<double>(nbItineraires) / paires.size();
+        rapporter("od_aleatoires_alternatives", durees, extra.str());
+    }
+    {
+        ostringstream extra;
+        extra << ",\"octets_par_arc\":" << reseauEtendu->getGraphe().getTailleArc();
+        scenarioPaires("od_aleatoires_largeurs_etendues", *reseauEtendu, *donnees, paires, extra.str());
+    }
+
+    //les mêmes paires sur le modèle par stations
+    scenarioPaires("od_aleatoires_stations", *stations, *donnees, paires);
+
+    //les mêmes paires avec les patrons de transfert; on compte les itinéraires aussi rapides que le réseau par stations
+    durees.clear();
+    vector<StatistiquesRecherche> stats(config.nbPaires);
+    unsigned int optimaux = 0;
+    for (unsigned int i = 0; i < config.nbPaires; ++i)
+    {
+        durees.push_back(requete(patrons, *donnees, paires[i].first, paires[i].second, stats[i]));
+        long temps;
+        stations->ajouterArcsOrigineDestination(*donnees, paires[i].first, paires[i].second);
+        patrons.ajouterArcsOrigineDestination(*donnees, paires[i].first, paires[i].second);
+        if (stations->calculerItineraire(temps).duree == patrons.calculerItineraire(temps).duree) ++optimaux;
+        stations->enleverArcsOrigineDestination();
+        patrons.enleverArcsOrigineDestination();
+    }
+    {
+        ostringstream extra;
+        extra << champsRecherche(stats) << ",\"optimaux\":" << optimaux;
+        rapporter("od_aleatoires_patrons", durees, extra.str());
+    }
+
+    //les mêmes paires en lot (fichier de requêtes, heures de départ réparties sur la première heure), sans modifier
+    //le réseau: lecture, calcul et écriture se chevauchent
+    if (!paires.empty())
+    {
+        const char *dossierTemporaire = getenv("TMPDIR");
+        const string dossier = dossierTemporaire && *dossierTemporaire ? dossierTemporaire : "/tmp";
+        const string fichierRequetes = dossier + "/requetes-bench.csv";
+        const string fichierItineraires = dossier + "/itineraires-bench.jsonl";
+        {
+            ofstream requetes(fichierRequetes);
+            requetes.precision(10);
+            for (size_t i = 0; i < paires.size(); ++i)
+            {
+                const unsigned int depart = (heureDebut - Heure(0, 0, 0)) + i * 3600 / paires.size();
+                requetes << paires[i].first.getLatitude() << ',' << paires[i].first.getLongitude() << ','
+                         << paires[i].second.getLatitude() << ',' << paires[i].second.getLongitude() << ','
+                         << depart / 3600 << ':' << depart / 60 % 60 << ':' << depart % 60 << '\n';
+            }
+        }
+        LotRequetes lot(*donnees, *reseau);
+        RapportLot bilan;
+        durees.clear();
+        for (unsigned int r = 0; r < config.repetitions; ++r)
+        {
+            Chronometre chronometre;
+            bilan = lot.traiter(fichierRequetes, fichierItineraires, config.nbFils);
+            durees.push_back(chronometre.ecoule());
+        }
+        remove(fichierRequetes.c_str());
+        remove(fichierItineraires.c_str());
+        ostringstream extra;
+        extra << ",\"requetes\":" << bilan.requetes << ",\"erreurs\":" << bilan.erreurs << ",\"fils\":" << bilan.nbFils
+              << ",\"requetes_par_seconde\":" << (bilan.duree ? bilan.requetes * 1e6 / bilan.duree : 0.0)
+              << ",\"occupation_calcul\":"
+              << (bilan.duree ? static_cast<double>(bilan.calcul) / (bilan.duree * bilan.nbFils) : 0.0);
+        rapporter("lot_requetes", durees, extra.str());
+    }
+
+    //les tranches horaires: construites en parallèle, sauvegardées, puis rouvertes (chaque tranche est projetée à
+    //la demande) et interrogées sans le réseau; les mêmes paires et heures de départ que le lot, comparées à la
+    //recherche dans le graphe entier
+    if (!paires.empty() && config.largeurTranche > 0)
+    {
+        const char *dossierTemporaire = getenv("TMPDIR");
+        const string dossier = dossierTemporaire && *dossierTemporaire ? dossierTemporaire : "/tmp";
+        const string fichierTranches = dossier + "/tranches-bench.bin";
+        const unsigned int nbFils = config.nbFils ? config.nbFils : max(1u, thread::hardware_concurrency());
+        durees.clear();
+        size_t nbTranches = 0;
+        for (unsigned int r = 0; r < config.repetitions; ++r)
+        {
+            TranchesHoraires construites;
+            Chronometre chronometre;
+            construites.construire(*reseau, *donnees, config.largeurTranche, nbFils);
+            durees.push_back(chronometre.ecoule());
+            nbTranches = construites.getNbTranches();
+            if (r == 0) construites.sauvegarder(fichierTranches);
+        }
+        ostringstream extraConstruction;
+        extraConstruction << ",\"tranches\":" << nbTranches << ",\"largeur_tranche\":" << config.largeurTranche
+                          << ",\"fils\":" << nbFils;
+        rapporter("construction_tranches", durees, extraConstruction.str());
+
+        TranchesHoraires tranches;
+        tranches.charger(fichierTranches);
+        EspaceRequete espace;
+        EspaceTranches espaceTranches;
+        vector<long> dureesReference;
+        size_t identiques = 0, touchees = 0, octetsEspace = 0;
+        durees.clear();
+        for (size_t i = 0; i < paires.size(); ++i)
+        {
+            const Heure depart = heureDebut.add_secondes(i * 3600 / paires.size());
+            Chronometre chronometreReference;
+            const Itineraire reference = reseau->calculerItineraire(*donnees, paires[i].first, paires[i].second,
+                                                                    depart, espace);
+            dureesReference.push_back(chronometreReference.ecoule());
+            size_t nb = 0;
+            Chronometre chronometre;
+            const Itineraire itineraire = tranches.calculerItineraire(paires[i].first, paires[i].second, depart,
+                                                                      espaceTranches, &nb);
+            durees.push_back(chronometre.ecoule());
+            touchees += nb;
+            if (itineraire.atteignable == reference.atteignable &&
+                (!reference.atteignable || itineraire.duree == reference.duree))
+                ++identiques;
+        }
+        //les distances et prédécesseurs de l'espace de travail: seules les tranches visitées en ont
+        for (size_t k = 0; k < espaceTranches.distance.size(); ++k)
+            octetsEspace += octetsVecteur(espaceTranches.distance[k]) + octetsVecteur(espaceTranches.predecesseur[k]);
+        RapportMemoire memoire;
+        tranches.mesurerMemoire(memoire);
+        remove(fichierTranches.c_str());
+        sort(dureesReference.begin(), dureesReference.end());
+        ostringstream extra;
+        extra << ",\"tranches\":" << tranches.getNbTranches() << ",\"tranches_projetees\":"
+              << tranches.getNbTranchesProjetees() << ",\"tranches_touchees_moyennes\":"
+              << static_cast<double>(touchees) / paires.size() << ",\"identiques\":" << identiques
+              << ",\"mediane_graphe_us\":" << rang(dureesReference, 0.5) << ",\"espace_requete_octets\":"
+              << octetsEspace;
+        memoire.ecrireChampsJSON(extra);
+        rapporter("od_aleatoires_tranches", durees, extra.str());
+    }
+
+    //rechargement à chaud: les mêmes paires, en boucle, pendant que la version suivante se construit
+    //(en dernier: le pic exact du rechargement efface celui du processus)
+    {
+        GestionnaireReseau gestionnaire;
+        gestionnaire.activerPointeExacte(true);
+        gestionnaire.activerCache(false); //les paires reviennent en boucle: on mesure les recherches
+        const SourceReseau source(config.dossier, date, heureDebut, heureDebut.add_secondes(config.fenetre));
+        gestionnaire.charger(source);
+        gestionnaire.recharger(source);
+        durees.clear();
+        for (size_t i = 0; !paires.empty() && gestionnaire.estEnRechargement(); i = (i + 1) % paires.size())
+        {
+            Chronometre chronometre;
+            gestionnaire.calculerItineraire(paires[i].first, paires[i].second, heureDebut);
+            durees.push_back(chronometre.ecoule());
+        }
+        RapportRechargement rapport = gestionnaire.attendreRechargement();
+        ostringstream extra;
+        extra << ",\"chargement_us\":" << rapport.chargement << ",\"construction_us\":" << rapport.construction
+              << ",\"rechargement_memoire_avant_ko\":" << rapport.memoireAvant
+              << ",\"rechargement_memoire_pointe_ko\":" << rapport.memoirePointe
+              << ",\"versions_vivantes\":" << GestionnaireReseau::getNbVersionsVivantes();
+        rapporter("requetes_pendant_rechargement", durees, extra.str());
+    }
+
+    return 0;
+}
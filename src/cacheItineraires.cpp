@@ -0,0 +1,159 @@
+//
+//  cacheItineraires.cpp
+//  Cache borné (LRU, fragmenté) des itinéraires calculés par ReseauGTFS
+//
+
+#include "cacheItineraires.h"
+
+using namespace std;
+
+bool CacheItineraires::Cle::operator==(const Cle &p_autre) const
+{
+    return latOrigine == p_autre.latOrigine && lonOrigine == p_autre.lonOrigine &&
+           latDestination == p_autre.latDestination && lonDestination == p_autre.lonDestination &&
+           tranche == p_autre.tranche;
+}
+
+size_t CacheItineraires::HachageCle::operator()(const Cle &p_cle) const
+{
+    //mélange de type FNV-1a sur les cinq composantes de la clé
+    uint64_t h = 14695981039346656037ULL;
+    const int32_t composantes[] = {p_cle.latOrigine, p_cle.lonOrigine, p_cle.latDestination, p_cle.lonDestination,
+                                   p_cle.tranche};
+    for (int32_t c : composantes)
+    {
+        h ^= static_cast<uint32_t>(c);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+//! \brief Constructeur
+//! \param[in] p_capacite: le nombre maximal d'itinéraires conservés (0 désactive le cache)
+//! \param[in] p_tailleCellule: le côté, en degrés, d'une cellule de la grille de quantification des coordonnées
+//! \param[in] p_largeurTranche: la largeur, en secondes, d'une tranche d'heure de départ
+//! \param[in] p_nbFragments: le nombre de fragments (chacun avec son verrou)
+//! \throws logic_error si p_tailleCellule <= 0, p_largeurTranche == 0 ou p_nbFragments == 0
+CacheItineraires::CacheItineraires(size_t p_capacite, double p_tailleCellule, unsigned int p_largeurTranche,
+                                   size_t p_nbFragments)
+    : m_tailleCellule(p_tailleCellule), m_largeurTranche(p_largeurTranche), m_nbSucces(0), m_nbEchecs(0)
+{
+    if (p_tailleCellule <= 0) throw logic_error("CacheItineraires::CacheItineraires(): taille de cellule invalide");
+    if (p_largeurTranche == 0) throw logic_error("CacheItineraires::CacheItineraires(): largeur de tranche invalide");
+    if (p_nbFragments == 0) throw logic_error("CacheItineraires::CacheItineraires(): nombre de fragments invalide");
+    m_capaciteParFragment = (p_capacite + p_nbFragments - 1) / p_nbFragments;
+    for (size_t i = 0; i < p_nbFragments; ++i)
+        m_fragments.push_back(unique_ptr<Fragment>(new Fragment));
+}
+
+//! \brief construit la clé quantifiée d'une requête
+//! \param[in] p_origine: les coordonnées du point origine
+//! \param[in] p_destination: les coordonnées du point destination
+//! \param[in] p_depart: l'heure de départ du point origine
+CacheItineraires::Cle CacheItineraires::cle(const Coordonnees &p_origine, const Coordonnees &p_destination,
+                                            const Heure &p_depart) const
+{
+    Cle c;
+    c.latOrigine = static_cast<int32_t>(floor(p_origine.getLatitude() / m_tailleCellule));
+    c.lonOrigine = static_cast<int32_t>(floor(p_origine.getLongitude() / m_tailleCellule));
+    c.latDestination = static_cast<int32_t>(floor(p_destination.getLatitude() / m_tailleCellule));
+    c.lonDestination = static_cast<int32_t>(floor(p_destination.getLongitude() / m_tailleCellule));
+    c.tranche = static_cast<int32_t>((p_depart - Heure(0, 0, 0)) / static_cast<int>(m_largeurTranche));
+    return c;
+}
+
+CacheItineraires::Fragment &CacheItineraires::fragmentDe(const Cle &p_cle) const
+{
+    //on n'utilise pas les bits de poids faible, déjà utilisés par l'unordered_map du fragment
+    return *m_fragments[(HachageCle()(p_cle) >> 16) % m_fragments.size()];
+}
+
+//! \brief cherche un itinéraire dans le cache
+//! \param[in] p_cle: la clé quantifiée de la requête
+//! \param[out] p_itineraire: l'itinéraire trouvé (inchangé si absent)
+//! \return true si l'itinéraire était présent
+//! \post l'entrée trouvée devient la plus récemment utilisée de son fragment
+bool CacheItineraires::chercher(const Cle &p_cle, Itineraire &p_itineraire) const
+{
+    Fragment &fragment = fragmentDe(p_cle);
+    {
+        lock_guard<mutex> verrou(fragment.verrou);
+        auto itr = fragment.index.find(p_cle);
+        if (itr != fragment.index.end())
+        {
+            fragment.lru.splice(fragment.lru.begin(), fragment.lru, itr->second);
+            p_itineraire = itr->second->second;
+            ++m_nbSucces;
+            return true;
+        }
+    }
+    ++m_nbEchecs;
+    return false;
+}
+
+//! \brief insère (ou remplace) un itinéraire dans le cache
+//! \post si le fragment est plein, son entrée la moins récemment utilisée est évincée
+void CacheItineraires::inserer(const Cle &p_cle, const Itineraire &p_itineraire)
+{
+    if (m_capaciteParFragment == 0) return;
+    Fragment &fragment = fragmentDe(p_cle);
+    lock_guard<mutex> verrou(fragment.verrou);
+    auto itr = fragment.index.find(p_cle);
+    if (itr != fragment.index.end())
+    {
+        itr->second->second = p_itineraire;
+        fragment.lru.splice(fragment.lru.begin(), fragment.lru, itr->second);
+        return;
+    }
+    if (fragment.lru.size() >= m_capaciteParFragment)
+    {
+        fragment.index.erase(fragment.lru.back().first);
+        fragment.lru.pop_back();
+    }
+    fragment.lru.push_front(make_pair(p_cle, p_itineraire));
+    fragment.index[p_cle] = fragment.lru.begin();
+}
+
+//! \brief vide le cache (les compteurs de succès et d'échecs sont conservés)
+void CacheItineraires::vider()
+{
+    for (auto &fragment : m_fragments)
+    {
+        lock_guard<mutex> verrou(fragment->verrou);
+        fragment->index.clear();
+        fragment->lru.clear();
+    }
+}
+
+size_t CacheItineraires::getTaille() const
+{
+    size_t taille = 0;
+    for (auto &fragment : m_fragments)
+    {
+        lock_guard<mutex> verrou(fragment->verrou);
+        taille += fragment->lru.size();
+    }
+    return taille;
+}
+
+size_t CacheItineraires::getCapacite() const
+{
+    return m_capaciteParFragment * m_fragments.size();
+}
+
+unsigned long CacheItineraires::getNbSucces() const
+{
+    return m_nbSucces;
+}
+
+unsigned long CacheItineraires::getNbEchecs() const
+{
+    return m_nbEchecs;
+}
+
+double CacheItineraires::getTauxSucces() const
+{
+    unsigned long succes = m_nbSucces;
+    unsigned long total = succes + m_nbEchecs;
+    return total == 0 ? 0.0 : double(succes) / double(total);
+}
@@ -0,0 +1,79 @@
+//
+//  cacheItineraires.h
+//  Cache borné (LRU, fragmenté) des itinéraires calculés par ReseauGTFS
+//
+
+#ifndef TP2_CACHEITINERAIRES_H
+#define TP2_CACHEITINERAIRES_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "coordonnees.h"
+#include "auxiliaires.h"
+#include "itineraire.h"
+
+//! \brief Cache des résultats de requêtes origine/destination
+//! \note les coordonnées sont quantifiées sur une grille (en degrés) et l'heure de départ en tranches (en secondes),
+//! de sorte que des requêtes quasi identiques partagent la même entrée
+//! \note chaque fragment possède son propre verrou et sa propre liste LRU; la capacité est répartie entre les fragments
+class CacheItineraires
+{
+public:
+
+    struct Cle
+    {
+        int32_t latOrigine;
+        int32_t lonOrigine;
+        int32_t latDestination;
+        int32_t lonDestination;
+        int32_t tranche;
+        bool operator==(const Cle &p_autre) const;
+    };
+
+    CacheItineraires(size_t p_capacite = 4096, double p_tailleCellule = 0.002, unsigned int p_largeurTranche = 60,
+                     size_t p_nbFragments = 16);
+
+    Cle cle(const Coordonnees &p_origine, const Coordonnees &p_destination, const Heure &p_depart) const;
+    bool chercher(const Cle &p_cle, Itineraire &p_itineraire) const;
+    void inserer(const Cle &p_cle, const Itineraire &p_itineraire);
+    void vider();
+
+    size_t getTaille() const;
+    size_t getCapacite() const;
+    unsigned long getNbSucces() const;
+    unsigned long getNbEchecs() const;
+    double getTauxSucces() const;
+
+private:
+
+    struct HachageCle
+    {
+        size_t operator()(const Cle &p_cle) const;
+    };
+
+    typedef std::list<std::pair<Cle, Itineraire> > ListeLRU;
+
+    struct Fragment
+    {
+        mutable std::mutex verrou;
+        ListeLRU lru; //l'entrée la plus récemment utilisée est en tête
+        std::unordered_map<Cle, ListeLRU::iterator, HachageCle> index;
+    };
+
+    Fragment &fragmentDe(const Cle &p_cle) const;
+
+    size_t m_capaciteParFragment;
+    double m_tailleCellule; //côté d'une cellule de la grille, en degrés
+    unsigned int m_largeurTranche; //largeur d'une tranche d'heure de départ, en secondes
+    std::vector<std::unique_ptr<Fragment> > m_fragments;
+    mutable std::atomic<unsigned long> m_nbSucces;
+    mutable std::atomic<unsigned long> m_nbEchecs;
+};
+
+#endif //TP2_CACHEITINERAIRES_H
@@ -0,0 +1,372 @@
+//
+//  chargementGTFS.cpp
+//  Chargement complet d'un dossier GTFS (ou d'une archive .zip) dans un objet DonneesGTFS
+//
+
+#include "chargementGTFS.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace
+{
+    const size_t tailleBloc = 1 << 18;
+
+    //appelle (p_gtfs.*p_methode)() sur un tube alimenté par p_producteur
+    void ajouterParTube(DonneesGTFS &p_gtfs, void (DonneesGTFS::*p_methode)(const string &),
+                        const TubeNomme::Producteur &p_producteur)
+    {
+        TubeNomme tube(p_producteur);
+        (p_gtfs.*p_methode)(tube.getChemin());
+        tube.terminer();
+    }
+}
+
+//! \brief appelle, dans l'ordre requis, toutes les méthodes DonneesGTFS::ajouter* sur les fichiers d'une source GTFS
+//! \param[in, out] p_gtfs: l'objet DonneesGTFS à remplir (fraîchement construit)
+//! \param[in] p_source: le dossier contenant routes.txt, stops.txt, calendar_dates.txt, trips.txt, stop_times.txt et
+//! transfers.txt, ou une archive .zip de ces fichiers (lus en flux, sans extraction sur disque)
+//! \param[out] p_stats: si non nul, reçoit la durée de chaque méthode ajouter* (nulles si GTFS_STATS n'est pas défini)
+//! \param[in] p_prefiltrer: si vrai, seules les lignes de stop_times.txt retenues par PrefiltreArrets sont
+//! transmises à ajouterArretsDesVoyagesDeLaDate() (le résultat est le même)
+//! \param[in] p_suivi: si non vide, appelée après chaque méthode ajouter* (par exemple pour afficher les
+//! compteurs de DonneesGTFS au fil du chargement); sa durée n'est pas comptée dans p_stats
+//! \throws logic_error si un des fichiers ne peut être chargé (voir DonneesGTFS et ArchiveZip)
+void chargerDonneesGTFS(DonneesGTFS &p_gtfs, const string &p_source, StatistiquesChargement *p_stats,
+                        bool p_prefiltrer, const SuiviChargement &p_suivi)
+{
+    if (p_stats) *p_stats = StatistiquesChargement();
+    GTFS_STAT(StatistiquesChargement stats);
+    GTFS_STAT(Chronometre chronometre);
+    //le temps passé dans p_suivi n'est compté dans aucune méthode
+    auto suivre = [&](EtapeChargement p_etape)
+    {
+        if (!p_suivi) return;
+        p_suivi(p_etape);
+        GTFS_STAT(chronometre = Chronometre());
+    };
+
+    ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterLignes, p_source, "routes.txt");
+    GTFS_STAT(stats.lignes = chronometre.arreter("DonneesGTFS::ajouterLignes"));
+    suivre(EtapeChargement::lignes);
+    ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterStations, p_source, "stops.txt");
+    GTFS_STAT(stats.stations = chronometre.arreter("DonneesGTFS::ajouterStations"));
+    suivre(EtapeChargement::stations);
+    ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterServices, p_source, "calendar_dates.txt");
+    GTFS_STAT(stats.services = chronometre.arreter("DonneesGTFS::ajouterServices"));
+    suivre(EtapeChargement::services);
+    ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterVoyagesDeLaDate, p_source, "trips.txt");
+    GTFS_STAT(stats.voyages = chronometre.arreter("DonneesGTFS::ajouterVoyagesDeLaDate"));
+    suivre(EtapeChargement::voyages);
+    if (p_prefiltrer)
+    {
+        //le préfiltre copie ici les voyages actifs, avant que DonneesGTFS ne les modifie pendant la lecture du tube
+        PrefiltreArrets prefiltre(p_gtfs);
+        ajouterParTube(p_gtfs, &DonneesGTFS::ajouterArretsDesVoyagesDeLaDate, [&](const ArchiveZip::Recepteur &p_sortie)
+        {
+            lireFichierGTFS(p_source, "stop_times.txt", [&](const char *p_donnees, size_t p_taille)
+            {
+                prefiltre.traiter(p_donnees, p_taille, p_sortie);
+            });
+            prefiltre.terminer(p_sortie);
+        });
+    }
+    else
+        ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterArretsDesVoyagesDeLaDate, p_source, "stop_times.txt");
+    GTFS_STAT(stats.arrets = chronometre.arreter("DonneesGTFS::ajouterArretsDesVoyagesDeLaDate"));
+    suivre(EtapeChargement::arrets);
+    ajouterFichierGTFS(p_gtfs, &DonneesGTFS::ajouterTransferts, p_source, "transfers.txt");
+    GTFS_STAT(stats.transferts = chronometre.arreter("DonneesGTFS::ajouterTransferts"));
+    suivre(EtapeChargement::transferts);
+
+    GTFS_STAT(if (p_stats) *p_stats = stats);
+}
+
+//! \brief livre le contenu du fichier p_nom d'une source GTFS à p_recepteur, par blocs
+//! \param[in] p_source: un dossier GTFS ou une archive .zip (décompressée en flux)
+//! \throws logic_error si le fichier ne peut être lu
+void lireFichierGTFS(const string &p_source, const string &p_nom, const ArchiveZip::Recepteur &p_recepteur)
+{
+    if (ArchiveZip::estArchive(p_source))
+    {
+        ArchiveZip(p_source).extraire(p_nom, p_recepteur);
+        return;
+    }
+    ifstream fichier((p_source + "/" + p_nom).c_str(), ios::binary);
+    if (!fichier) throw logic_error("lireFichierGTFS(): impossible d'ouvrir " + p_source + "/" + p_nom);
+    vector<char> tampon(tailleBloc);
+    while (fichier)
+    {
+        fichier.read(tampon.data(), static_cast<streamsize>(tampon.size()));
+        if (fichier.gcount() > 0) p_recepteur(tampon.data(), static_cast<size_t>(fichier.gcount()));
+    }
+    if (fichier.bad()) throw logic_error("lireFichierGTFS(): erreur de lecture de " + p_source + "/" + p_nom);
+}
+
+//! \brief appelle (p_gtfs.*p_methode)() sur le fichier p_nom d'une source GTFS
+//! \note pour une archive .zip, le fichier est décompressé dans un tube nommé pendant que DonneesGTFS le lit
+void ajouterFichierGTFS(DonneesGTFS &p_gtfs, void (DonneesGTFS::*p_methode)(const string &), const string &p_source,
+                        const string &p_nom)
+{
+    if (!ArchiveZip::estArchive(p_source))
+    {
+        (p_gtfs.*p_methode)(p_source + "/" + p_nom);
+        return;
+    }
+    ArchiveZip archive(p_source);
+    ajouterParTube(p_gtfs, p_methode, [&](const ArchiveZip::Recepteur &p_sortie)
+    {
+        archive.extraire(p_nom, p_sortie);
+    });
+}
+
+//! \brief lit une heure GTFS "HH:MM:SS" (HH peut dépasser 24; guillemets et espaces ignorés)
+//! \param[out] p_secondes: l'heure en secondes depuis minuit
+//! \return faux si [p_debut, p_fin) n'est pas une heure valide
+bool lireHeureGTFS(const char *p_debut, const char *p_fin, unsigned int &p_secondes)
+{
+    unsigned int valeurs[3] = {0, 0, 0};
+    size_t k = 0;
+    bool chiffre = false;
+    for (const char *c = p_debut; c != p_fin; ++c)
+    {
+        if (*c >= '0' && *c <= '9')
+        {
+            valeurs[k] = valeurs[k] * 10 + static_cast<unsigned int>(*c - '0');
+            chiffre = true;
+        }
+        else if (*c == ':' && chiffre && k < 2)
+        {
+            ++k;
+            chiffre = false;
+        }
+        else if (*c != '"' && *c != ' ' && *c != '\r')
+            return false;
+    }
+    if (k != 2 || !chiffre) return false;
+    p_secondes = valeurs[0] * 3600 + valeurs[1] * 60 + valeurs[2];
+    return true;
+}
+
+//! \pre p_gtfs.ajouterVoyagesDeLaDate() a été appelée (ses voyages sont les voyages actifs)
+PrefiltreArrets::PrefiltreArrets(const DonneesGTFS &p_gtfs)
+    : m_actifs(p_gtfs.getNbVoyages() * 2),
+      m_debut(static_cast<unsigned int>(p_gtfs.getTempsDebut() - Heure(0, 0, 0))),
+      m_fin(static_cast<unsigned int>(p_gtfs.getTempsFin() - Heure(0, 0, 0))),
+      m_voyageActif(false), m_entete(true)
+{
+    for (auto &v : p_gtfs.getVoyages()) m_actifs.insert(v.first);
+}
+
+//! \brief filtre un bloc de stop_times.txt (coupé n'importe où) et livre les lignes retenues à p_sortie
+void PrefiltreArrets::traiter(const char *p_donnees, size_t p_taille, const ArchiveZip::Recepteur &p_sortie)
+{
+    const char *p = p_donnees;
+    const char *finDonnees = p_donnees + p_taille;
+    if (!m_reste.empty())
+    {
+        const char *finLigne = static_cast<const char *>(memchr(p, '\n', p_taille));
+        if (!finLigne)
+        {
+            m_reste.append(p, p_taille);
+            return;
+        }
+        m_reste.append(p, finLigne + 1 - p);
+        if (retenir(m_reste.data(), m_reste.data() + m_reste.size() - 1)) p_sortie(m_reste.data(), m_reste.size());
+        m_reste.clear();
+        p = finLigne + 1;
+    }
+
+    const char *debutBloc = p; //le bloc de lignes retenues consécutives, pas encore livré
+    const char *finBloc = p;
+    while (p < finDonnees)
+    {
+        const char *finLigne = static_cast<const char *>(memchr(p, '\n', finDonnees - p));
+        if (!finLigne)
+        {
+            m_reste.assign(p, finDonnees - p);
+            break;
+        }
+        if (retenir(p, finLigne))
+        {
+            if (p != finBloc)
+            {
+                if (finBloc != debutBloc) p_sortie(debutBloc, finBloc - debutBloc);
+                debutBloc = p;
+            }
+            finBloc = finLigne + 1;
+        }
+        p = finLigne + 1;
+    }
+    if (finBloc != debutBloc) p_sortie(debutBloc, finBloc - debutBloc);
+}
+
+//! \brief traite la dernière ligne, si le fichier ne se termine pas par un saut de ligne
+void PrefiltreArrets::terminer(const ArchiveZip::Recepteur &p_sortie)
+{
+    if (m_reste.empty()) return;
+    if (retenir(m_reste.data(), m_reste.data() + m_reste.size()))
+    {
+        m_reste += '\n';
+        p_sortie(m_reste.data(), m_reste.size());
+    }
+    m_reste.clear();
+}
+
+//! \param[in] p_ligne, p_finLigne: une ligne complète, sans son saut de ligne
+//! \return vrai si la ligne doit être transmise à DonneesGTFS
+bool PrefiltreArrets::retenir(const char *p_ligne, const char *p_finLigne)
+{
+    if (m_entete)
+    {
+        m_entete = false;
+        return true;
+    }
+    const char *virgule = static_cast<const char *>(memchr(p_ligne, ',', p_finLigne - p_ligne));
+    if (!virgule) return true;
+    size_t longueur = virgule - p_ligne;
+    if (longueur != m_champVoyage.size() || memcmp(p_ligne, m_champVoyage.data(), longueur) != 0)
+    {
+        m_champVoyage.assign(p_ligne, longueur);
+        const char *d = p_ligne, *f = virgule;
+        if (f - d >= 2 && *d == '"' && f[-1] == '"')
+        {
+            ++d;
+            --f;
+        }
+        m_voyageActif = m_actifs.count(string(d, f)) != 0;
+    }
+    if (!m_voyageActif) return false;
+
+    const char *virgule2 = static_cast<const char *>(memchr(virgule + 1, ',', p_finLigne - virgule - 1));
+    const char *virgule3 = virgule2 ? static_cast<const char *>(memchr(virgule2 + 1, ',', p_finLigne - virgule2 - 1))
+                                    : nullptr;
+    unsigned int arrivee, depart;
+    if (virgule3 && lireHeureGTFS(virgule + 1, virgule2, arrivee) && lireHeureGTFS(virgule2 + 1, virgule3, depart))
+        return arrivee <= m_fin && depart >= m_debut;
+    return true;
+}
+
+//! \brief crée le tube et démarre le producteur, qui attend qu'un lecteur ouvre le tube
+//! \throws logic_error si le tube ne peut être créé
+TubeNomme::TubeNomme(const Producteur &p_producteur)
+    : m_ouvert(false), m_fini(false), m_termine(false)
+{
+    const char *dossier = getenv("TMPDIR");
+    string modele = string(dossier && *dossier ? dossier : "/tmp") + "/gtfsXXXXXX";
+    vector<char> chemin(modele.begin(), modele.end());
+    chemin.push_back('\0');
+    if (!mkdtemp(chemin.data())) throw logic_error("TubeNomme: impossible de créer " + modele);
+    m_dossier = chemin.data();
+    m_chemin = m_dossier + "/tube";
+    if (mkfifo(m_chemin.c_str(), 0600) != 0)
+    {
+        rmdir(m_dossier.c_str());
+        throw logic_error("TubeNomme: impossible de créer " + m_chemin);
+    }
+    m_fil = thread(&TubeNomme::produire, this, p_producteur);
+}
+
+TubeNomme::~TubeNomme()
+{
+    try
+    {
+        terminer();
+    }
+    catch (...)
+    {
+        //déjà en train de propager l'erreur du lecteur, ou l'appelant n'a pas voulu l'erreur du producteur
+    }
+    unlink(m_chemin.c_str());
+    rmdir(m_dossier.c_str());
+}
+
+const std::string &TubeNomme::getChemin() const
+{
+    return m_chemin;
+}
+
+//! \brief attend la fin du producteur (à appeler après que le lecteur a tout lu)
+//! \note si le lecteur n'a jamais ouvert le tube (il a échoué avant), on le vide nous-mêmes pour débloquer le producteur
+//! \throws l'exception du producteur, le cas échéant
+void TubeNomme::terminer()
+{
+    if (m_termine) return;
+    m_termine = true;
+    if (!m_ouvert)
+    {
+        int descripteur = open(m_chemin.c_str(), O_RDONLY | O_NONBLOCK);
+        if (descripteur >= 0)
+        {
+            char tampon[1 << 16];
+            while (!m_fini)
+            {
+                if (read(descripteur, tampon, sizeof(tampon)) <= 0) this_thread::sleep_for(chrono::milliseconds(1));
+            }
+            close(descripteur);
+        }
+    }
+    m_fil.join();
+    if (m_erreur) rethrow_exception(m_erreur);
+}
+
+//le corps du fil producteur: ouvre le tube en écriture (bloque jusqu'à l'arrivée d'un lecteur) et y écrit par blocs
+void TubeNomme::produire(Producteur p_producteur)
+{
+    //un lecteur qui abandonne donne EPIPE dans ce fil plutôt que de terminer le processus par SIGPIPE
+    sigset_t masque;
+    sigemptyset(&masque);
+    sigaddset(&masque, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &masque, nullptr);
+
+    int descripteur = -1;
+    try
+    {
+        descripteur = open(m_chemin.c_str(), O_WRONLY);
+        if (descripteur < 0) throw logic_error("TubeNomme: impossible d'ouvrir " + m_chemin);
+        m_ouvert = true;
+        vector<char> tampon;
+        tampon.reserve(tailleBloc);
+        auto ecrire = [&](const char *p_donnees, size_t p_taille)
+        {
+            while (p_taille > 0)
+            {
+                ssize_t n = write(descripteur, p_donnees, p_taille);
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) throw logic_error("TubeNomme: le lecteur a fermé " + m_chemin);
+                p_donnees += n;
+                p_taille -= static_cast<size_t>(n);
+            }
+        };
+        p_producteur([&](const char *p_donnees, size_t p_taille)
+        {
+            if (tampon.size() + p_taille > tailleBloc)
+            {
+                ecrire(tampon.data(), tampon.size());
+                tampon.clear();
+            }
+            if (p_taille >= tailleBloc) ecrire(p_donnees, p_taille);
+            else tampon.insert(tampon.end(), p_donnees, p_donnees + p_taille);
+        });
+        ecrire(tampon.data(), tampon.size());
+    }
+    catch (...)
+    {
+        m_erreur = current_exception();
+    }
+    if (descripteur >= 0) close(descripteur);
+    m_fini = true;
+}
@@ -0,0 +1,87 @@
+//
+//  chargementGTFS.h
+//  Chargement complet d'un dossier GTFS (ou d'une archive .zip) dans un objet DonneesGTFS
+//
+
+#ifndef TP2_CHARGEMENTGTFS_H
+#define TP2_CHARGEMENTGTFS_H
+
+#include <string>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <functional>
+
+#include "DonneesGTFS.h"
+#include "archiveZip.h"
+#include "statistiques.h"
+
+//! \brief Les étapes de chargerDonneesGTFS(), une par méthode DonneesGTFS::ajouter*, dans l'ordre
+enum class EtapeChargement { lignes, stations, services, voyages, arrets, transferts };
+
+//! \brief appelée après chaque étape de chargerDonneesGTFS()
+typedef std::function<void(EtapeChargement)> SuiviChargement;
+
+void chargerDonneesGTFS(DonneesGTFS &p_gtfs, const std::string &p_source, StatistiquesChargement *p_stats = nullptr,
+                        bool p_prefiltrer = true, const SuiviChargement &p_suivi = SuiviChargement());
+void lireFichierGTFS(const std::string &p_source, const std::string &p_nom, const ArchiveZip::Recepteur &p_recepteur);
+void ajouterFichierGTFS(DonneesGTFS &p_gtfs, void (DonneesGTFS::*p_methode)(const std::string &),
+                        const std::string &p_source, const std::string &p_nom);
+bool lireHeureGTFS(const char *p_debut, const char *p_fin, unsigned int &p_secondes);
+
+//! \brief Tube nommé (FIFO, dans $TMPDIR ou /tmp) alimenté par un fil d'exécution producteur
+//! \note les méthodes DonneesGTFS::ajouter* ne lisent que des fichiers: on leur passe le chemin du tube.
+//! Le producteur (décompression, préfiltre...) s'exécute pendant que DonneesGTFS lit et analyse:
+//! le contenu n'est jamais écrit sur disque
+class TubeNomme
+{
+public:
+    typedef std::function<void(const ArchiveZip::Recepteur &)> Producteur;
+
+    explicit TubeNomme(const Producteur &p_producteur);
+    ~TubeNomme();
+    const std::string &getChemin() const;
+    void terminer();
+
+private:
+    TubeNomme(const TubeNomme &);
+    TubeNomme &operator=(const TubeNomme &);
+
+    void produire(Producteur p_producteur);
+
+    std::string m_dossier; //le dossier temporaire qui contient le tube
+    std::string m_chemin;
+    std::thread m_fil;
+    std::exception_ptr m_erreur; //l'exception du producteur, relancée par terminer()
+    std::atomic<bool> m_ouvert; //le producteur a ouvert le tube (un lecteur l'a donc ouvert aussi)
+    std::atomic<bool> m_fini; //le producteur a terminé
+    bool m_termine;
+};
+
+//! \brief Préfiltre des lignes de stop_times.txt, reçues par blocs quelconques, avant DonneesGTFS
+//! \note on ne lit que le trip_id d'une ligne, comparé à l'ensemble des voyages actifs; une ligne consécutive du
+//! même voyage réutilise la décision sans recherche, de sorte qu'un fichier trié par trip_id saute chaque voyage
+//! inactif d'un bloc. Les heures ne sont lues que pour les voyages actifs: une ligne dont l'horaire ne touche pas
+//! [getTempsDebut(), getTempsFin()] est écartée. Ce filtre est plus large que celui de DonneesGTFS (qui garde le
+//! dernier mot); une ligne illisible est transmise telle quelle pour que DonneesGTFS la signale.
+class PrefiltreArrets
+{
+public:
+    explicit PrefiltreArrets(const DonneesGTFS &p_gtfs);
+    void traiter(const char *p_donnees, size_t p_taille, const ArchiveZip::Recepteur &p_sortie);
+    void terminer(const ArchiveZip::Recepteur &p_sortie);
+
+private:
+    bool retenir(const char *p_ligne, const char *p_finLigne);
+
+    std::unordered_set<std::string> m_actifs; //les trip_id des voyages de la date
+    unsigned int m_debut; //getTempsDebut(), en secondes depuis minuit
+    unsigned int m_fin;
+    std::string m_champVoyage; //le premier champ de la ligne précédente, tel quel (guillemets compris)
+    bool m_voyageActif;
+    bool m_entete; //la prochaine ligne est l'entête
+    std::string m_reste; //le début d'une ligne coupée entre deux blocs
+};
+
+#endif //TP2_CHARGEMENTGTFS_H
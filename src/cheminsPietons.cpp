@@ -0,0 +1,274 @@
+//
+//  cheminsPietons.cpp
+//  Chemins à pieds précalculés entre stations voisines, en plus des transferts de transfers.txt
+//
+
+#include "cheminsPietons.h"
+#include "tableCoordonnees.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    const char magique[8] = {'G', 'T', 'F', 'S', 'C', 'P', '0', '1'};
+    const double kmParDegre = 6371.0 * M_PI / 180.0; //le long d'un méridien, avec le rayon de Coordonnees::operator-
+    const double margeGrille = 1.05; //les cellules sont un peu plus grandes que le rayon (approximation plane)
+
+    //FNV-1a
+    void melanger(uint64_t &p_h, const void *p_donnees, size_t p_taille)
+    {
+        const unsigned char *octets = static_cast<const unsigned char *>(p_donnees);
+        for (size_t i = 0; i < p_taille; ++i)
+        {
+            p_h ^= octets[i];
+            p_h *= 1099511628211ULL;
+        }
+    }
+
+    template<typename T>
+    void ecrire(ostream &p_flux, const T &p_valeur)
+    {
+        p_flux.write(reinterpret_cast<const char *>(&p_valeur), sizeof(T));
+    }
+
+    template<typename T>
+    void lire(istream &p_flux, T &p_valeur)
+    {
+        p_flux.read(reinterpret_cast<char *>(&p_valeur), sizeof(T));
+    }
+
+    uint64_t paire(unsigned int p_de, unsigned int p_vers)
+    {
+        return (static_cast<uint64_t>(p_de) << 32) | p_vers;
+    }
+}
+
+//! \param[in] p_gtfs: les données dont on relie les stations; elles doivent survivre à cet objet
+//! \param[in] p_rayon: la distance de marche maximale d'un chemin, en km
+//! \param[in] p_vitesse: la vitesse de marche, en km/h (celle de ReseauGTFS par défaut)
+//! \throws logic_error si le rayon ou la vitesse n'est pas positif
+CheminsPietons::CheminsPietons(const DonneesGTFS &p_gtfs, double p_rayon, double p_vitesse)
+    : m_gtfs(p_gtfs), m_rayon(p_rayon), m_vitesse(p_vitesse), m_calcule(false)
+{
+    if (!(p_rayon > 0) || !(p_vitesse > 0))
+        throw logic_error("CheminsPietons: le rayon et la vitesse doivent être positifs");
+}
+
+//! \brief calcule les chemins à pieds de toutes les paires de stations distantes d'au plus getRayon()
+//! \param[in] p_nbFils: le nombre de fils d'exécution (0: autant que de coeurs)
+//! \note la durée d'un chemin est distance / vitesse, tronquée à la seconde comme la marche de ReseauGTFS
+void CheminsPietons::calculer(unsigned int p_nbFils)
+{
+    const auto &stations = m_gtfs.getStations();
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+
+    //la grille: des cellules de p_rayon km de côté; en longitude, à la latitude la plus éloignée de l'équateur
+    double cosMin = 1.0;
+    for (auto &s : stations) cosMin = min(cosMin, cos(s.second.getCoords().getLatitude() * M_PI / 180.0));
+    const double hauteur = m_rayon * margeGrille / kmParDegre; //en degrés de latitude
+    const double largeur = hauteur / max(cosMin, 1e-3); //en degrés de longitude
+
+    struct Point
+    {
+        int64_t rangee;
+        int64_t colonne;
+        unsigned int station;
+        const Coordonnees *coords;
+    };
+    vector<Point> points;
+    points.reserve(stations.size());
+    for (auto &s : stations)
+    {
+        const Coordonnees &c = s.second.getCoords();
+        points.push_back({static_cast<int64_t>(floor(c.getLatitude() / hauteur)),
+                          static_cast<int64_t>(floor(c.getLongitude() / largeur)), s.first, &c});
+    }
+    //rangées puis colonnes: les 3 cellules voisines d'une même rangée sont consécutives
+    sort(points.begin(), points.end(), [](const Point &a, const Point &b)
+    {
+        return tie(a.rangee, a.colonne, a.station) < tie(b.rangee, b.colonne, b.station);
+    });
+    TableCoordonnees table;
+    for (auto &p : points) table.ajouter(*p.coords);
+
+    unordered_set<uint64_t> transferts;
+    for (auto &t : m_gtfs.getTransferts()) transferts.insert(paire(get<0>(t), get<1>(t)));
+
+    const size_t n = points.size();
+    vector<vector<Chemin> > parSource(n);
+    atomic<size_t> prochaine(0);
+    auto travailler = [&]()
+    {
+        vector<double> distances;
+        for (size_t i = prochaine++; i < n; i = prochaine++)
+        {
+            for (int64_t dr = -1; dr <= 1; ++dr)
+            {
+                Point bas = {points[i].rangee + dr, points[i].colonne - 1, 0, nullptr};
+                Point haut = {points[i].rangee + dr, points[i].colonne + 1, 0, nullptr};
+                auto avant = [](const Point &a, const Point &b)
+                {
+                    return tie(a.rangee, a.colonne) < tie(b.rangee, b.colonne);
+                };
+                size_t debut = lower_bound(points.begin(), points.end(), bas, avant) - points.begin();
+                size_t fin = upper_bound(points.begin(), points.end(), haut, avant) - points.begin();
+                if (debut == fin) continue;
+                table.distancesDepuis(i, debut, fin, distances);
+                for (size_t k = 0; k < distances.size(); ++k)
+                {
+                    const size_t j = debut + k;
+                    if (j == i || distances[k] > m_rayon) continue;
+                    if (transferts.count(paire(points[i].station, points[j].station))) continue;
+                    parSource[i].push_back(Chemin(points[i].station, points[j].station,
+                                                  static_cast<unsigned int>(distances[k] / m_vitesse * 3600)));
+                }
+            }
+        }
+    };
+    vector<thread> fils;
+    for (unsigned int f = 1; f < p_nbFils; ++f) fils.push_back(thread(travailler));
+    travailler();
+    for (auto &f : fils) f.join();
+
+    vector<Chemin> chemins;
+    for (auto &c : parSource) chemins.insert(chemins.end(), c.begin(), c.end());
+    sort(chemins.begin(), chemins.end());
+    m_chemins.swap(chemins);
+    m_calcule = true;
+}
+
+//! \brief empreinte des données dont dépendent les chemins (stations, transferts, rayon, vitesse)
+uint64_t CheminsPietons::empreinte() const
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (auto &s : m_gtfs.getStations())
+    {
+        double latitude = s.second.getCoords().getLatitude(), longitude = s.second.getCoords().getLongitude();
+        melanger(h, &s.first, sizeof(s.first));
+        melanger(h, &latitude, sizeof(latitude));
+        melanger(h, &longitude, sizeof(longitude));
+    }
+    for (auto &t : m_gtfs.getTransferts())
+    {
+        unsigned int champs[3] = {get<0>(t), get<1>(t), get<2>(t)};
+        melanger(h, champs, sizeof(champs));
+    }
+    melanger(h, &m_rayon, sizeof(m_rayon));
+    melanger(h, &m_vitesse, sizeof(m_vitesse));
+    return h;
+}
+
+//! \return le nom du fichier de cache de ces données, rayon et vitesse ("pietons-<empreinte>.bin")
+std::string CheminsPietons::getNomCache() const
+{
+    ostringstream nom;
+    nom << "pietons-" << hex << setw(16) << setfill('0') << empreinte() << ".bin";
+    return nom.str();
+}
+
+//! \brief Écrit les chemins calculés dans un fichier binaire
+//! \throws logic_error si rien n'est calculé ou si le fichier ne peut être écrit
+void CheminsPietons::sauvegarder(const string &p_fichier) const
+{
+    if (!m_calcule) throw logic_error("CheminsPietons::sauvegarder(): aucun chemin calculé");
+    ofstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("CheminsPietons::sauvegarder(): impossible d'écrire " + p_fichier);
+    flux.write(magique, sizeof(magique));
+    ecrire(flux, empreinte());
+    ecrire(flux, static_cast<uint32_t>(m_chemins.size()));
+    for (auto &c : m_chemins)
+    {
+        uint32_t champs[3] = {get<0>(c), get<1>(c), get<2>(c)};
+        flux.write(reinterpret_cast<const char *>(champs), sizeof(champs));
+    }
+    if (!flux) throw logic_error("CheminsPietons::sauvegarder(): erreur d'écriture dans " + p_fichier);
+}
+
+//! \brief Lit des chemins écrits par CheminsPietons::sauvegarder()
+//! \throws logic_error si le fichier est illisible ou s'il a été calculé pour d'autres données
+void CheminsPietons::charger(const string &p_fichier)
+{
+    ifstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("CheminsPietons::charger(): impossible de lire " + p_fichier);
+    char entete[sizeof(magique)];
+    uint64_t empreinteFichier = 0;
+    uint32_t nbChemins = 0;
+    flux.read(entete, sizeof(entete));
+    lire(flux, empreinteFichier);
+    lire(flux, nbChemins);
+    if (!flux || memcmp(entete, magique, sizeof(magique)) != 0)
+        throw logic_error("CheminsPietons::charger(): format invalide dans " + p_fichier);
+    if (empreinteFichier != empreinte())
+        throw logic_error("CheminsPietons::charger(): " + p_fichier + " a été calculé pour d'autres données");
+
+    vector<Chemin> chemins;
+    chemins.reserve(nbChemins);
+    for (uint32_t i = 0; i < nbChemins; ++i)
+    {
+        uint32_t champs[3];
+        flux.read(reinterpret_cast<char *>(champs), sizeof(champs));
+        if (!flux) throw logic_error("CheminsPietons::charger(): fichier tronqué " + p_fichier);
+        chemins.push_back(Chemin(champs[0], champs[1], champs[2]));
+    }
+    m_chemins.swap(chemins);
+    m_calcule = true;
+}
+
+//! \brief relit les chemins du cache p_dossierCache/getNomCache() s'il existe, sinon les calcule et l'écrit
+//! \return vrai si les chemins proviennent du cache
+//! \throws logic_error si le cache doit être écrit et ne peut l'être
+bool CheminsPietons::chargerOuCalculer(const string &p_dossierCache, unsigned int p_nbFils)
+{
+    const string fichier = p_dossierCache + "/" + getNomCache();
+    if (ifstream(fichier.c_str()).good())
+    {
+        try
+        {
+            charger(fichier);
+            return true;
+        }
+        catch (logic_error &)
+        {
+            //cache illisible (écriture interrompue, par exemple): on le recalcule
+        }
+    }
+    calculer(p_nbFils);
+    sauvegarder(fichier);
+    return false;
+}
+
+const std::vector<CheminsPietons::Chemin> &CheminsPietons::getChemins() const
+{
+    return m_chemins;
+}
+
+size_t CheminsPietons::getNbChemins() const
+{
+    return m_chemins.size();
+}
+
+bool CheminsPietons::estCalcule() const
+{
+    return m_calcule;
+}
+
+double CheminsPietons::getRayon() const
+{
+    return m_rayon;
+}
+
+double CheminsPietons::getVitesse() const
+{
+    return m_vitesse;
+}
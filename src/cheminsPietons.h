@@ -0,0 +1,52 @@
+//
+//  cheminsPietons.h
+//  Chemins à pieds précalculés entre stations voisines, en plus des transferts de transfers.txt
+//
+
+#ifndef TP2_CHEMINSPIETONS_H
+#define TP2_CHEMINSPIETONS_H
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <cstdint>
+
+#include "DonneesGTFS.h"
+
+//! \brief Chemins à pieds entre toutes les paires de stations distantes d'au plus un rayon donné
+//! \note transfers.txt ne relie que quelques paires de stations. CheminsPietons::calculer() range les stations
+//! dans une grille de cellules de la taille du rayon (index spatial): une station n'est comparée qu'aux stations
+//! des 9 cellules voisines, dont les distances sont calculées par lots (TableCoordonnees). Chaque fil traite
+//! une station source à la fois; le résultat ne dépend pas du nombre de fils.
+//! \note les paires déjà présentes dans getTransferts() sont écartées: le fichier GTFS a le dernier mot.
+//! getChemins() a la forme de getTransferts() (station de départ, station d'arrivée, durée en secondes)
+//! \note le résultat peut être sauvegardé puis relu; le fichier porte l'empreinte des stations, des transferts,
+//! du rayon et de la vitesse, de sorte qu'un fichier calculé pour d'autres données est refusé
+class CheminsPietons
+{
+public:
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> Chemin;
+
+    explicit CheminsPietons(const DonneesGTFS &p_gtfs, double p_rayon = 0.5, double p_vitesse = 5.0);
+    void calculer(unsigned int p_nbFils = 0);
+    void sauvegarder(const std::string &p_fichier) const;
+    void charger(const std::string &p_fichier);
+    bool chargerOuCalculer(const std::string &p_dossierCache, unsigned int p_nbFils = 0);
+    std::string getNomCache() const;
+    const std::vector<Chemin> &getChemins() const;
+    size_t getNbChemins() const;
+    bool estCalcule() const;
+    double getRayon() const;
+    double getVitesse() const;
+
+private:
+    uint64_t empreinte() const;
+
+    const DonneesGTFS &m_gtfs;
+    double m_rayon; //en km
+    double m_vitesse; //en km/h
+    bool m_calcule;
+    std::vector<Chemin> m_chemins; //triés par station de départ puis par station d'arrivée
+};
+
+#endif //TP2_CHEMINSPIETONS_H
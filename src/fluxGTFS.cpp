@@ -0,0 +1,254 @@
+//
+//  fluxGTFS.cpp
+//  Flux GTFS statique partagé entre plusieurs dates: stop_times.txt n'est lu qu'une seule fois
+//
+
+#include "fluxGTFS.h"
+#include "chargementGTFS.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace
+{
+    //découpe les premiers champs d'une ligne CSV (guillemets permis); retourne le nombre de champs lus
+    size_t champsCSV(const char *p_ligne, const char *p_finLigne, size_t p_nbChamps, string *p_champs)
+    {
+        size_t n = 0;
+        const char *c = p_ligne;
+        while (n < p_nbChamps && c <= p_finLigne)
+        {
+            string &champ = p_champs[n];
+            champ.clear();
+            bool entreGuillemets = false;
+            for (; c < p_finLigne; ++c)
+            {
+                if (*c == '"') entreGuillemets = !entreGuillemets;
+                else if (*c == ',' && !entreGuillemets) break;
+                else if (*c != '\r') champ += *c;
+            }
+            ++n;
+            ++c; //la virgule
+        }
+        return n;
+    }
+
+    //"HH:MM:SS" (HH peut dépasser 24) en secondes depuis minuit
+    uint32_t secondesDe(const string &p_heure)
+    {
+        unsigned int secondes;
+        if (!lireHeureGTFS(p_heure.data(), p_heure.data() + p_heure.size(), secondes))
+            throw logic_error("FluxGTFS: heure invalide dans stop_times.txt: " + p_heure);
+        return secondes;
+    }
+
+    unsigned int secondes(const Heure &p_heure)
+    {
+        return static_cast<unsigned int>(p_heure - Heure(0, 0, 0));
+    }
+
+    //la taille de stop_times.txt (décompressé), 0 si elle est inconnue
+    uint64_t tailleHoraires(const string &p_dossier)
+    {
+        if (ArchiveZip::estArchive(p_dossier))
+        {
+            ArchiveZip archive(p_dossier);
+            return archive.contient("stop_times.txt") ? archive.getTaille("stop_times.txt") : 0;
+        }
+        struct stat infos;
+        return stat((p_dossier + "/stop_times.txt").c_str(), &infos) == 0 ? static_cast<uint64_t>(infos.st_size) : 0;
+    }
+}
+
+//! \brief lit stop_times.txt une fois pour toutes
+//! \param[in] p_dossier: un dossier GTFS ou une archive .zip (la disposition des colonnes attendue par DonneesGTFS)
+//! \throws logic_error si stop_times.txt ne peut être lu ou contient une heure invalide
+//! \note les blocs livrés par lireFichierGTFS() sont découpés en lignes sur place (une ligne coupée entre deux
+//! blocs est gardée jusqu'au suivant, comme dans PrefiltreArrets): le texte n'est copié qu'une fois, dans m_texte,
+//! réservé à la taille du fichier. Les lignes y restent dans l'ordre du fichier; seuls les indices sont regroupés
+//! par voyage
+FluxGTFS::FluxGTFS(const string &p_dossier)
+    : m_dossier(p_dossier)
+{
+    m_texte.reserve(tailleHoraires(p_dossier) + 1); //+1: le saut de ligne ajouté à une dernière ligne qui n'en a pas
+
+    //première passe: les lignes dans l'ordre du fichier, avec leur voyage et leurs heures
+    bool entete = true;
+    vector<uint32_t> voyageDeLigne;
+    string champs[3];
+    auto ajouterLigne = [&](const char *p_ligne, const char *p_finLigne)
+    {
+        if (entete)
+        {
+            m_entete.assign(p_ligne, p_finLigne);
+            entete = false;
+            return;
+        }
+        if (p_ligne == p_finLigne || (p_finLigne - p_ligne == 1 && *p_ligne == '\r')) return;
+        if (champsCSV(p_ligne, p_finLigne, 3, champs) < 3)
+            throw logic_error("FluxGTFS: ligne incomplète dans stop_times.txt: " + string(p_ligne, p_finLigne));
+        auto insertion = m_indiceDuVoyage.insert(make_pair(champs[0], static_cast<uint32_t>(m_idDuVoyage.size())));
+        if (insertion.second) m_idDuVoyage.push_back(champs[0]);
+        voyageDeLigne.push_back(insertion.first->second);
+        Horaire horaire;
+        horaire.arrivee = secondesDe(champs[1]);
+        horaire.depart = secondesDe(champs[2]);
+        m_horaires.push_back(horaire);
+        m_debutLigne.push_back(m_texte.size());
+        m_texte.append(p_ligne, p_finLigne);
+        m_texte += '\n';
+    };
+    string reste; //le début d'une ligne coupée à la fin du bloc précédent
+    lireFichierGTFS(p_dossier, "stop_times.txt", [&](const char *p_donnees, size_t p_taille)
+    {
+        const char *p = p_donnees;
+        const char *finDonnees = p_donnees + p_taille;
+        if (!reste.empty())
+        {
+            const char *finLigne = static_cast<const char *>(memchr(p, '\n', p_taille));
+            if (!finLigne)
+            {
+                reste.append(p, p_taille);
+                return;
+            }
+            reste.append(p, finLigne - p);
+            ajouterLigne(reste.data(), reste.data() + reste.size());
+            reste.clear();
+            p = finLigne + 1;
+        }
+        while (p < finDonnees)
+        {
+            const char *finLigne = static_cast<const char *>(memchr(p, '\n', finDonnees - p));
+            if (!finLigne)
+            {
+                reste.assign(p, finDonnees - p);
+                break;
+            }
+            ajouterLigne(p, finLigne);
+            p = finLigne + 1;
+        }
+    });
+    if (!reste.empty()) ajouterLigne(reste.data(), reste.data() + reste.size());
+    if (entete) throw logic_error("FluxGTFS: stop_times.txt est vide");
+    m_debutLigne.push_back(m_texte.size());
+
+    //seconde passe: regrouper les indices des lignes par voyage (tri par dénombrement, stable dans chaque voyage)
+    const size_t nbLignes = voyageDeLigne.size();
+    m_debutVoyage.assign(m_idDuVoyage.size() + 1, 0);
+    for (uint32_t v : voyageDeLigne) ++m_debutVoyage[v + 1];
+    for (size_t v = 0; v < m_idDuVoyage.size(); ++v) m_debutVoyage[v + 1] += m_debutVoyage[v];
+    vector<uint32_t> position(m_debutVoyage.begin(), m_debutVoyage.end() - 1);
+    m_ligneDuFichier.resize(nbLignes);
+    for (size_t h = 0; h < nbLignes; ++h) m_ligneDuFichier[position[voyageDeLigne[h]]++] = static_cast<uint32_t>(h);
+
+    vector<Horaire> horaires(nbLignes);
+    for (size_t j = 0; j < nbLignes; ++j) horaires[j] = m_horaires[m_ligneDuFichier[j]];
+    m_horaires.swap(horaires);
+}
+
+//! \brief construit les DonneesGTFS d'une date sans relire stop_times.txt
+//! \param[in] p_date, p_debut, p_fin: les paramètres du constructeur de DonneesGTFS
+//! \param[out] p_stats: si non nul, reçoit la durée de chaque méthode ajouter* (nulles si GTFS_STATS n'est pas défini)
+//! \return un objet DonneesGTFS identique à celui que produirait chargerDonneesGTFS() sur le même dossier
+//! \note les horaires retenus passent par un tube nommé: ils ne sont jamais écrits sur disque
+//! \throws logic_error si un des fichiers ne peut être chargé (voir DonneesGTFS et chargementGTFS.h)
+unique_ptr<DonneesGTFS> FluxGTFS::donneesDeLaDate(const Date &p_date, const Heure &p_debut, const Heure &p_fin,
+                                                  StatistiquesChargement *p_stats) const
+{
+    if (p_stats) *p_stats = StatistiquesChargement();
+    GTFS_STAT(StatistiquesChargement stats);
+    GTFS_STAT(Chronometre chronometre);
+
+    unique_ptr<DonneesGTFS> donnees(new DonneesGTFS(p_date, p_debut, p_fin));
+    ajouterFichierGTFS(*donnees, &DonneesGTFS::ajouterLignes, m_dossier, "routes.txt");
+    GTFS_STAT(stats.lignes = chronometre.arreter("DonneesGTFS::ajouterLignes"));
+    ajouterFichierGTFS(*donnees, &DonneesGTFS::ajouterStations, m_dossier, "stops.txt");
+    GTFS_STAT(stats.stations = chronometre.arreter("DonneesGTFS::ajouterStations"));
+    ajouterFichierGTFS(*donnees, &DonneesGTFS::ajouterServices, m_dossier, "calendar_dates.txt");
+    GTFS_STAT(stats.services = chronometre.arreter("DonneesGTFS::ajouterServices"));
+    ajouterFichierGTFS(*donnees, &DonneesGTFS::ajouterVoyagesDeLaDate, m_dossier, "trips.txt");
+    GTFS_STAT(stats.voyages = chronometre.arreter("DonneesGTFS::ajouterVoyagesDeLaDate"));
+
+    //le masque est calculé ici, avant que DonneesGTFS ne modifie ses voyages pendant la lecture du tube
+    const vector<uint64_t> actifs = voyagesActifs(*donnees);
+    const unsigned int debut = secondes(p_debut), fin = secondes(p_fin);
+    TubeNomme horaires([&](const ArchiveZip::Recepteur &p_sortie)
+    {
+        ecrireHoraires(actifs, debut, fin, p_sortie);
+    });
+    donnees->ajouterArretsDesVoyagesDeLaDate(horaires.getChemin());
+    horaires.terminer();
+    GTFS_STAT(stats.arrets = chronometre.arreter("DonneesGTFS::ajouterArretsDesVoyagesDeLaDate"));
+
+    ajouterFichierGTFS(*donnees, &DonneesGTFS::ajouterTransferts, m_dossier, "transfers.txt");
+    GTFS_STAT(stats.transferts = chronometre.arreter("DonneesGTFS::ajouterTransferts"));
+
+    GTFS_STAT(if (p_stats) *p_stats = stats);
+    return donnees;
+}
+
+//! \return le masque des voyages (bit v du mot v / 64) retenus par p_gtfs.ajouterVoyagesDeLaDate()
+//! \pre p_gtfs provient du même dossier GTFS
+std::vector<uint64_t> FluxGTFS::voyagesActifs(const DonneesGTFS &p_gtfs) const
+{
+    vector<uint64_t> actifs((m_idDuVoyage.size() + 63) / 64, 0);
+    for (auto &v : p_gtfs.getVoyages())
+    {
+        auto it = m_indiceDuVoyage.find(v.first);
+        if (it != m_indiceDuVoyage.end()) actifs[it->second / 64] |= uint64_t(1) << (it->second % 64);
+    }
+    return actifs;
+}
+
+//! \brief écrit l'entête puis les lignes des voyages actifs dont l'horaire touche [p_debut, p_fin]
+//! \note les lignes d'un voyage qui se suivent dans le fichier (le cas usuel) sont écrites d'un seul bloc
+//! \note le filtre sur l'heure est plus large que celui de DonneesGTFS, qui garde le dernier mot
+void FluxGTFS::ecrireHoraires(const vector<uint64_t> &p_actifs, unsigned int p_debut, unsigned int p_fin,
+                              const ArchiveZip::Recepteur &p_sortie) const
+{
+    const string entete = m_entete + '\n';
+    p_sortie(entete.data(), entete.size());
+    for (size_t v = 0; v < m_idDuVoyage.size(); ++v)
+    {
+        if (!(p_actifs[v / 64] >> (v % 64) & 1)) continue;
+        //les lignes retenues consécutives sont écrites d'un seul bloc
+        size_t debutBloc = 0, finBloc = 0;
+        for (uint32_t j = m_debutVoyage[v]; j < m_debutVoyage[v + 1]; ++j)
+        {
+            if (m_horaires[j].arrivee > p_fin || m_horaires[j].depart < p_debut) continue;
+            const uint32_t h = m_ligneDuFichier[j];
+            if (m_debutLigne[h] != finBloc)
+            {
+                if (finBloc != debutBloc) p_sortie(m_texte.data() + debutBloc, finBloc - debutBloc);
+                debutBloc = m_debutLigne[h];
+            }
+            finBloc = m_debutLigne[h + 1];
+        }
+        if (finBloc != debutBloc) p_sortie(m_texte.data() + debutBloc, finBloc - debutBloc);
+    }
+}
+
+const std::string &FluxGTFS::getDossier() const
+{
+    return m_dossier;
+}
+
+size_t FluxGTFS::getNbVoyages() const
+{
+    return m_idDuVoyage.size();
+}
+
+//! \return le nombre de lignes d'horaire (stop_times.txt) conservées
+size_t FluxGTFS::getNbHoraires() const
+{
+    return m_horaires.size();
+}
+
+//! \return la taille, en octets, du texte des horaires conservé en mémoire
+size_t FluxGTFS::getTailleTexte() const
+{
+    return m_texte.size();
+}
@@ -0,0 +1,62 @@
+//
+//  fluxGTFS.h
+//  Flux GTFS statique partagé entre plusieurs dates: stop_times.txt n'est lu qu'une seule fois
+//
+
+#ifndef TP2_FLUXGTFS_H
+#define TP2_FLUXGTFS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+#include "DonneesGTFS.h"
+#include "archiveZip.h"
+#include "statistiques.h"
+
+//! \brief Les horaires (stop_times.txt) d'un dossier GTFS (ou d'une archive .zip), gardés en mémoire pour produire
+//! les DonneesGTFS de plusieurs dates
+//! \note DonneesGTFS ne retient que les voyages d'une date; servir aujourd'hui et demain (voyages après 24:00)
+//! demandait deux chargements complets. Ici, stop_times.txt est lu une seule fois: ses lignes sont conservées
+//! telles quelles, indexées par voyage, avec l'heure d'arrivée et de départ déjà décodées. Pour une date,
+//! l'activation des voyages est un masque de bits; seules les lignes des voyages actifs dont l'horaire touche
+//! l'intervalle demandé sont transmises à DonneesGTFS::ajouterArretsDesVoyagesDeLaDate().
+//! \note les petits fichiers (routes, stops, calendar_dates, trips, transfers) sont relus pour chaque date:
+//! DonneesGTFS ne sait se remplir qu'à partir de fichiers
+//! \note donneesDeLaDate() est const et peut être appelée par plusieurs fils à la fois
+class FluxGTFS
+{
+public:
+    explicit FluxGTFS(const std::string &p_dossier);
+    std::unique_ptr<DonneesGTFS> donneesDeLaDate(const Date &p_date, const Heure &p_debut, const Heure &p_fin,
+                                                 StatistiquesChargement *p_stats = nullptr) const;
+    std::vector<uint64_t> voyagesActifs(const DonneesGTFS &p_gtfs) const;
+    const std::string &getDossier() const;
+    size_t getNbVoyages() const;
+    size_t getNbHoraires() const;
+    size_t getTailleTexte() const;
+
+private:
+    struct Horaire
+    {
+        uint32_t arrivee; //en secondes depuis minuit
+        uint32_t depart;
+    };
+
+    void ecrireHoraires(const std::vector<uint64_t> &p_actifs, unsigned int p_debut, unsigned int p_fin,
+                        const ArchiveZip::Recepteur &p_sortie) const;
+
+    std::string m_dossier; //un dossier GTFS ou une archive .zip
+    std::string m_entete; //la première ligne de stop_times.txt
+    std::string m_texte; //les lignes de stop_times.txt, dans l'ordre du fichier, chacune terminée par '\n'
+    std::vector<size_t> m_debutLigne; //la ligne h du fichier occupe m_texte[m_debutLigne[h], m_debutLigne[h+1])
+    std::vector<Horaire> m_horaires; //m_horaires[j]: les heures de la ligne m_ligneDuFichier[j]
+    std::vector<uint32_t> m_ligneDuFichier; //les lignes regroupées par voyage (dans l'ordre du fichier pour chacun)
+    std::vector<uint32_t> m_debutVoyage; //le voyage v a les indices j de m_debutVoyage[v] à m_debutVoyage[v+1]-1
+    std::vector<std::string> m_idDuVoyage; //m_idDuVoyage[v] est le trip_id du voyage d'indice v
+    std::unordered_map<std::string, uint32_t> m_indiceDuVoyage;
+};
+
+#endif //TP2_FLUXGTFS_H
@@ -0,0 +1,367 @@
+//
+//  generateurGTFS.cpp
+//  Générateur déterministe de dossiers GTFS synthétiques (routes, stops, calendar_dates, trips, stop_times, transfers)
+//
+//  Usage: generateur_exe dossier [--stations N] [--lignes N] [--arrets-par-ligne N] [--voyages-par-heure N]
+//                                [--disposition grille|aleatoire] [--graine S] [--date AAAAMMJJ]
+//                                [--heure-debut H] [--heure-fin H] [--fraction-inactive F] [--transferts F]
+//
+//  Les fichiers suivent la disposition des colonnes du dossier RTC attendue par DonneesGTFS.
+//  Avec les valeurs par défaut, le volume est comparable à RTC-9dec-24fev (~4 500 stations, ~160 lignes);
+//  multiplier --stations et --lignes par 10 à 100 donne des réseaux de 10 à 100 fois cette taille.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
+#include <stdexcept>
+#include <algorithm>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace
+{
+    struct Configuration
+    {
+        string dossier;
+        unsigned int nbStations = 4500;
+        unsigned int nbLignes = 160;
+        unsigned int arretsParLigne = 30;
+        unsigned int voyagesParHeure = 1; //par direction
+        bool grille = false;
+        unsigned long graine = 42;
+        string date = "20170209";
+        unsigned int heureDebut = 5;
+        unsigned int heureFin = 25; //les heures GTFS peuvent dépasser 24
+        double fractionInactive = 0.3; //fraction des voyages dont le service ne roule pas à la date choisie
+        double probabiliteTransfert = 0.15; //probabilité qu'une station ait un transfert vers une voisine
+    };
+
+    const double latCentre = 46.80; //Québec
+    const double lonCentre = -71.30;
+    const double espacementKm = 0.25; //distance moyenne entre stations voisines
+    const double vitesseAutobusKmH = 25.0;
+    const unsigned int arretEnStationSec = 20;
+    const double kmParDegreLat = 111.2;
+    const double rayonTransfertKm = 0.3;
+
+    struct Station
+    {
+        double lat;
+        double lon;
+    };
+
+    double distanceKm(const Station &a, const Station &b)
+    {
+        double dLat = (a.lat - b.lat) * kmParDegreLat;
+        double dLon = (a.lon - b.lon) * kmParDegreLat * cos(latCentre * M_PI / 180.0);
+        return sqrt(dLat * dLat + dLon * dLon);
+    }
+
+    //les tirages sont faits directement sur les sorties 32 bits de mt19937, dont la suite est fixée par la norme:
+    //les distributions de <random> ne le sont pas (leur algorithme dépend de la bibliothèque standard), et le même
+    //dossier ne serait pas produit avec libstdc++, libc++ et MSVC
+
+    //un réel uniforme dans [0, 1)
+    double tirerUnitaire(mt19937 &p_generateur)
+    {
+        return p_generateur() / 4294967296.0;
+    }
+
+    //un entier uniforme dans [0, p_n), par rejet des tirages qui biaiseraient le modulo
+    unsigned int tirerEntier(mt19937 &p_generateur, unsigned int p_n)
+    {
+        const uint64_t etendue = 4294967296ull;
+        const uint64_t limite = etendue - etendue % p_n;
+        uint64_t tirage;
+        do
+            tirage = p_generateur();
+        while (tirage >= limite);
+        return static_cast<unsigned int>(tirage % p_n);
+    }
+
+    //index spatial: grille de cases carrées de côté espacementKm, pour trouver rapidement les stations voisines
+    class IndexSpatial
+    {
+    public:
+        IndexSpatial(const vector<Station> &p_stations, double p_cote)
+            : m_stations(p_stations)
+        {
+            m_coteLat = p_cote / kmParDegreLat;
+            m_coteLon = p_cote / (kmParDegreLat * cos(latCentre * M_PI / 180.0));
+            m_latMin = m_lonMin = 1e9;
+            double latMax = -1e9, lonMax = -1e9;
+            for (auto &s : p_stations)
+            {
+                m_latMin = min(m_latMin, s.lat);
+                m_lonMin = min(m_lonMin, s.lon);
+                latMax = max(latMax, s.lat);
+                lonMax = max(lonMax, s.lon);
+            }
+            m_nbLat = static_cast<int>((latMax - m_latMin) / m_coteLat) + 1;
+            m_nbLon = static_cast<int>((lonMax - m_lonMin) / m_coteLon) + 1;
+            m_cases.resize(static_cast<size_t>(m_nbLat) * m_nbLon);
+            for (size_t i = 0; i < p_stations.size(); ++i)
+                m_cases[caseDe(p_stations[i].lat, p_stations[i].lon)].push_back(static_cast<unsigned int>(i));
+        }
+
+        //la station la plus proche du point, en cherchant dans des anneaux de cases de plus en plus grands
+        unsigned int plusProche(double p_lat, double p_lon) const
+        {
+            Station cible = {p_lat, p_lon};
+            int ci = ligneDe(p_lat), cj = colonneDe(p_lon);
+            unsigned int meilleure = 0;
+            double meilleureDistance = 1e18;
+            for (int rayon = 0; rayon < max(m_nbLat, m_nbLon); ++rayon)
+            {
+                for (int i = ci - rayon; i <= ci + rayon; ++i)
+                    for (int j = cj - rayon; j <= cj + rayon; ++j)
+                    {
+                        if (max(abs(i - ci), abs(j - cj)) != rayon) continue;
+                        if (i < 0 || j < 0 || i >= m_nbLat || j >= m_nbLon) continue;
+                        for (unsigned int s : m_cases[static_cast<size_t>(i) * m_nbLon + j])
+                        {
+                            double d = distanceKm(cible, m_stations[s]);
+                            if (d < meilleureDistance)
+                            {
+                                meilleureDistance = d;
+                                meilleure = s;
+                            }
+                        }
+                    }
+                if (meilleureDistance < 1e18 && meilleureDistance < rayon * espacementKm) break;
+            }
+            return meilleure;
+        }
+
+        //les stations des 9 cases autour d'un point
+        vector<unsigned int> voisines(double p_lat, double p_lon) const
+        {
+            vector<unsigned int> resultat;
+            int ci = ligneDe(p_lat), cj = colonneDe(p_lon);
+            for (int i = max(0, ci - 1); i <= min(m_nbLat - 1, ci + 1); ++i)
+                for (int j = max(0, cj - 1); j <= min(m_nbLon - 1, cj + 1); ++j)
+                    for (unsigned int s : m_cases[static_cast<size_t>(i) * m_nbLon + j]) resultat.push_back(s);
+            return resultat;
+        }
+
+    private:
+        int ligneDe(double p_lat) const
+        {
+            return max(0, min(m_nbLat - 1, static_cast<int>((p_lat - m_latMin) / m_coteLat)));
+        }
+
+        int colonneDe(double p_lon) const
+        {
+            return max(0, min(m_nbLon - 1, static_cast<int>((p_lon - m_lonMin) / m_coteLon)));
+        }
+
+        size_t caseDe(double p_lat, double p_lon) const
+        {
+            return static_cast<size_t>(ligneDe(p_lat)) * m_nbLon + colonneDe(p_lon);
+        }
+
+        const vector<Station> &m_stations;
+        double m_coteLat, m_coteLon, m_latMin, m_lonMin;
+        int m_nbLat, m_nbLon;
+        vector<vector<unsigned int> > m_cases;
+    };
+
+    //la date AAAAMMJJ décalée de p_jours jours
+    string decalerDate(const string &p_date, int p_jours)
+    {
+        tm t = tm();
+        t.tm_year = atoi(p_date.substr(0, 4).c_str()) - 1900;
+        t.tm_mon = atoi(p_date.substr(4, 2).c_str()) - 1;
+        t.tm_mday = atoi(p_date.substr(6, 2).c_str()) + p_jours;
+        t.tm_hour = 12;
+        time_t secondes = timegm(&t);
+        tm *resultat = gmtime(&secondes);
+        char tampon[16];
+        strftime(tampon, sizeof(tampon), "%Y%m%d", resultat);
+        return tampon;
+    }
+
+    string heureGTFS(unsigned int p_secondes)
+    {
+        char tampon[16];
+        snprintf(tampon, sizeof(tampon), "%02u:%02u:%02u", p_secondes / 3600, (p_secondes / 60) % 60, p_secondes % 60);
+        return tampon;
+    }
+
+    ofstream ouvrir(const Configuration &p_config, const string &p_fichier)
+    {
+        ofstream f(p_config.dossier + "/" + p_fichier);
+        if (!f) throw runtime_error("generateurGTFS: impossible d'écrire " + p_config.dossier + "/" + p_fichier);
+        return f;
+    }
+
+    Configuration lireConfiguration(int argc, char *argv[])
+    {
+        Configuration config;
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            bool aValeur = i + 1 < argc;
+            if (arg == "--stations" && aValeur) config.nbStations = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--lignes" && aValeur) config.nbLignes = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--arrets-par-ligne" && aValeur) config.arretsParLigne = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--voyages-par-heure" && aValeur) config.voyagesParHeure = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--disposition" && aValeur) config.grille = string(argv[++i]) == "grille";
+            else if (arg == "--graine" && aValeur) config.graine = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--date" && aValeur) config.date = argv[++i];
+            else if (arg == "--heure-debut" && aValeur) config.heureDebut = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--heure-fin" && aValeur) config.heureFin = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--fraction-inactive" && aValeur) config.fractionInactive = atof(argv[++i]);
+            else if (arg == "--transferts" && aValeur) config.probabiliteTransfert = atof(argv[++i]);
+            else if (arg[0] != '-') config.dossier = arg;
+            else throw runtime_error("generateurGTFS: option inconnue " + arg);
+        }
+        if (config.dossier.empty()) throw runtime_error("generateurGTFS: il faut indiquer le dossier de sortie");
+        if (config.nbStations < 2 || config.nbLignes == 0 || config.arretsParLigne < 2 || config.voyagesParHeure == 0)
+            throw runtime_error("generateurGTFS: paramètres de taille invalides");
+        if (config.date.size() != 8 || config.heureFin <= config.heureDebut)
+            throw runtime_error("generateurGTFS: date ou plage horaire invalide");
+        return config;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Configuration config;
+    try
+    {
+        config = lireConfiguration(argc, argv);
+    }
+    catch (exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    mkdir(config.dossier.c_str(), 0755);
+    mt19937 generateur(config.graine);
+
+    //stations: grille régulière ou points uniformes dans un carré de même densité
+    vector<Station> stations(config.nbStations);
+    unsigned int cote = static_cast<unsigned int>(ceil(sqrt(double(config.nbStations))));
+    double coteLat = espacementKm / kmParDegreLat;
+    double coteLon = espacementKm / (kmParDegreLat * cos(latCentre * M_PI / 180.0));
+    for (unsigned int i = 0; i < config.nbStations; ++i)
+    {
+        double x = config.grille ? i % cote : tirerUnitaire(generateur) * cote;
+        double y = config.grille ? i / cote : tirerUnitaire(generateur) * cote;
+        stations[i].lat = latCentre + (y - cote / 2.0) * coteLat;
+        stations[i].lon = lonCentre + (x - cote / 2.0) * coteLon;
+    }
+    IndexSpatial index(stations, espacementKm);
+
+    ofstream stops = ouvrir(config, "stops.txt");
+    stops << "\"stop_id\",\"stop_name\",\"stop_desc\",\"stop_lat\",\"stop_lon\",\"zone_id\",\"stop_url\","
+             "\"location_type\",\"parent_station\",\"wheelchair_boarding\"\n";
+    stops.precision(8);
+    for (unsigned int i = 0; i < config.nbStations; ++i)
+        stops << "\"" << i + 2 << "\",\"Station " << i + 2 << "\",\"Synthétique\",\"" << stations[i].lat << "\",\""
+              << stations[i].lon << "\",\"1\",\"\",\"0\",\"\",\"1\"\n"; //les stationId 0 et 1 sont réservés par ReseauGTFS
+
+    //lignes: segments droits d'orientation aléatoire, chaque point cible étant ramené à la station la plus proche
+    const char *couleurs[] = {"97BF0D", "013888", "E04503", "1A171B"};
+    vector<vector<unsigned int> > parcours(config.nbLignes);
+    for (unsigned int l = 0; l < config.nbLignes; ++l)
+    {
+        const Station &depart = stations[tirerEntier(generateur, config.nbStations)];
+        double theta = config.grille ? (l % 2) * M_PI / 2 : 2 * M_PI * tirerUnitaire(generateur);
+        for (unsigned int k = 0; parcours[l].size() < config.arretsParLigne && k < 4 * config.arretsParLigne; ++k)
+        {
+            double lat = depart.lat + k * coteLat * sin(theta);
+            double lon = depart.lon + k * coteLon * cos(theta);
+            unsigned int s = index.plusProche(lat, lon);
+            if (find(parcours[l].begin(), parcours[l].end(), s) == parcours[l].end()) parcours[l].push_back(s);
+        }
+    }
+
+    ofstream routes = ouvrir(config, "routes.txt");
+    routes << "\"route_id\",\"agency_id\",\"route_short_name\",\"route_long_name\",\"route_desc\",\"route_type\","
+              "\"route_url\",\"route_color\",\"route_text_color\"\n";
+    for (unsigned int l = 0; l < config.nbLignes; ++l)
+        routes << "\"" << l + 1 << "\",\"SYN\",\"" << l + 1 << "\",\"Ligne " << l + 1 << "\",\"Ligne synthétique "
+               << l + 1 << "\",\"3\",\"\",\"" << couleurs[l % 4] << "\",\"FFFFFF\"\n";
+
+    //deux services: celui de la date choisie et celui du lendemain (voyages inactifs à la date choisie)
+    ofstream calendrier = ouvrir(config, "calendar_dates.txt");
+    calendrier << "\"service_id\",\"date\",\"exception_type\"\n";
+    calendrier << "\"ACTIF\",\"" << config.date << "\",\"1\"\n";
+    calendrier << "\"INACTIF\",\"" << decalerDate(config.date, 1) << "\",\"1\"\n";
+
+    //voyages: dans chaque direction, voyagesParHeure départs par heure sur [heureDebut, heureFin)
+    ofstream trips = ouvrir(config, "trips.txt");
+    trips << "\"route_id\",\"service_id\",\"trip_id\",\"trip_headsign\",\"direction_id\",\"block_id\","
+             "\"shape_id\",\"wheelchair_accessible\"\n";
+    ofstream stopTimes = ouvrir(config, "stop_times.txt");
+    stopTimes << "\"trip_id\",\"arrival_time\",\"departure_time\",\"stop_id\",\"stop_sequence\",\"pickup_type\","
+                 "\"drop_off_type\"\n";
+    const unsigned int intervalle = 3600 / config.voyagesParHeure;
+    unsigned long nbVoyages = 0, nbArrets = 0;
+    for (unsigned int l = 0; l < config.nbLignes; ++l)
+    {
+        for (unsigned int direction = 0; direction < 2; ++direction)
+        {
+            vector<unsigned int> sequence(parcours[l]);
+            if (direction == 1) reverse(sequence.begin(), sequence.end());
+            vector<unsigned int> temps(sequence.size(), 0); //temps de parcours cumulé jusqu'à chaque station
+            for (size_t k = 1; k < sequence.size(); ++k)
+                temps[k] = temps[k - 1] + arretEnStationSec + static_cast<unsigned int>(
+                    3600.0 * distanceKm(stations[sequence[k - 1]], stations[sequence[k]]) / vitesseAutobusKmH);
+            for (unsigned int depart = config.heureDebut * 3600 + tirerEntier(generateur, intervalle);
+                 depart < config.heureFin * 3600; depart += intervalle)
+            {
+                ++nbVoyages;
+                char tripId[32];
+                snprintf(tripId, sizeof(tripId), "%010lu", nbVoyages); //ordre lexicographique == ordre d'écriture
+                const char *service = tirerUnitaire(generateur) < config.fractionInactive ? "INACTIF" : "ACTIF";
+                trips << "\"" << l + 1 << "\",\"" << service << "\",\"" << tripId << "\",\"Terminus "
+                      << sequence.back() + 2 << "\",\"" << direction << "\",\"\",\"\",\"1\"\n";
+                for (size_t k = 0; k < sequence.size(); ++k)
+                {
+                    string heure = heureGTFS(depart + temps[k]);
+                    stopTimes << "\"" << tripId << "\",\"" << heure << "\",\"" << heure << "\",\"" << sequence[k] + 2
+                              << "\",\"" << k + 1 << "\",\"0\",\"0\"\n";
+                    ++nbArrets;
+                }
+            }
+        }
+    }
+
+    //transferts vers une station voisine (à moins de rayonTransfertKm) desservie par les lignes
+    vector<bool> desservie(config.nbStations, false);
+    for (auto &p : parcours)
+        for (unsigned int s : p) desservie[s] = true;
+    ofstream transfers = ouvrir(config, "transfers.txt");
+    transfers << "\"from_stop_id\",\"to_stop_id\",\"transfer_type\",\"min_transfer_time\"\n";
+    unsigned long nbTransferts = 0;
+    for (unsigned int s = 0; s < config.nbStations; ++s)
+    {
+        if (!desservie[s] || tirerUnitaire(generateur) >= config.probabiliteTransfert) continue;
+        for (unsigned int v : index.voisines(stations[s].lat, stations[s].lon))
+        {
+            double d = distanceKm(stations[s], stations[v]);
+            if (v == s || !desservie[v] || d > rayonTransfertKm) continue;
+            transfers << "\"" << s + 2 << "\",\"" << v + 2 << "\",\"2\",\"" << 60 + static_cast<unsigned int>(720 * d)
+                      << "\"\n";
+            ++nbTransferts;
+            break;
+        }
+    }
+
+    cerr << "Dossier " << config.dossier << ": " << config.nbStations << " stations, " << config.nbLignes
+         << " lignes, " << nbVoyages << " voyages, " << nbArrets << " arrêts, " << nbTransferts << " transferts"
+         << endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+//
+//  gestionnaireReseau.cpp
+//  Versions successives du réseau (nouveau flux GTFS, nouvelle journée) remplacées sans interrompre les requêtes
+//
+
+#include "gestionnaireReseau.h"
+#include "chargementGTFS.h"
+#include "statistiques.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+atomic<unsigned int> GestionnaireReseau::nbVersionsVivantes(0);
+
+namespace
+{
+    //! \brief ramène le pic de la mémoire résidente du processus (VmHWM, donc aussi ru_maxrss) à sa valeur courante
+    //! \return faux si le noyau ne le permet pas (/proc/self/clear_refs)
+    //! \note efface le pic de tout le processus: appelée seulement si activerPointeExacte(true)
+    bool reinitialiserPointe()
+    {
+        ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5" << flush;
+        return static_cast<bool>(clearRefs);
+    }
+}
+
+SourceReseau::SourceReseau(const string &p_chemin, const Date &p_date, const Heure &p_debut, const Heure &p_fin,
+                           bool p_prefiltrer)
+    : chemin(p_chemin), date(p_date), debut(p_debut), fin(p_fin), prefiltrer(p_prefiltrer)
+{
+}
+
+RapportRechargement::RapportRechargement()
+    : version(0), chargement(0), construction(0), memoireAvant(0), memoirePointe(0), memoireApres(0)
+{
+}
+
+ostream &operator<<(ostream &p_flux, const RapportRechargement &p_rapport)
+{
+    return p_flux << "version " << p_rapport.version << ": chargement: " << p_rapport.chargement
+           << " us, construction: " << p_rapport.construction << " us, mémoire avant: " << p_rapport.memoireAvant
+           << " Ko, pointe: " << p_rapport.memoirePointe << " Ko, après: " << p_rapport.memoireApres << " Ko";
+}
+
+GestionnaireReseau::Version::Version(const SourceReseau &p_source, unsigned int p_numero)
+    : numero(p_numero), donnees(new DonneesGTFS(p_source.date, p_source.debut, p_source.fin))
+{
+    ++nbVersionsVivantes;
+}
+
+GestionnaireReseau::Version::~Version()
+{
+    --nbVersionsVivantes;
+}
+
+GestionnaireReseau::GestionnaireReseau()
+    : m_prochainNumero(1), m_enCours(false), m_cacheActif(true), m_pointeExacte(false)
+{
+}
+
+//! \brief active ou désactive le cache des itinéraires des versions construites ensuite (actif par défaut)
+//! \pre aucun rechargement n'est en cours
+void GestionnaireReseau::activerCache(bool p_actif)
+{
+    m_cacheActif = p_actif;
+}
+
+//! \brief choisit la mesure de RapportRechargement::memoirePointe (échantillonnée par défaut)
+//! \param[in] p_exacte: si vrai, chaque rechargement ramène d'abord le pic du processus (VmHWM, ru_maxrss) à la
+//! mémoire courante, puis le lit à la fin: le pic est exact, mais celui du processus est perdu pour tout autre
+//! observateur. À réserver à un programme de mesure qui ne se sert plus de ce pic (le banc d'essai)
+//! \pre aucun rechargement n'est en cours
+void GestionnaireReseau::activerPointeExacte(bool p_exacte)
+{
+    m_pointeExacte = p_exacte;
+}
+
+//! \note attend un rechargement en cours (son erreur éventuelle est ignorée)
+GestionnaireReseau::~GestionnaireReseau()
+{
+    if (m_fil.joinable()) m_fil.join();
+}
+
+//! \brief charge et publie une version, en attendant la fin
+//! \return le rapport du rechargement
+//! \throws logic_error (ou l'exception du chargement) comme recharger() et attendreRechargement()
+RapportRechargement GestionnaireReseau::charger(const SourceReseau &p_source)
+{
+    recharger(p_source);
+    return attendreRechargement();
+}
+
+//! \brief lance le chargement et la construction d'une nouvelle version en arrière-plan; elle remplacera la
+//! version courante dès qu'elle sera prête
+//! \note chaque recharger() doit être suivi d'un attendreRechargement(), qui en donne le rapport ou l'erreur
+//! \throws logic_error si le rechargement précédent n'a pas été attendu
+void GestionnaireReseau::recharger(const SourceReseau &p_source)
+{
+    if (m_fil.joinable())
+        throw logic_error("GestionnaireReseau::recharger(): le rechargement précédent n'a pas été attendu");
+    m_erreur = nullptr;
+    m_enCours = true;
+    m_fil = thread(&GestionnaireReseau::construire, this, p_source, m_prochainNumero++);
+}
+
+//! \return vrai tant que la version lancée par recharger() n'est pas publiée (ou n'a pas échoué)
+bool GestionnaireReseau::estEnRechargement() const
+{
+    return m_enCours;
+}
+
+//! \brief attend la fin du rechargement lancé par recharger()
+//! \return son rapport
+//! \throws logic_error si aucun rechargement n'a été lancé
+//! \throws l'exception du chargement ou de la construction; la version courante reste alors en place
+RapportRechargement GestionnaireReseau::attendreRechargement()
+{
+    if (!m_fil.joinable()) throw logic_error("GestionnaireReseau::attendreRechargement(): aucun rechargement lancé");
+    m_fil.join();
+    if (m_erreur) rethrow_exception(m_erreur);
+    return m_rapport;
+}
+
+//! \return la version courante (nulle avant le premier chargement); elle reste valide tant qu'on la retient,
+//! même si une autre version est publiée entre-temps
+GestionnaireReseau::Poignee GestionnaireReseau::acquerir() const
+{
+    return atomic_load(&m_courante);
+}
+
+//! \brief calcule un itinéraire sur la version courante
+//! \param[in] p_depart: l'heure de départ, dans l'intervalle des données de la version courante
+//! \param[out] p_version: si non nul, reçoit la version utilisée (pour afficher l'itinéraire avec ses données)
+//! \note n'attend ni les autres requêtes ni un rechargement: le réseau n'est pas modifié, et les tableaux de
+//! travail de la recherche sont propres au fil appelant. Le cache du réseau de la version (voir activerCache()) est
+//! consulté avec l'heure de départ dans la clé; il disparaît avec la version
+//! \throws logic_error si aucune version n'est chargée ou si la requête échoue (p_depart hors de l'intervalle)
+Itineraire GestionnaireReseau::calculerItineraire(const Coordonnees &p_origine, const Coordonnees &p_destination,
+                                                  const Heure &p_depart, Poignee *p_version) const
+{
+    Poignee version = acquerir();
+    if (!version) throw logic_error("GestionnaireReseau::calculerItineraire(): aucun réseau chargé");
+    //redimensionné au premier appel, et à chaque changement de taille du réseau entre deux versions
+    static thread_local EspaceRequete espace;
+    Itineraire resultat = version->reseau->calculerItineraire(*version->donnees, p_origine, p_destination, p_depart,
+                                                              espace);
+    if (p_version) *p_version = version;
+    return resultat;
+}
+
+//! \return le nombre de versions en mémoire (la courante et celles que des requêtes retiennent encore)
+unsigned int GestionnaireReseau::getNbVersionsVivantes()
+{
+    return nbVersionsVivantes;
+}
+
+//le corps du fil de rechargement: charge, construit, publie; l'ancienne version est détruite par le dernier qui la
+//relâche (ce fil-ci, si aucune requête ne la retient)
+void GestionnaireReseau::construire(SourceReseau p_source, unsigned int p_numero)
+{
+    try
+    {
+        RapportRechargement rapport;
+        rapport.version = p_numero;
+        EchantillonneurMemoire echantillonneur;
+        rapport.memoireAvant = echantillonneur.getDebut();
+        const bool pointeExacte = m_pointeExacte && reinitialiserPointe();
+
+        Chronometre chronometre;
+        Poignee version = make_shared<Version>(p_source, p_numero);
+        chargerDonneesGTFS(*version->donnees, p_source.chemin, nullptr, p_source.prefiltrer);
+        rapport.chargement = chronometre.ecoule();
+
+        chronometre = Chronometre();
+        version->reseau.reset(new ReseauGTFS(*version->donnees));
+        version->reseau->activerCache(m_cacheActif);
+        rapport.construction = chronometre.ecoule();
+        rapport.memoirePointe = echantillonneur.getPointe();
+        if (pointeExacte) rapport.memoirePointe = max(rapport.memoirePointe, lireMemoireKo("VmHWM:"));
+
+        atomic_store(&m_courante, version);
+        version.reset();
+        rapport.memoireApres = lireMemoireKo("VmRSS:");
+        m_rapport = rapport;
+    }
+    catch (...)
+    {
+        m_erreur = current_exception();
+    }
+    m_enCours = false;
+}
@@ -0,0 +1,106 @@
+//
+//  gestionnaireReseau.h
+//  Versions successives du réseau (nouveau flux GTFS, nouvelle journée) remplacées sans interrompre les requêtes
+//
+
+#ifndef TP2_GESTIONNAIRERESEAU_H
+#define TP2_GESTIONNAIRERESEAU_H
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <exception>
+#include <iostream>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "itineraire.h"
+
+//! \brief Ce qu'il faut pour construire une version du réseau: le flux (dossier ou archive .zip) et l'intervalle
+struct SourceReseau
+{
+    std::string chemin;
+    Date date;
+    Heure debut;
+    Heure fin;
+    bool prefiltrer;
+
+    SourceReseau(const std::string &p_chemin, const Date &p_date, const Heure &p_debut, const Heure &p_fin,
+                 bool p_prefiltrer = true);
+};
+
+//! \brief Durées (en microsecondes) et mémoire résidente (en Ko) d'un rechargement
+//! \note memoirePointe est le pic pendant le chargement et la construction, les deux versions étant en mémoire.
+//! Par défaut, c'est le plus grand échantillon de VmRSS pris toutes les 2 ms pendant le rechargement
+//! (EchantillonneurMemoire): le pic du processus (VmHWM, ru_maxrss) n'est pas touché. Avec
+//! GestionnaireReseau::activerPointeExacte(true), ce pic est réinitialisé au début du rechargement et lu à la fin.
+//! memoireApres est mesurée juste après la publication (l'ancienne version vit tant qu'une requête la retient)
+struct RapportRechargement
+{
+    unsigned int version;
+    long chargement;
+    long construction;
+    long memoireAvant;
+    long memoirePointe;
+    long memoireApres;
+
+    RapportRechargement();
+};
+
+std::ostream &operator<<(std::ostream &p_flux, const RapportRechargement &p_rapport);
+
+//! \brief Double tampon de réseaux: la version courante répond aux requêtes pendant que la suivante se construit
+//! \note recharger() charge et construit la nouvelle version dans un fil d'exécution en arrière-plan, puis la
+//! publie d'un seul coup (std::atomic_store d'un shared_ptr). Une requête retient la version qu'elle a acquise
+//! (acquerir()) jusqu'à la fin: une version remplacée est détruite par le dernier qui la relâche.
+//! Les requêtes n'attendent jamais un rechargement.
+//! \note les requêtes ne modifient pas le réseau (ReseauGTFS::calculerItineraire() avec un EspaceRequete propre à
+//! chaque fil): elles passent en parallèle, sur la même version comme sur des versions différentes. Chaque version
+//! a son propre cache d'itinéraires (à verrous par fragment), vide à sa publication
+class GestionnaireReseau
+{
+public:
+    struct Version
+    {
+        explicit Version(const SourceReseau &p_source, unsigned int p_numero);
+        ~Version();
+
+        const unsigned int numero;
+        std::unique_ptr<DonneesGTFS> donnees;
+        std::unique_ptr<ReseauGTFS> reseau;
+    };
+    typedef std::shared_ptr<Version> Poignee;
+
+    GestionnaireReseau();
+    ~GestionnaireReseau();
+    GestionnaireReseau(const GestionnaireReseau &) = delete;
+    GestionnaireReseau &operator=(const GestionnaireReseau &) = delete;
+
+    RapportRechargement charger(const SourceReseau &);
+    void recharger(const SourceReseau &);
+    bool estEnRechargement() const;
+    RapportRechargement attendreRechargement();
+    Poignee acquerir() const;
+    void activerCache(bool);
+    void activerPointeExacte(bool);
+    Itineraire calculerItineraire(const Coordonnees &, const Coordonnees &, const Heure &, Poignee * = nullptr) const;
+
+    static unsigned int getNbVersionsVivantes();
+
+private:
+    void construire(SourceReseau p_source, unsigned int p_numero);
+
+    Poignee m_courante; //lue et remplacée seulement par std::atomic_load() et std::atomic_store()
+    unsigned int m_prochainNumero;
+    std::thread m_fil; //le rechargement en cours, s'il y a lieu
+    std::atomic<bool> m_enCours;
+    std::exception_ptr m_erreur; //l'exception du rechargement, relancée par attendreRechargement()
+    RapportRechargement m_rapport;
+    bool m_cacheActif; //voir activerCache()
+    bool m_pointeExacte; //voir activerPointeExacte()
+
+    static std::atomic<unsigned int> nbVersionsVivantes;
+};
+
+#endif //TP2_GESTIONNAIRERESEAU_H
@@ -7,29 +7,176 @@
 
 #include "graphe.h"
 
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
 using namespace std;
 
+namespace
+{
+    //! \brief barrière réutilisable: les p_nbFils fils attendent que tous y soient arrivés (C++11 n'en a pas)
+    class Barriere
+    {
+    public:
+        explicit Barriere(unsigned int p_nbFils) : m_nbFils(p_nbFils), m_attendus(p_nbFils), m_generation(0)
+        {
+        }
+
+        void attendre()
+        {
+            unique_lock<mutex> verrou(m_mutex);
+            const unsigned long generation = m_generation;
+            if (--m_attendus == 0)
+            {
+                m_attendus = m_nbFils;
+                ++m_generation;
+                m_condition.notify_all();
+            }
+            else
+                m_condition.wait(verrou, [&]() { return generation != m_generation; });
+        }
+
+    private:
+        mutex m_mutex;
+        condition_variable m_condition;
+        const unsigned int m_nbFils;
+        unsigned int m_attendus;
+        unsigned long m_generation;
+    };
+}
+
 //! \brief Constructeur avec paramètre du nombre de sommets désiré
 //! \param[in] p_nbSommets indique le nombre de sommets désiré
-//! \post crée le vecteur de p_nbSommets de listes d'adjacence vides
-Graphe::Graphe(size_t p_nbSommets)
-    : m_listesAdj(p_nbSommets)
+//! \post crée p_nbSommets listes d'adjacence vides
+//! \throws logic_error si p_nbSommets ne tient pas dans le type Sommet
+template<typename Sommet, typename Poids>
+GrapheT<Sommet, Poids>::GrapheT(size_t p_nbSommets)
+    : m_arcsLibres(numeric_limits<Sommet>::max())
 {
+    resize(p_nbSommets);
 }
 
 //! \brief change le nombre de sommets du graphe
 //! \param[in] p_nouvelleTaille indique le nouveau nombre de sommet
-//! \post le graphe est un vecteur de p_nouvelleTaille de listes d'adjacence
+//! \post le graphe possède p_nouvelleTaille listes d'adjacence
 //! \post les anciennes listes d'adjacence sont toujours présentes lorsque p_nouvelleTaille >= à l'ancienne taille
-//! \post les dernières listes d'adjacence sont enlevées lorsque p_nouvelleTaille < à l'ancienne taille
-void Graphe::resize(size_t p_nouvelleTaille)
+//! \post les dernières listes d'adjacence sont enlevées (et leurs arcs rendus au bassin) lorsque p_nouvelleTaille < à l'ancienne taille
+//! \throws logic_error si p_nouvelleTaille ne tient pas dans le type Sommet
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::resize(size_t p_nouvelleTaille)
+{
+    if (p_nouvelleTaille >= numeric_limits<Sommet>::max())
+        throw logic_error("Graphe::resize(): trop de sommets pour le type des numéros de sommets");
+    for (size_t i = p_nouvelleTaille; i < m_premierArc.size(); ++i)
+        for (Sommet a = m_premierArc[i]; a != numeric_limits<Sommet>::max();)
+        {
+            Sommet suivant = m_suivant[a];
+            libererArc(a);
+            a = suivant;
+        }
+    m_premierArc.resize(p_nouvelleTaille, numeric_limits<Sommet>::max());
+    m_dernierArc.resize(p_nouvelleTaille, numeric_limits<Sommet>::max());
+}
+
+template<typename Sommet, typename Poids>
+size_t GrapheT<Sommet, Poids>::getNbSommets() const
 {
-    m_listesAdj.resize(p_nouvelleTaille);
+	return m_premierArc.size();
 }
 
-size_t Graphe::getNbSommets() const
+//! \brief réserve la place de p_nbArcs arcs dans le bassin (évite ses réallocations pendant la construction)
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::reserverArcs(size_t p_nbArcs)
 {
-	return m_listesAdj.size();
+    m_destination.reserve(p_nbArcs);
+    m_suivant.reserve(p_nbArcs);
+    m_poids.reserve(p_nbArcs);
+}
+
+//! \brief ajoute à p_rapport la mémoire du graphe: graphe.sommets (les têtes et les queues des listes
+//! d'adjacence) et graphe.arcs (le bassin d'arcs, arcs libres compris)
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::mesurerMemoire(RapportMemoire &p_rapport) const
+{
+    p_rapport.ajouter("graphe.sommets", octetsVecteur(m_premierArc) + octetsVecteur(m_dernierArc), m_premierArc.size());
+    p_rapport.ajouter("graphe.arcs", octetsVecteur(m_destination) + octetsVecteur(m_suivant) + octetsVecteur(m_poids),
+                      m_destination.size());
+}
+
+//! \return l'indice d'un arc libre du bassin (un arc enlevé, sinon un nouvel arc à la fin du bassin)
+//! \throws logic_error si le nombre d'arcs ne tient pas dans le type Sommet
+template<typename Sommet, typename Poids>
+Sommet GrapheT<Sommet, Poids>::nouvelArc()
+{
+    if (m_arcsLibres != numeric_limits<Sommet>::max())
+    {
+        Sommet a = m_arcsLibres;
+        m_arcsLibres = m_suivant[a];
+        return a;
+    }
+    if (m_destination.size() >= numeric_limits<Sommet>::max())
+        throw logic_error("Graphe::ajouterArc(): trop d'arcs pour le type des numéros de sommets");
+    m_destination.push_back(0);
+    m_suivant.push_back(0);
+    m_poids.push_back(0);
+    return static_cast<Sommet>(m_destination.size() - 1);
+}
+
+//! \brief rend l'arc a (déjà détaché de sa liste d'adjacence) à la chaîne des arcs libres
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::libererArc(Sommet a)
+{
+    m_suivant[a] = m_arcsLibres;
+    m_arcsLibres = a;
+}
+
+//! \brief renumérote les sommets du graphe
+//! \param[in] p_nouveauNumero: p_nouveauNumero[i] est le nouveau numéro du sommet i (une permutation de 0..n-1)
+//! \post le sommet i devient le sommet p_nouveauNumero[i]; ses arcs sortants gardent leur ordre et leur poids
+//! \post le bassin d'arcs est reconstruit dans l'ordre des nouveaux numéros: les arcs d'un sommet sont contigus
+//! et les arcs libres disparaissent (meilleure localité en mémoire)
+//! \throws logic_error si p_nouveauNumero n'est pas une permutation des sommets
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::renumeroter(const vector<size_t> &p_nouveauNumero)
+{
+    const size_t n = m_premierArc.size();
+    if (p_nouveauNumero.size() != n)
+        throw logic_error("Graphe::renumeroter(): la permutation doit couvrir tous les sommets");
+    vector<size_t> ancienNumero(n, numeric_limits<size_t>::max());
+    for (size_t i = 0; i < p_nouveauNumero.size(); ++i)
+    {
+        if (p_nouveauNumero[i] >= n || ancienNumero[p_nouveauNumero[i]] != numeric_limits<size_t>::max())
+            throw logic_error("Graphe::renumeroter(): p_nouveauNumero n'est pas une permutation");
+        ancienNumero[p_nouveauNumero[i]] = i;
+    }
+    size_t nbArcs = m_destination.size();
+    for (Sommet a = m_arcsLibres; a != numeric_limits<Sommet>::max(); a = m_suivant[a]) --nbArcs;
+
+    vector<Sommet> premier(n, numeric_limits<Sommet>::max()), dernier(n, numeric_limits<Sommet>::max());
+    vector<Sommet> destination, suivant;
+    vector<Poids> poids;
+    destination.reserve(nbArcs);
+    suivant.reserve(nbArcs);
+    poids.reserve(nbArcs);
+    for (size_t j = 0; j < n; ++j)
+        for (Sommet a = m_premierArc[ancienNumero[j]]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+        {
+            Sommet b = static_cast<Sommet>(destination.size());
+            if (premier[j] == numeric_limits<Sommet>::max()) premier[j] = b;
+            else suivant.back() = b;
+            dernier[j] = b;
+            destination.push_back(static_cast<Sommet>(p_nouveauNumero[m_destination[a]]));
+            suivant.push_back(numeric_limits<Sommet>::max());
+            poids.push_back(m_poids[a]);
+        }
+    m_premierArc.swap(premier);
+    m_dernierArc.swap(dernier);
+    m_destination.swap(destination);
+    m_suivant.swap(suivant);
+    m_poids.swap(poids);
+    m_arcsLibres = numeric_limits<Sommet>::max();
 }
 
 //! \brief ajoute un arc d'un poids donné dans le graphe
@@ -37,63 +184,94 @@ size_t Graphe::getNbSommets() const
 //! \param[in] j: le sommet destination de l'arc
 //! \param[in] poids: le poids de l'arc
 //! \pre les sommets i et j doivent exister
+//! \post l'arc est placé à la fin de la liste d'adjacence de i
 //! \throws logic_error lorsque le sommet i ou le sommet j n'existe pas
-//! \throws logic_error lorsque le poids == numeric_limits<unsigned int>::max()
-void Graphe::ajouterArc(size_t i, size_t j, unsigned int poids)
+//! \throws logic_error lorsque le poids == numeric_limits<unsigned int>::max() ou ne tient pas dans le type Poids
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::ajouterArc(size_t i, size_t j, unsigned int poids)
 {
-    if (i >= m_listesAdj.size()) throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet i inexistant");
-    if (j >= m_listesAdj.size()) throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet j inexistant");
-    if (poids == numeric_limits<unsigned int>::max())
+    if (i >= m_premierArc.size()) throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet i inexistant");
+    if (j >= m_premierArc.size()) throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet j inexistant");
+    if (poids == numeric_limits<unsigned int>::max() || poids > numeric_limits<Poids>::max())
         throw logic_error("Graphe::ajouterArc(): valeur de poids interdite");
-	m_listesAdj[i].push_back(Arc(j, poids));
+    Sommet a = nouvelArc();
+    m_destination[a] = static_cast<Sommet>(j);
+    m_poids[a] = static_cast<Poids>(poids);
+    m_suivant[a] = numeric_limits<Sommet>::max();
+    if (m_dernierArc[i] == numeric_limits<Sommet>::max()) m_premierArc[i] = a;
+    else m_suivant[m_dernierArc[i]] = a;
+    m_dernierArc[i] = a;
 }
 
 //! \brief enlève un arc dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
 //! \pre l'arc (i,j) et les sommets i et j dovent exister
-//! \post enlève l'arc mais n'enlève jamais le sommet i
+//! \post enlève l'arc (le dernier arc (i,j) de la liste, par choix) mais n'enlève jamais le sommet i
 //! \throws logic_error lorsque le sommet i ou le sommet j n'existe pas
 //! \throws logic_error lorsque l'arc n'existe pas
-void Graphe::enleverArc(size_t i, size_t j)
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::enleverArc(size_t i, size_t j)
 {
-    if (i >= m_listesAdj.size()) throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet i inexistant");
-    if (j >= m_listesAdj.size()) throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet j inexistant");
-    auto & liste = m_listesAdj[i];
-    bool arc_enleve = false;
-    for (auto itr = liste.end(); itr != liste.begin();) //on débute par la fin par choix
-    {
-        if ( (--itr)->destination == j )
+    if (i >= m_premierArc.size()) throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet i inexistant");
+    if (j >= m_premierArc.size()) throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet j inexistant");
+    //la liste est simplement chaînée: on retient le dernier arc (i,j) rencontré et son prédécesseur
+    Sommet trouve = numeric_limits<Sommet>::max(), predTrouve = numeric_limits<Sommet>::max();
+    for (Sommet a = m_premierArc[i], pred = numeric_limits<Sommet>::max(); a != numeric_limits<Sommet>::max();
+         pred = a, a = m_suivant[a])
+        if (m_destination[a] == j)
         {
-            liste.erase(itr);
-            arc_enleve = true;
-            break;
+            trouve = a;
+            predTrouve = pred;
         }
-    }
-    if (arc_enleve == false) throw logic_error("Graphe::enleverArc: cet arc n'existe pas; donc impossible de l'enlever");
+    if (trouve == numeric_limits<Sommet>::max()) throw logic_error("Graphe::enleverArc: cet arc n'existe pas; donc impossible de l'enlever");
+    if (predTrouve == numeric_limits<Sommet>::max()) m_premierArc[i] = m_suivant[trouve];
+    else m_suivant[predTrouve] = m_suivant[trouve];
+    if (m_dernierArc[i] == trouve) m_dernierArc[i] = predTrouve;
+    libererArc(trouve);
 }
 
 
-unsigned int Graphe::getPoids(size_t i, size_t j) const
+template<typename Sommet, typename Poids>
+unsigned int GrapheT<Sommet, Poids>::getPoids(size_t i, size_t j) const
 {
-    if (i >= m_listesAdj.size()) throw logic_error("Graphe::getPoids(): l'incice i n,est pas un sommet existant");
-    for (auto itr = m_listesAdj[i].begin(); itr != m_listesAdj[i].end(); ++itr)
+    if (i >= m_premierArc.size()) throw logic_error("Graphe::getPoids(): l'incice i n,est pas un sommet existant");
+    for (Sommet a = m_premierArc[i]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
     {
-        if (itr->destination == j) return itr->poids;
+        if (m_destination[a] == j) return m_poids[a];
     }
     throw logic_error("Graphe::getPoids(): l'arc(i,j) est existant");
 }
 
 
+//! \brief donne les arcs sortants d'un sommet (destination, poids), dans l'ordre de sa liste d'adjacence
+//! \throws logic_error si i n'est pas un sommet existant
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::getArcsSortants(size_t i, std::vector<std::pair<size_t, unsigned int> > &p_arcs) const
+{
+    if (i >= m_premierArc.size()) throw logic_error("Graphe::getArcsSortants(): i n'est pas un sommet existant");
+    p_arcs.clear();
+    for (Sommet a = m_premierArc[i]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+        p_arcs.push_back(std::make_pair(static_cast<size_t>(m_destination[a]), static_cast<unsigned int>(m_poids[a])));
+}
+
+
 //! \brief Algorithme de Dijkstra permettant de trouver le plus court chemin entre p_origine et p_destination
 //! \pre p_origine et p_destination doivent être des sommets du graphe
 //! \return la longueur du plus court chemin est retournée
 //! \param[out] le chemin est retourné (un seul noeud si p_destination == p_origine ou si p_destination est inatteignable)
 //! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
+//! \param[in,out] p_espace: les tableaux de travail (dimensionnés au premier appel, remis à l'état initial à la fin);
+//! plusieurs fils peuvent chercher dans le même graphe à la fois, chacun avec le sien
+//! \param[out] p_stats: si non nul, reçoit les compteurs de cette recherche (nuls si GTFS_STATS n'est pas défini)
 //! \throws logic_error lorsque p_origine ou p_destination n'existe pas
-unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin) const
+template<typename Sommet, typename Poids>
+unsigned int GrapheT<Sommet, Poids>::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                     EspaceRecherche &p_espace, StatistiquesRecherche *p_stats) const
 {
-    if (p_origine >= m_listesAdj.size() || p_destination >= m_listesAdj.size())
+    if (p_stats) *p_stats = StatistiquesRecherche();
+    GTFS_STAT(StatistiquesRecherche stats);
+    if (p_origine >= m_premierArc.size() || p_destination >= m_premierArc.size())
         throw logic_error("Graphe::plusCourtChemin(): p_origine ou p_destination n'existe pas");
     if (p_origine == p_destination)
     {
@@ -101,77 +279,469 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
         p_chemin.push_back(p_destination);
         return 0;
     }
-    static vector<unsigned int> distance(m_listesAdj.size());
-    static vector<size_t> predecesseur(m_listesAdj.size());
-
-    for (size_t i = 0; i < m_listesAdj.size(); ++i)
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    const size_t aucun = numeric_limits<size_t>::max();
+    vector<unsigned int> &distance = p_espace.distance;
+    vector<size_t> &predecesseur = p_espace.predecesseur;
+    vector<size_t> &touches = p_espace.touches;
+    if (distance.size() != m_premierArc.size())
     {
-        distance[i] = numeric_limits<unsigned int>::max(); //une distance infinie a priori pour rejoindre ce noeud
-        predecesseur[i] = numeric_limits<size_t>::max(); //indique l'absence d'un prédécesseur
+        distance.assign(m_premierArc.size(), infini); //une distance infinie a priori
+        predecesseur.assign(m_premierArc.size(), aucun); //indique l'absence d'un prédécesseur
+        p_espace.coutCible.assign(m_premierArc.size(), infini);
+        touches.clear();
     }
     distance[p_origine] = 0;
+    touches.push_back(p_origine);
 
-    list<size_t> q; //ensemble des noeuds non solutionnés;
-    for (size_t i = 0; i < m_listesAdj.size(); ++i) //construction de q
-    {
-        q.push_back(i);
-    }
+    //file de priorité binaire des (distance, sommet); une entrée périmée est ignorée lors de son retrait
+    typedef pair<unsigned int, Sommet> Entree;
+    priority_queue<Entree, vector<Entree>, greater<Entree> > q;
+    q.push(Entree(0, static_cast<Sommet>(p_origine)));
+    GTFS_STAT(++stats.insertionsFile);
 
     //Boucle principale: touver distance[] et predecesseur[]
-    for (size_t cpt = 0; cpt < m_listesAdj.size(); ++cpt)  //faire m_listesAdj.size() fois
+    while (!q.empty())
     {
-        //trouver uStar dans q tel que distance[uStar] est minimal
-        auto uStar_itr = q.begin();
-        unsigned int min = distance[*uStar_itr];
-        for (auto itr = q.begin(); itr != q.end(); ++itr)
+        GTFS_STAT(stats.tailleMaxFile = std::max<unsigned long>(stats.tailleMaxFile, q.size()));
+        Entree e = q.top();
+        q.pop();
+        GTFS_STAT(++stats.retraitsFile);
+        Sommet uStar = e.second; //le noeud solutionné
+        if (e.first != distance[uStar]) continue;
+        GTFS_STAT(++stats.sommetsFixes);
+
+        if (uStar == p_destination) break; //car on a obtenu distance[p_destination] et predecesseur[p_destination]
+
+        //relâcher les arcs sortant de uStar
+        for (Sommet a = m_premierArc[uStar]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
         {
-            if (distance[*itr] < min)
+            GTFS_STAT(++stats.arcsRelaches);
+            Sommet v = m_destination[a];
+            unsigned int temp = distance[uStar] + m_poids[a];
+            if (temp < distance[v])
             {
-                min = distance[*itr];
-                uStar_itr = itr;
+                if (distance[v] == infini) touches.push_back(v);
+                distance[v] = temp;
+                predecesseur[v] = uStar;
+                q.push(Entree(temp, v));
+                GTFS_STAT(++stats.insertionsFile);
             }
         }
+    }
 
-        size_t uStar = *uStar_itr; //le noeud solutionné
-        q.erase(uStar_itr); //l'enlevé de q
+    GTFS_STAT(if (p_stats) *p_stats = stats);
 
-        if (uStar == p_destination) break; //car on a obtenu distance[p_destination] et predecesseur[p_destination]
+    //construire le plus court chemin à l'aide de predecesseur[] (la destination seule si elle n'est pas atteinte)
+    const unsigned int longueur = predecesseur[p_destination] == aucun ? infini : distance[p_destination];
+    p_chemin.clear();
+    if (longueur == infini)
+        p_chemin.push_back(p_destination);
+    else
+    {
+        stack<size_t> pileDuChemin;
+        size_t numero = p_destination;
+        pileDuChemin.push(numero);
+        while (predecesseur[numero] != aucun)
+        {
+            numero = predecesseur[numero];
+            pileDuChemin.push(numero);
+        }
+        while (!pileDuChemin.empty())
+        {
+            p_chemin.push_back(pileDuChemin.top());
+            pileDuChemin.pop();
+        }
+    }
 
-        //relâcher les arcs sortant de uStar
-        for (auto u_itr = m_listesAdj[uStar].begin(); u_itr != m_listesAdj[uStar].end(); ++u_itr )
+    for (size_t v : touches)
+    {
+        distance[v] = infini;
+        predecesseur[v] = aucun;
+    }
+    touches.clear();
+    return longueur;
+}
+
+//! \brief Algorithme de Dijkstra à plusieurs sources et plusieurs cibles, sans modifier le graphe
+//! \param[in] p_sources: les (sommet, distance initiale) d'où partir, par exemple les arrêts atteints à pieds
+//! \param[in] p_cibles: les (sommet, coût ajouté) où arriver, par exemple les sommets de sortie des stations
+//! proches de la destination
+//! \param[out] p_chemin: les sommets du meilleur chemin, d'une source à une cible (vide si aucun)
+//! \param[in,out] p_espace: les tableaux de travail (dimensionnés au premier appel, remis à l'état initial à la fin)
+//! \param[out] p_stats: si non nul, reçoit les compteurs de cette recherche (nuls si GTFS_STATS n'est pas défini)
+//! \return le minimum de la distance d'une cible plus son coût, numeric_limits<unsigned int>::max() si aucune
+//! n'est atteignable
+//! \note équivaut à plusCourtChemin() d'un sommet relié aux sources vers un sommet relié aux cibles, mais les
+//! tableaux appartiennent à l'appelant: plusieurs fils peuvent chercher dans le même graphe à la fois
+//! \throws logic_error lorsqu'une source ou une cible n'existe pas
+template<typename Sommet, typename Poids>
+unsigned int GrapheT<Sommet, Poids>::plusCourtCheminMultiple(const vector<pair<size_t, unsigned int> > &p_sources,
+                                                             const vector<pair<size_t, unsigned int> > &p_cibles,
+                                                             vector<size_t> &p_chemin, EspaceRecherche &p_espace,
+                                                             StatistiquesRecherche *p_stats) const
+{
+    if (p_stats) *p_stats = StatistiquesRecherche();
+    GTFS_STAT(StatistiquesRecherche stats);
+    const size_t n = m_premierArc.size();
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    const size_t aucun = numeric_limits<size_t>::max();
+    for (const auto &source : p_sources)
+        if (source.first >= n) throw logic_error("Graphe::plusCourtCheminMultiple(): une source n'existe pas");
+    for (const auto &cible : p_cibles)
+        if (cible.first >= n) throw logic_error("Graphe::plusCourtCheminMultiple(): une cible n'existe pas");
+
+    vector<unsigned int> &distance = p_espace.distance;
+    vector<size_t> &predecesseur = p_espace.predecesseur;
+    vector<unsigned int> &coutCible = p_espace.coutCible;
+    vector<size_t> &touches = p_espace.touches;
+    if (distance.size() != n)
+    {
+        distance.assign(n, infini);
+        predecesseur.assign(n, aucun);
+        coutCible.assign(n, infini);
+        touches.clear();
+    }
+    for (const auto &cible : p_cibles)
+    {
+        coutCible[cible.first] = min(coutCible[cible.first], cible.second);
+        touches.push_back(cible.first);
+    }
+
+    typedef pair<unsigned int, Sommet> Entree;
+    priority_queue<Entree, vector<Entree>, greater<Entree> > q;
+    for (const auto &source : p_sources)
+        if (source.second < distance[source.first])
         {
-            unsigned int temp = distance[uStar] + u_itr->poids;
-            if (temp < distance[u_itr->destination])
+            distance[source.first] = source.second;
+            touches.push_back(source.first);
+            q.push(Entree(source.second, static_cast<Sommet>(source.first)));
+            GTFS_STAT(++stats.insertionsFile);
+        }
+
+    //une entrée retirée à une distance d'au moins le meilleur total ne peut plus l'améliorer (coûts non négatifs)
+    unsigned int meilleur = infini;
+    size_t arrivee = aucun;
+    while (!q.empty())
+    {
+        GTFS_STAT(stats.tailleMaxFile = std::max<unsigned long>(stats.tailleMaxFile, q.size()));
+        Entree e = q.top();
+        q.pop();
+        GTFS_STAT(++stats.retraitsFile);
+        Sommet uStar = e.second;
+        if (e.first != distance[uStar]) continue;
+        if (e.first >= meilleur) break;
+        GTFS_STAT(++stats.sommetsFixes);
+
+        if (coutCible[uStar] != infini && e.first + coutCible[uStar] < meilleur)
+        {
+            meilleur = e.first + coutCible[uStar];
+            arrivee = uStar;
+        }
+
+        for (Sommet a = m_premierArc[uStar]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+        {
+            GTFS_STAT(++stats.arcsRelaches);
+            Sommet v = m_destination[a];
+            unsigned int temp = distance[uStar] + m_poids[a];
+            if (temp < distance[v])
             {
-                distance[u_itr->destination] = temp;
-                predecesseur[u_itr->destination] = uStar;
+                if (distance[v] == infini) touches.push_back(v);
+                distance[v] = temp;
+                predecesseur[v] = uStar;
+                q.push(Entree(temp, v));
+                GTFS_STAT(++stats.insertionsFile);
             }
         }
     }
 
-    //cas où l'on n'a pas de solution
-    if (predecesseur[p_destination] == numeric_limits<unsigned int>::max())
+    GTFS_STAT(if (p_stats) *p_stats = stats);
+
+    p_chemin.clear();
+    for (size_t numero = arrivee; numero != aucun; numero = predecesseur[numero]) p_chemin.push_back(numero);
+    reverse(p_chemin.begin(), p_chemin.end());
+
+    for (size_t v : touches)
     {
-        p_chemin.clear();
-        p_chemin.push_back(p_destination);
-        return numeric_limits<unsigned int>::max();
+        distance[v] = infini;
+        predecesseur[v] = aucun;
+        coutCible[v] = infini;
     }
+    touches.clear();
+    return meilleur;
+}
 
-    //On a une solution, donc construire le plus court chemin à l'aide de predecesseur[]
-    p_chemin.clear();
-    stack<size_t> pileDuChemin;
-    size_t numero = p_destination;
-    pileDuChemin.push(numero);
-    while (predecesseur[numero] != numeric_limits<size_t>::max())
+//! \brief Algorithme de Dijkstra sans destination: l'arbre des plus courts chemins issus de p_racine
+//! (ou, si p_inverse, menant à p_racine), limité aux sommets à distance au plus p_borne
+//! \param[in] p_inverse: si vrai, la recherche suit les arcs à rebours; p_distance[v] est alors la longueur
+//! du plus court chemin de v à p_racine
+//! \param[in] p_borne: la recherche s'arrête dès que la plus petite distance provisoire dépasse p_borne
+//! (numeric_limits<unsigned int>::max(): tous les sommets atteignables)
+//! \param[out] p_distance: la distance de chaque sommet (numeric_limits<unsigned int>::max() si non atteint);
+//! seules les distances au plus p_borne sont définitives
+//! \param[out] p_parent: le sommet précédent (suivant si p_inverse) sur le chemin de chaque sommet atteint,
+//! numeric_limits<size_t>::max() pour p_racine et les sommets non atteints
+//! \param[in] p_complement: si non nul, un sommet v n'est atteint que si sa distance plus (*p_complement)[v]
+//! ne dépasse pas p_borne; typiquement les distances d'une recherche dans l'autre sens, ce qui limite la seconde
+//! recherche aux sommets d'un chemin de longueur au plus p_borne entre les deux racines
+//! \param[out] p_stats: si non nul, reçoit les compteurs de cette recherche (nuls si GTFS_STATS n'est pas défini)
+//! \note les tableaux appartiennent à l'appelant: plusieurs fils peuvent explorer le même graphe à la fois
+//! \note les relâchements se font dans le même ordre que plusCourtChemin(): le chemin de la racine à un sommet
+//! est celui que plusCourtChemin() retournerait. À rebours, les listes d'arcs entrants sont d'abord construites
+//! (en O(n + m), de l'ordre d'une recherche; seulement les arcs issus des sommets admis par p_complement)
+//! \throws logic_error lorsque p_racine n'existe pas
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::arbrePlusCourtsChemins(size_t p_racine, bool p_inverse, unsigned int p_borne,
+                                                    vector<unsigned int> &p_distance, vector<size_t> &p_parent,
+                                                    const vector<unsigned int> *p_complement,
+                                                    StatistiquesRecherche *p_stats) const
+{
+    if (p_stats) *p_stats = StatistiquesRecherche();
+    GTFS_STAT(StatistiquesRecherche stats);
+    const size_t n = m_premierArc.size();
+    if (p_racine >= n) throw logic_error("Graphe::arbrePlusCourtsChemins(): p_racine n'existe pas");
+    if (p_complement && p_complement->size() != n)
+        throw logic_error("Graphe::arbrePlusCourtsChemins(): p_complement doit couvrir tous les sommets");
+    p_distance.assign(n, numeric_limits<unsigned int>::max());
+    p_parent.assign(n, numeric_limits<size_t>::max());
+    p_distance[p_racine] = 0;
+
+    //à rebours: les arcs entrants de chaque sommet, contigus (origine et poids), dans l'ordre du bassin
+    vector<Sommet> debutEntrants, origineEntrant;
+    vector<Poids> poidsEntrant;
+    if (p_inverse)
     {
-        numero = predecesseur[numero];
-        pileDuChemin.push(numero);
+        debutEntrants.assign(n + 1, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (p_complement && (*p_complement)[i] > p_borne) continue; //arcs jamais relâchés
+            for (Sommet a = m_premierArc[i]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+                ++debutEntrants[m_destination[a] + 1];
+        }
+        for (size_t j = 0; j < n; ++j) debutEntrants[j + 1] += debutEntrants[j];
+        origineEntrant.resize(debutEntrants[n]);
+        poidsEntrant.resize(debutEntrants[n]);
+        vector<Sommet> place(debutEntrants.begin(), debutEntrants.end() - 1);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (p_complement && (*p_complement)[i] > p_borne) continue; //arcs jamais relâchés
+            for (Sommet a = m_premierArc[i]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+            {
+                Sommet b = place[m_destination[a]]++;
+                origineEntrant[b] = static_cast<Sommet>(i);
+                poidsEntrant[b] = m_poids[a];
+            }
+        }
     }
-    while (!pileDuChemin.empty())
+
+    typedef pair<unsigned int, Sommet> Entree;
+    priority_queue<Entree, vector<Entree>, greater<Entree> > q;
+    q.push(Entree(0, static_cast<Sommet>(p_racine)));
+    GTFS_STAT(++stats.insertionsFile);
+
+    while (!q.empty())
     {
-        p_chemin.push_back(pileDuChemin.top());
-        pileDuChemin.pop();
+        GTFS_STAT(stats.tailleMaxFile = std::max<unsigned long>(stats.tailleMaxFile, q.size()));
+        Entree e = q.top();
+        if (e.first > p_borne) break;
+        q.pop();
+        GTFS_STAT(++stats.retraitsFile);
+        Sommet uStar = e.second;
+        if (e.first != p_distance[uStar]) continue;
+        GTFS_STAT(++stats.sommetsFixes);
+
+        auto relacher = [&](Sommet v, Poids poids)
+        {
+            GTFS_STAT(++stats.arcsRelaches);
+            unsigned int temp = p_distance[uStar] + poids;
+            if (p_complement && ((*p_complement)[v] > p_borne || temp > p_borne - (*p_complement)[v])) return;
+            if (temp < p_distance[v])
+            {
+                p_distance[v] = temp;
+                p_parent[v] = uStar;
+                q.push(Entree(temp, v));
+                GTFS_STAT(++stats.insertionsFile);
+            }
+        };
+        if (p_inverse)
+            for (Sommet b = debutEntrants[uStar]; b < debutEntrants[uStar + 1]; ++b)
+                relacher(origineEntrant[b], poidsEntrant[b]);
+        else
+            for (Sommet a = m_premierArc[uStar]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+                relacher(m_destination[a], m_poids[a]);
     }
-    return distance[p_destination];
+
+    GTFS_STAT(if (p_stats) *p_stats = stats);
 }
 
+//! \brief Delta-stepping: les distances de p_racine à tous les sommets, calculées par p_nbFils fils d'exécution
+//! \param[in] p_largeurSeau: la largeur des seaux (dans l'unité des poids, des secondes pour ReseauGTFS)
+//! \param[in] p_nbFils: le nombre de fils d'exécution (0: autant que de coeurs)
+//! \param[out] p_distance: la distance de chaque sommet (numeric_limits<unsigned int>::max() si non atteint),
+//! identique à celle de arbrePlusCourtsChemins()
+//! \note les sommets sont rangés dans des seaux selon leur distance provisoire. Les seaux sont traités par ordre
+//! croissant; ceux d'un seau sont relâchés en parallèle (chaque fil prend des blocs de sa frontière, puis de
+//! celles des autres), par tours, jusqu'à ce qu'aucun sommet du seau ne soit amélioré. Les distances sont mises
+//! à jour par compare_exchange; chaque fil range les sommets améliorés dans ses propres seaux.
+//! Un seau large donne moins de tours (moins de barrières) mais plus de sommets relâchés plusieurs fois
+//! \note aucun prédécesseur n'est calculé: à distances égales, il dépendrait de l'ordre des fils
+//! \throws logic_error lorsque p_racine n'existe pas ou que p_largeurSeau est nulle
+template<typename Sommet, typename Poids>
+void GrapheT<Sommet, Poids>::distancesParSeaux(size_t p_racine, unsigned int p_largeurSeau, unsigned int p_nbFils,
+                                               vector<unsigned int> &p_distance) const
+{
+    const size_t n = m_premierArc.size();
+    if (p_racine >= n) throw logic_error("Graphe::distancesParSeaux(): p_racine n'existe pas");
+    if (p_largeurSeau == 0) throw logic_error("Graphe::distancesParSeaux(): la largeur des seaux doit être positive");
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    unique_ptr<atomic<unsigned int>[]> distance(new atomic<unsigned int>[n]);
+    unique_ptr<atomic<uint32_t>[]> tourDuSommet(new atomic<uint32_t>[n]); //le dernier tour où il a été mis en frontière
+    for (size_t v = 0; v < n; ++v)
+    {
+        distance[v].store(infini, memory_order_relaxed);
+        tourDuSommet[v].store(0, memory_order_relaxed);
+    }
+
+    struct Fil
+    {
+        vector<vector<Sommet> > seaux; //seaux[b]: sommets dont la distance est tombée dans [b, b + 1) * largeur
+        vector<Sommet> frontiere; //les sommets du tour courant
+        vector<Sommet> suivante; //les sommets du seau courant améliorés pendant ce tour
+        atomic<size_t> prochain; //le début du prochain bloc de frontiere à relâcher (partagé: les autres fils en volent)
+    };
+    vector<Fil> fils(p_nbFils);
+    for (auto &f : fils) f.prochain = 0;
+    distance[p_racine].store(0, memory_order_relaxed);
+    fils[0].seaux.assign(1, vector<Sommet>(1, static_cast<Sommet>(p_racine)));
+
+    //état partagé, modifié seulement par le fil 0 entre deux barrières
+    size_t seau = 0;
+    uint32_t tour = 1;
+    bool nouveauSeau = true, fini = false;
+    Barriere barriere(p_nbFils);
+    const size_t bloc = 256;
+
+    auto travailler = [&](unsigned int p_fil)
+    {
+        Fil &moi = fils[p_fil];
+        while (true)
+        {
+            //les sommets encore valides du nouveau seau forment la frontière de ce fil
+            if (nouveauSeau && seau < moi.seaux.size())
+            {
+                for (Sommet v : moi.seaux[seau])
+                    if (distance[v].load(memory_order_relaxed) / p_largeurSeau == seau &&
+                        tourDuSommet[v].exchange(tour, memory_order_relaxed) != tour)
+                        moi.frontiere.push_back(v);
+                vector<Sommet>().swap(moi.seaux[seau]);
+            }
+            barriere.attendre();
+
+            for (unsigned int k = 0; k < p_nbFils; ++k)
+            {
+                Fil &autre = fils[(p_fil + k) % p_nbFils];
+                const size_t taille = autre.frontiere.size();
+                for (size_t debut = autre.prochain.fetch_add(bloc); debut < taille; debut = autre.prochain.fetch_add(bloc))
+                    for (size_t x = debut; x < min(taille, debut + bloc); ++x)
+                    {
+                        Sommet u = autre.frontiere[x];
+                        const unsigned int du = distance[u].load(memory_order_relaxed);
+                        for (Sommet a = m_premierArc[u]; a != numeric_limits<Sommet>::max(); a = m_suivant[a])
+                        {
+                            Sommet v = m_destination[a];
+                            const unsigned int temp = du + m_poids[a];
+                            unsigned int dv = distance[v].load(memory_order_relaxed);
+                            bool ameliore = false;
+                            while (temp < dv && !ameliore)
+                                ameliore = distance[v].compare_exchange_weak(dv, temp, memory_order_relaxed);
+                            if (!ameliore) continue;
+                            const size_t b = temp / p_largeurSeau;
+                            if (b == seau)
+                            {
+                                if (tourDuSommet[v].exchange(tour + 1, memory_order_relaxed) != tour + 1)
+                                    moi.suivante.push_back(v);
+                            }
+                            else
+                            {
+                                if (b >= moi.seaux.size()) moi.seaux.resize(b + 1);
+                                moi.seaux[b].push_back(v);
+                            }
+                        }
+                    }
+            }
+            barriere.attendre();
+
+            //le fil 0 passe au tour suivant, ou au prochain seau non vide si le seau courant est terminé
+            if (p_fil == 0)
+            {
+                ++tour;
+                size_t taille = 0;
+                for (auto &f : fils)
+                {
+                    f.frontiere.swap(f.suivante);
+                    f.suivante.clear();
+                    f.prochain = 0;
+                    taille += f.frontiere.size();
+                }
+                nouveauSeau = taille == 0;
+                if (nouveauSeau)
+                {
+                    size_t prochainSeau = numeric_limits<size_t>::max();
+                    for (auto &f : fils)
+                        for (size_t b = seau + 1; b < min(prochainSeau, f.seaux.size()); ++b)
+                            if (!f.seaux[b].empty())
+                            {
+                                prochainSeau = b;
+                                break;
+                            }
+                    fini = prochainSeau == numeric_limits<size_t>::max();
+                    seau = prochainSeau;
+                }
+            }
+            barriere.attendre();
+            if (fini) return;
+        }
+    };
+    vector<thread> autres;
+    for (unsigned int f = 1; f < p_nbFils; ++f) autres.push_back(thread(travailler, f));
+    travailler(0);
+    for (auto &f : autres) f.join();
+
+    p_distance.resize(n);
+    for (size_t v = 0; v < n; ++v) p_distance[v] = distance[v].load(memory_order_relaxed);
+}
+
+//! \return la taille en octets d'un arc dans le bassin (destination, chaînage et poids)
+template<typename Sommet, typename Poids>
+size_t GrapheT<Sommet, Poids>::getTailleArc() const
+{
+    return 2 * sizeof(Sommet) + sizeof(Poids);
+}
+
+template class GrapheT<size_t, unsigned int>;
+template class GrapheT<uint32_t, uint32_t>;
+template class GrapheT<uint32_t, uint16_t>;
+
+//! \brief crée le graphe le plus compact pouvant contenir p_nbSommets sommets et des arcs de poids au plus p_poidsMax
+//! \param[in] p_largeur: impose une largeur plutôt que de la choisir (automatique)
+//! \return Graphe16 si les poids tiennent sur 16 bits, sinon Graphe32, sinon Graphe (size_t, unsigned int)
+//! \throws logic_error si la largeur imposée ne peut contenir p_nbSommets sommets ou p_poidsMax
+unique_ptr<GrapheAbstrait> creerGraphe(size_t p_nbSommets, unsigned int p_poidsMax, LargeurGraphe p_largeur)
+{
+    bool sommets32 = p_nbSommets < numeric_limits<uint32_t>::max();
+    bool poids16 = p_poidsMax < numeric_limits<uint16_t>::max();
+    if (p_largeur == LargeurGraphe::automatique)
+        p_largeur = !sommets32 ? LargeurGraphe::etendue : (poids16 ? LargeurGraphe::poids16 : LargeurGraphe::poids32);
+    if ((p_largeur == LargeurGraphe::poids32 || p_largeur == LargeurGraphe::poids16) && !sommets32)
+        throw logic_error("creerGraphe(): trop de sommets pour des numéros de 32 bits");
+    if (p_largeur == LargeurGraphe::poids16 && !poids16)
+        throw logic_error("creerGraphe(): poids trop grands pour 16 bits");
+    switch (p_largeur)
+    {
+        case LargeurGraphe::poids16: return unique_ptr<GrapheAbstrait>(new Graphe16(p_nbSommets));
+        case LargeurGraphe::poids32: return unique_ptr<GrapheAbstrait>(new Graphe32(p_nbSommets));
+        default: return unique_ptr<GrapheAbstrait>(new Graphe(p_nbSommets));
+    }
+}
@@ -9,41 +9,124 @@
 #define GRAPH_H
 
 #include <vector>
-#include <list>
 #include <stack>
 #include <limits>
 #include <iostream>
 #include <algorithm>
+#include <queue>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+#include "statistiques.h"
+#include "memoire.h"
+
+//! \brief Les tableaux de travail d'une recherche fournis par l'appelant (un par fil d'exécution), pour que
+//! plusieurs recherches puissent parcourir le même graphe en même temps
+//! \note ils gardent la taille du graphe d'une recherche à l'autre: seuls les sommets touchés sont remis à l'état
+//! initial à la fin d'une recherche, au lieu de tout le tableau
+struct EspaceRecherche
+{
+	std::vector<unsigned int> distance; //!< max() si non atteint
+	std::vector<size_t> predecesseur; //!< max() si aucun
+	std::vector<unsigned int> coutCible; //!< le coût ajouté à la distance d'un sommet cible (max() pour les autres)
+	std::vector<size_t> touches; //!< les sommets dont distance[] ou coutCible[] a changé
+};
+
+//! \brief Interface commune des graphes, quelle que soit la largeur des numéros de sommets et des poids
+//! \note les paramètres sont toujours en size_t et unsigned int; chaque implémentation vérifie qu'ils tiennent
+//! dans ses propres types
+class GrapheAbstrait
+{
+public:
+	virtual ~GrapheAbstrait() {}
+	virtual void resize(size_t) = 0;
+	virtual void ajouterArc(size_t i, size_t j, unsigned int poids) = 0;
+	virtual void enleverArc(size_t i, size_t j) = 0;
+	virtual unsigned int getPoids(size_t i, size_t j) const = 0;
+	virtual void getArcsSortants(size_t i, std::vector<std::pair<size_t, unsigned int> > & p_arcs) const = 0;
+	virtual size_t getNbSommets() const = 0;
+	virtual void renumeroter(const std::vector<size_t> & p_nouveauNumero) = 0;
+	virtual unsigned int plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> & p_chemin,
+	                                     EspaceRecherche & p_espace, StatistiquesRecherche * p_stats = nullptr) const = 0;
+	virtual unsigned int plusCourtCheminMultiple(const std::vector<std::pair<size_t, unsigned int> > & p_sources,
+	                                             const std::vector<std::pair<size_t, unsigned int> > & p_cibles,
+	                                             std::vector<size_t> & p_chemin, EspaceRecherche & p_espace,
+	                                             StatistiquesRecherche * p_stats = nullptr) const = 0;
+	virtual void arbrePlusCourtsChemins(size_t p_racine, bool p_inverse, unsigned int p_borne,
+	                                    std::vector<unsigned int> & p_distance, std::vector<size_t> & p_parent,
+	                                    const std::vector<unsigned int> * p_complement = nullptr,
+	                                    StatistiquesRecherche * p_stats = nullptr) const = 0;
+	virtual void distancesParSeaux(size_t p_racine, unsigned int p_largeurSeau, unsigned int p_nbFils,
+	                               std::vector<unsigned int> & p_distance) const = 0;
+	virtual size_t getTailleArc() const = 0;
+	virtual void reserverArcs(size_t) = 0;
+	virtual void mesurerMemoire(RapportMemoire &) const = 0;
+};
 
 //! \brief  Classe pour graphes orientés pondérés (non négativement) avec listes d'adjacence
-class Graphe
+//! \note les listes d'adjacence sont chaînées par indices dans un bassin d'arcs contigu (un vecteur par champ):
+//! aucune allocation par arc, et la destruction du graphe libère quelques vecteurs plutôt qu'un noeud par arc
+//! \tparam Sommet: le type entier non signé des numéros de sommets et des indices d'arcs (sa valeur maximale est réservée)
+//! \tparam Poids: le type entier non signé des poids des arcs; les distances sont toujours en unsigned int
+//! \note instanciations disponibles (graphe.cpp): Graphe, Graphe32 et Graphe16
+template<typename Sommet, typename Poids>
+class GrapheT : public GrapheAbstrait
 {
 public:
 
-	Graphe(size_t = 0);
+	GrapheT(size_t = 0);
     void resize(size_t);
 	void ajouterArc(size_t i, size_t j, unsigned int poids);
 	void enleverArc(size_t i, size_t j);
 	unsigned int getPoids(size_t i, size_t j) const;
+	void getArcsSortants(size_t i, std::vector<std::pair<size_t, unsigned int> > & p_arcs) const;
 	size_t getNbSommets() const;
+	void renumeroter(const std::vector<size_t> & p_nouveauNumero);
+
+    unsigned int plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> & p_chemin,
+                                 EspaceRecherche & p_espace, StatistiquesRecherche * p_stats = nullptr) const;
+    unsigned int plusCourtCheminMultiple(const std::vector<std::pair<size_t, unsigned int> > & p_sources,
+                                         const std::vector<std::pair<size_t, unsigned int> > & p_cibles,
+                                         std::vector<size_t> & p_chemin, EspaceRecherche & p_espace,
+                                         StatistiquesRecherche * p_stats = nullptr) const;
+    void arbrePlusCourtsChemins(size_t p_racine, bool p_inverse, unsigned int p_borne,
+                                std::vector<unsigned int> & p_distance, std::vector<size_t> & p_parent,
+                                const std::vector<unsigned int> * p_complement = nullptr,
+                                StatistiquesRecherche * p_stats = nullptr) const;
+    void distancesParSeaux(size_t p_racine, unsigned int p_largeurSeau, unsigned int p_nbFils,
+                           std::vector<unsigned int> & p_distance) const;
 
-    unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
-                             std::vector<size_t> & p_chemin) const;
+	size_t getTailleArc() const;
+	void reserverArcs(size_t);
+	void mesurerMemoire(RapportMemoire &) const;
 
 private:
 
-	struct Arc
-	{
-		Arc(size_t dest, unsigned int p) :
-				destination(dest), poids(p)
-		{
-		}
-		size_t destination;
-		unsigned int poids;
-	};
+	Sommet nouvelArc();
+	void libererArc(Sommet);
 
-	std::vector<std::list<Arc> > m_listesAdj; /*!< les listes d'adjacence */
+	std::vector<Sommet> m_premierArc; /*!< m_premierArc[i]: le premier arc sortant du sommet i (max() si aucun) */
+	std::vector<Sommet> m_dernierArc; /*!< m_dernierArc[i]: le dernier arc sortant du sommet i (max() si aucun) */
+	std::vector<Sommet> m_destination; /*!< le bassin d'arcs: m_destination[a] est le sommet destination de l'arc a */
+	std::vector<Sommet> m_suivant; /*!< m_suivant[a]: l'arc suivant dans la même liste (ou dans la chaîne des arcs libres) */
+	std::vector<Poids> m_poids; /*!< m_poids[a]: le poids de l'arc a */
+	Sommet m_arcsLibres; /*!< la chaîne des arcs enlevés, réutilisés par ajouterArc() */
 
 };
 
+typedef GrapheT<size_t, unsigned int> Graphe; //!< les largeurs d'origine
+typedef GrapheT<uint32_t, uint32_t> Graphe32; //!< moins de 2^32 - 1 sommets
+typedef GrapheT<uint32_t, uint16_t> Graphe16; //!< moins de 2^32 - 1 sommets et des poids inférieurs à 65535
+
+extern template class GrapheT<size_t, unsigned int>;
+extern template class GrapheT<uint32_t, uint32_t>;
+extern template class GrapheT<uint32_t, uint16_t>;
+
+//! \brief choix explicite de la largeur d'un graphe (voir creerGraphe())
+enum class LargeurGraphe { automatique, etendue, poids32, poids16 };
+
+std::unique_ptr<GrapheAbstrait> creerGraphe(size_t p_nbSommets, unsigned int p_poidsMax,
+                                            LargeurGraphe p_largeur = LargeurGraphe::automatique);
+
 #endif  //GRAPH_H
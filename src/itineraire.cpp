@@ -0,0 +1,276 @@
+//
+//  itineraire.cpp
+//  Décodage, affichage et rendu JSON des itinéraires
+//
+
+#include "itineraire.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+const uint32_t Troncon::aucunVoyage;
+const unsigned int Troncon::stationOrigine;
+const unsigned int Troncon::stationDestination;
+
+namespace
+{
+    Troncon tronconMarche(unsigned int p_stationDepart, unsigned int p_stationArrivee, unsigned int p_heureDepart,
+                          unsigned int p_heureArrivee)
+    {
+        Troncon t;
+        t.mode = Troncon::MARCHE;
+        t.stationDepart = p_stationDepart;
+        t.stationArrivee = p_stationArrivee;
+        t.ligne = 0;
+        t.voyage = Troncon::aucunVoyage;
+        t.heureDepart = p_heureDepart;
+        t.heureArrivee = p_heureArrivee;
+        return t;
+    }
+
+    unsigned int tempsABord(const Itineraire &p_itineraire)
+    {
+        unsigned int total = 0;
+        for (auto &t : p_itineraire.troncons)
+            if (t.mode == Troncon::AUTOBUS) total += t.heureArrivee - t.heureDepart;
+        return total;
+    }
+}
+
+//! \brief Convertit un chemin d'un réseau horaire en itinéraire
+//! \param[in] p_sommets: les stations, voyages et heures des sommets du chemin
+//! \param[in] p_chemin: les sommets du chemin, du point origine au point destination
+//! \param[in] p_tempsDuTrajet: la longueur du chemin (numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[in] p_heureDepart: l'heure de départ du point origine, en secondes depuis minuit
+//! \param[in] p_origine, p_destination: les numéros des points origine et destination dans p_chemin (des sommets
+//! du réseau, ou des numéros hors du réseau pour une requête qui ne les y ajoute pas)
+//! \throws logic_error si le chemin est incohérent
+//! \note n'utilise que les tableaux indexés par sommet (aucune recherche par identifiant ni copie de chaîne)
+Itineraire decoderChemin(const SommetsHoraires &p_sommets, const vector<size_t> &p_chemin, unsigned int p_tempsDuTrajet,
+                         unsigned int p_heureDepart, size_t p_origine, size_t p_destination)
+{
+    auto station = [&](size_t p_sommet) {
+        return p_sommet == p_origine ? Troncon::stationOrigine
+             : p_sommet == p_destination ? Troncon::stationDestination : p_sommets.stationDuSommet(p_sommet);
+    };
+    auto voyage = [&](size_t p_sommet) {
+        return p_sommet == p_origine || p_sommet == p_destination ? Troncon::aucunVoyage
+                                                                  : p_sommets.voyageDuSommet(p_sommet);
+    };
+
+    Itineraire resultat;
+    resultat.heureDepart = p_heureDepart;
+    resultat.duree = p_tempsDuTrajet;
+    resultat.atteignable = p_tempsDuTrajet != numeric_limits<unsigned int>::max();
+    if (!resultat.atteignable || p_tempsDuTrajet == 0) return resultat;
+
+    //un chemin non trivial a été trouvé; le sommet de sortie qui précède le point destination n'est pas un arrêt
+    vector<size_t> chemin(p_chemin);
+    if (chemin.size() >= 2 && p_sommets.estSommetSortie(chemin[chemin.size() - 2])) chemin.erase(chemin.end() - 2);
+    if (chemin.size() <= 2)
+        throw logic_error("decoderChemin(): un chemin non trivial doit contenir au moins 3 sommets");
+    if (station(chemin[0]) != Troncon::stationOrigine)
+        throw logic_error("decoderChemin(): le premier noeud du chemin doit être le point origine");
+    if (station(chemin[chemin.size() - 1]) != Troncon::stationDestination)
+        throw logic_error("decoderChemin(): le dernier noeud du chemin doit être le point destination");
+
+    size_t a = chemin[0];
+    size_t b = chemin[1];
+    resultat.troncons.push_back(
+        tronconMarche(Troncon::stationOrigine, station(b), p_heureDepart, p_sommets.heureDuSommet(b)));
+
+    size_t sommet = 1;
+
+    while (sommet < chemin.size() - 1)
+    {
+        a = b;
+        b = chemin.at(++sommet);
+        while (station(b) == station(a))
+        {
+            a = b;
+            b = chemin.at(++sommet);
+        }
+        //on a changé de station
+        if (station(b) == Troncon::stationDestination) //cas où on est arrivé à la destination
+        {
+            if (sommet != chemin.size() - 1)
+                throw logic_error(
+                    "decoderChemin(): incohérence de fin de chemin lors d'un changement de station");
+            break;
+        }
+        if (sommet == chemin.size() - 1)
+            throw logic_error("decoderChemin(): on ne devrait pas être arrivé à destination");
+        //on a changé de station mais sommet n'est pas le noeud destination
+        if (voyage(a) != voyage(b)) //on a changé de station à pieds
+        {
+            resultat.troncons.push_back(
+                tronconMarche(station(a), station(b), p_sommets.heureDuSommet(a), p_sommets.heureDuSommet(b)));
+        }
+        else //on a changé de station avec un voyage
+        {
+            size_t montee = a;
+            //maintenant allons à la dernière station de ce voyage
+            a = b;
+            b = chemin.at(++sommet);
+            while (voyage(b) == voyage(a))
+            {
+                a = b;
+                b = chemin.at(++sommet);
+            }
+            //on a changé de voyage
+            Troncon trajet;
+            trajet.mode = Troncon::AUTOBUS;
+            trajet.stationDepart = station(montee);
+            trajet.stationArrivee = station(a);
+            trajet.voyage = voyage(a);
+            trajet.ligne = p_sommets.ligneDuVoyage(trajet.voyage);
+            trajet.heureDepart = p_sommets.heureDuSommet(montee);
+            trajet.heureArrivee = p_sommets.heureDuSommet(a);
+            resultat.troncons.push_back(trajet);
+            if (station(b) == Troncon::stationDestination) //cas où on est arrivé à la destination
+            {
+                if (sommet != chemin.size() - 1)
+                    throw logic_error(
+                        "decoderChemin(): incohérence de fin de chemin lors d'u changement de voyage");
+                break;
+            }
+            if (station(a) != station(b)) //alors on s'est rendu à pieds à l'autre station
+                resultat.troncons.push_back(
+                    tronconMarche(station(a), station(b), p_sommets.heureDuSommet(a), p_sommets.heureDuSommet(b)));
+        }
+    }
+
+    size_t derniereStation = chemin[chemin.size() - 2];
+    resultat.troncons.push_back(tronconMarche(station(derniereStation), Troncon::stationDestination,
+                                              p_sommets.heureDuSommet(derniereStation),
+                                              p_heureDepart + p_tempsDuTrajet));
+    return resultat;
+}
+
+//! \brief Mesure à quel point deux itinéraires empruntent les mêmes voyages
+//! \return le temps passé à bord des mêmes voyages aux mêmes heures (le segment commun d'un voyage emprunté
+//! par les deux), divisé par le plus petit des deux temps à bord: 0 si aucun voyage n'est partagé, 1 si l'un
+//! des itinéraires ne fait que suivre une partie des voyages de l'autre
+//! \note deux itinéraires sans autobus sont identiques (1); un itinéraire sans autobus ne ressemble à aucun autre (0)
+double similariteVoyages(const Itineraire &p_a, const Itineraire &p_b)
+{
+    unsigned int aBordA = tempsABord(p_a), aBordB = tempsABord(p_b);
+    if (aBordA == 0 || aBordB == 0) return aBordA == aBordB ? 1.0 : 0.0;
+    unsigned int commun = 0;
+    for (auto &ta : p_a.troncons)
+    {
+        if (ta.mode != Troncon::AUTOBUS) continue;
+        for (auto &tb : p_b.troncons)
+            if (tb.mode == Troncon::AUTOBUS && tb.voyage == ta.voyage)
+            {
+                unsigned int debut = max(ta.heureDepart, tb.heureDepart), fin = min(ta.heureArrivee, tb.heureArrivee);
+                if (fin > debut) commun += fin - debut;
+            }
+    }
+    return static_cast<double>(commun) / min(aBordA, aBordB);
+}
+
+//! \brief Affiche un itinéraire
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire le réseau
+//! \param[in] p_idDuVoyage: le trip_id de chaque indice de voyage du réseau
+//! \param[in] p_itineraire: l'itinéraire à afficher
+//! \param[in] p_flux: le flux de sortie
+void afficherItineraire(const DonneesGTFS &p_gtfs, const vector<string> &p_idDuVoyage, const Itineraire &p_itineraire,
+                        ostream &p_flux)
+{
+    if (!p_itineraire.atteignable)
+    {
+        p_flux << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps" << endl;
+        return;
+    }
+
+    if (p_itineraire.troncons.empty())
+    {
+        p_flux << "Vous êtes déjà situé à la destination demandée" << endl;
+        return;
+    }
+
+    const Heure minuit(0, 0, 0);
+
+    p_flux << endl;
+    p_flux << "=====================" << endl;
+    p_flux << "     ITINÉRAIRE      " << endl;
+    p_flux << "=====================" << endl;
+    p_flux << endl;
+
+    p_flux << "Heure de départ du point d'origine: " << minuit.add_secondes(p_itineraire.heureDepart) << endl;
+    for (size_t i = 0; i < p_itineraire.troncons.size(); ++i)
+    {
+        const Troncon &t = p_itineraire.troncons[i];
+        if (t.mode == Troncon::AUTOBUS)
+        {
+            const Voyage &voyage = p_gtfs.getVoyages().at(p_idDuVoyage[t.voyage]);
+            p_flux << "De cette station, prenez l'autobus numéro " << p_gtfs.getLignes().at(t.ligne).getNumero()
+            << " à l'heure " << minuit.add_secondes(t.heureDepart) << " " << voyage << endl;
+            p_flux << "et arrêtez-vous à la station " << p_gtfs.getStations().at(t.stationArrivee) << " à l'heure "
+            << minuit.add_secondes(t.heureArrivee) << endl;
+        }
+        else if (i == 0)
+            p_flux << "Rendez vous à la station " << p_gtfs.getStations().at(t.stationArrivee) << endl;
+        else if (i == p_itineraire.troncons.size() - 1) //le dernier tronçon mène toujours au point destination
+        {
+            p_flux << "Déplacez-vous à pieds de cette station au point destination" << endl;
+            p_flux << "Heure d'arrivée à la destination: "
+            << minuit.add_secondes(p_itineraire.heureDepart + p_itineraire.duree) << endl;
+        }
+        else
+            p_flux << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(t.stationArrivee)
+            << endl;
+    }
+
+    unsigned int h = p_itineraire.duree / 3600;
+    unsigned int reste_sec = p_itineraire.duree % 3600;
+    unsigned int m = reste_sec / 60;
+    unsigned int s = reste_sec % 60;
+    p_flux << "Durée du trajet: " << h << " heures, " << m << " minutes, " << s << " secondes" << endl;
+}
+
+//! \brief écrit une chaîne JSON en échappant les guillemets, les barres obliques inverses et les caractères de contrôle
+void ecrireChaineJSON(const string &p_chaine, ostream &p_flux)
+{
+    p_flux << '"';
+    for (char c : p_chaine)
+    {
+        if (c == '"' || c == '\\') p_flux << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) p_flux << ' ';
+        else p_flux << c;
+    }
+    p_flux << '"';
+}
+
+//! \brief Écrit un itinéraire en JSON (sur une seule ligne)
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire le réseau (pour les numéros de ligne)
+//! \param[in] p_idDuVoyage: le trip_id de chaque indice de voyage du réseau
+//! \param[in] p_itineraire: l'itinéraire à écrire
+//! \param[in] p_flux: le flux de sortie
+void ecrireItineraireJSON(const DonneesGTFS &p_gtfs, const vector<string> &p_idDuVoyage, const Itineraire &p_itineraire,
+                          ostream &p_flux)
+{
+    p_flux << "{\"atteignable\":" << (p_itineraire.atteignable ? "true" : "false")
+    << ",\"heureDepart\":" << p_itineraire.heureDepart;
+    if (p_itineraire.atteignable) p_flux << ",\"duree\":" << p_itineraire.duree;
+    p_flux << ",\"troncons\":[";
+    for (size_t i = 0; i < p_itineraire.troncons.size(); ++i)
+    {
+        const Troncon &t = p_itineraire.troncons[i];
+        if (i != 0) p_flux << ',';
+        p_flux << "{\"mode\":" << (t.mode == Troncon::AUTOBUS ? "\"autobus\"" : "\"marche\"")
+        << ",\"stationDepart\":" << t.stationDepart << ",\"stationArrivee\":" << t.stationArrivee;
+        if (t.mode == Troncon::AUTOBUS)
+        {
+            p_flux << ",\"ligne\":";
+            ecrireChaineJSON(p_gtfs.getLignes().at(t.ligne).getNumero(), p_flux);
+            p_flux << ",\"voyage\":";
+            ecrireChaineJSON(p_idDuVoyage[t.voyage], p_flux);
+        }
+        p_flux << ",\"heureDepart\":" << t.heureDepart << ",\"heureArrivee\":" << t.heureArrivee << '}';
+    }
+    p_flux << "]}";
+}
@@ -0,0 +1,71 @@
+//
+//  itineraire.h
+//  Résultat structuré d'une requête origine/destination (ReseauGTFS, ReseauStations, TranchesHoraires)
+//
+
+#ifndef TP2_ITINERAIRE_H
+#define TP2_ITINERAIRE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <iostream>
+
+#include "DonneesGTFS.h"
+
+//! \brief Une étape d'un itinéraire: un déplacement à pieds ou un trajet en autobus
+//! \note les heures sont en secondes depuis minuit (elles peuvent dépasser 24h, comme Heure)
+//! \note stationDepart et stationArrivee valent stationOrigine et stationDestination pour les points origine et
+//! destination
+struct Troncon
+{
+    enum Mode : uint8_t { MARCHE, AUTOBUS };
+
+    static const uint32_t aucunVoyage = std::numeric_limits<uint32_t>::max();
+    static const unsigned int stationOrigine = 0; //le stationId du point origine (réservé: aucune station ne l'a)
+    static const unsigned int stationDestination = 1; //celui du point destination
+
+    Mode mode;
+    unsigned int stationDepart;
+    unsigned int stationArrivee;
+    unsigned int ligne; //l'identifiant (route_id) de la ligne, seulement pour un trajet en autobus
+    uint32_t voyage; //l'indice du voyage dans le réseau (aucunVoyage pour un déplacement à pieds)
+    unsigned int heureDepart;
+    unsigned int heureArrivee;
+};
+
+//! \brief Un itinéraire complet du point origine au point destination
+//! \note un itinéraire atteignable de durée nulle et sans tronçon signifie qu'on est déjà à destination
+struct Itineraire
+{
+    bool atteignable;
+    unsigned int heureDepart; //en secondes depuis minuit
+    unsigned int duree; //en secondes
+    std::vector<Troncon> troncons;
+};
+
+//! \brief Ce que decoderChemin() lit des sommets d'un réseau horaire (ReseauGTFS, TranchesHoraires)
+//! \note un sommet est un arrêt (une station, un voyage, une heure d'arrivée) ou le sommet de sortie d'une station
+class SommetsHoraires
+{
+public:
+    virtual ~SommetsHoraires() {}
+    virtual bool estSommetSortie(size_t) const = 0;
+    virtual unsigned int stationDuSommet(size_t) const = 0; //le stationId
+    virtual uint32_t voyageDuSommet(size_t) const = 0;
+    virtual unsigned int heureDuSommet(size_t) const = 0; //en secondes depuis minuit
+    virtual unsigned int ligneDuVoyage(uint32_t) const = 0;
+};
+
+Itineraire decoderChemin(const SommetsHoraires &p_sommets, const std::vector<size_t> &p_chemin,
+                         unsigned int p_tempsDuTrajet, unsigned int p_heureDepart, size_t p_origine,
+                         size_t p_destination);
+double similariteVoyages(const Itineraire &p_a, const Itineraire &p_b);
+void afficherItineraire(const DonneesGTFS &p_gtfs, const std::vector<std::string> &p_idDuVoyage,
+                        const Itineraire &p_itineraire, std::ostream &p_flux = std::cout);
+void ecrireChaineJSON(const std::string &p_chaine, std::ostream &p_flux);
+void ecrireItineraireJSON(const DonneesGTFS &p_gtfs, const std::vector<std::string> &p_idDuVoyage,
+                          const Itineraire &p_itineraire, std::ostream &p_flux);
+
+#endif //TP2_ITINERAIRE_H
@@ -0,0 +1,235 @@
+//
+//  lotRequetes.cpp
+//  Rejeu en lot de requêtes origine/destination lues d'un fichier, sur un réseau partagé par plusieurs fils
+//
+
+#include "lotRequetes.h"
+#include "statistiques.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+const size_t LotRequetes::tailleBloc;
+
+RapportLot::RapportLot()
+    : requetes(0), erreurs(0), inatteignables(0), nbFils(0), duree(0), calcul(0)
+{
+}
+
+ostream &operator<<(ostream &p_flux, const RapportLot &p_rapport)
+{
+    p_flux << p_rapport.requetes << " requêtes (" << p_rapport.erreurs << " erreurs, " << p_rapport.inatteignables
+           << " inatteignables) en " << p_rapport.duree << " us avec " << p_rapport.nbFils << " fils, calcul: "
+           << p_rapport.calcul << " us";
+    if (p_rapport.duree > 0)
+        p_flux << ", " << static_cast<long>(p_rapport.requetes * 1e6 / p_rapport.duree) << " requêtes/s";
+    return p_flux;
+}
+
+//! \param[in] p_gtfs: les données ayant servi à construire p_reseau; les deux doivent survivre au lot
+LotRequetes::LotRequetes(const DonneesGTFS &p_gtfs, const ReseauGTFS &p_reseau)
+    : m_gtfs(p_gtfs), m_reseau(p_reseau)
+{
+}
+
+//! \brief traite toutes les requêtes de p_entree et écrit leurs itinéraires dans p_sortie, dans le même ordre
+//! \param[in] p_nbFils: le nombre de fils de calcul (0: autant que de coeurs), en plus des fils de lecture et
+//! d'écriture
+//! \param[in] p_blocsEnVol: le nombre maximal de blocs en mémoire à la fois (0: 4 par fil de calcul)
+//! \return le bilan du lot
+//! \throws logic_error si la lecture ou l'écriture échoue (la sortie est alors incomplète); une requête
+//! invalide n'arrête pas le lot
+RapportLot LotRequetes::traiter(istream &p_entree, ostream &p_sortie, unsigned int p_nbFils, size_t p_blocsEnVol) const
+{
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+    if (p_blocsEnVol == 0) p_blocsEnVol = 4 * p_nbFils;
+
+    struct Bloc
+    {
+        vector<string> lignes;
+        string sortie;
+        size_t inatteignables = 0;
+        size_t erreurs = 0;
+    };
+    typedef pair<size_t, unique_ptr<Bloc> > Travail; //(numéro du bloc dans l'ordre de lecture, bloc)
+
+    mutex verrou;
+    condition_variable lu; //un bloc attend un fil de calcul, ou la lecture est finie
+    condition_variable calcule; //un bloc attend d'être écrit, ou la lecture est finie
+    condition_variable ecrit; //un bloc a été écrit: le lecteur peut en lire un autre
+    deque<Travail> aCalculer;
+    map<size_t, unique_ptr<Bloc> > aEcrire;
+    size_t nbLus = 0, nbEcrits = 0;
+    bool finLecture = false, abandon = false;
+    exception_ptr erreurLecture;
+    atomic<long> calcul(0);
+    Chronometre chronometre;
+
+    thread lecteur([&]()
+    {
+        try
+        {
+            string ligne;
+            while (true)
+            {
+                unique_ptr<Bloc> bloc(new Bloc);
+                while (bloc->lignes.size() < tailleBloc && getline(p_entree, ligne))
+                {
+                    if (!ligne.empty() && ligne.back() == '\r') ligne.pop_back();
+                    if (ligne.empty() || ligne[0] == '#') continue;
+                    bloc->lignes.push_back(ligne);
+                }
+                if (bloc->lignes.empty()) break;
+                unique_lock<mutex> v(verrou);
+                ecrit.wait(v, [&]() { return abandon || nbLus - nbEcrits < p_blocsEnVol; });
+                if (abandon) break;
+                aCalculer.push_back(Travail(nbLus++, move(bloc)));
+                lu.notify_one();
+            }
+        }
+        catch (...)
+        {
+            erreurLecture = current_exception();
+        }
+        lock_guard<mutex> v(verrou);
+        finLecture = true;
+        lu.notify_all();
+        calcule.notify_all();
+    });
+
+    auto calculer = [&]()
+    {
+        EspaceRequete espace;
+        while (true)
+        {
+            Travail travail;
+            {
+                unique_lock<mutex> v(verrou);
+                lu.wait(v, [&]() { return abandon || finLecture || !aCalculer.empty(); });
+                if (abandon || aCalculer.empty()) return;
+                travail = move(aCalculer.front());
+                aCalculer.pop_front();
+            }
+            Chronometre chronometreBloc;
+            Bloc &bloc = *travail.second;
+            ostringstream sortie;
+            for (const string &ligne : bloc.lignes)
+            {
+                try
+                {
+                    if (!repondre(ligne, espace, sortie)) ++bloc.inatteignables;
+                }
+                catch (const exception &e)
+                {
+                    sortie << "{\"erreur\":";
+                    ecrireChaineJSON(e.what(), sortie);
+                    sortie << "}\n";
+                    ++bloc.erreurs;
+                }
+            }
+            bloc.sortie = sortie.str();
+            calcul += chronometreBloc.ecoule();
+            lock_guard<mutex> v(verrou);
+            aEcrire.insert(move(travail));
+            calcule.notify_one();
+        }
+    };
+    vector<thread> fils;
+    for (unsigned int f = 0; f < p_nbFils; ++f) fils.push_back(thread(calculer));
+
+    //l'écriture, dans le fil appelant: toujours le bloc suivant dans l'ordre de lecture
+    RapportLot rapport;
+    rapport.nbFils = p_nbFils;
+    bool echecEcriture = false;
+    while (true)
+    {
+        unique_ptr<Bloc> bloc;
+        {
+            unique_lock<mutex> v(verrou);
+            calcule.wait(v, [&]() { return aEcrire.count(nbEcrits) || (finLecture && nbEcrits == nbLus); });
+            auto prochain = aEcrire.find(nbEcrits);
+            if (prochain == aEcrire.end()) break;
+            bloc = move(prochain->second);
+            aEcrire.erase(prochain);
+        }
+        p_sortie << bloc->sortie;
+        rapport.requetes += bloc->lignes.size();
+        rapport.erreurs += bloc->erreurs;
+        rapport.inatteignables += bloc->inatteignables;
+        lock_guard<mutex> v(verrou);
+        if (!p_sortie)
+        {
+            echecEcriture = abandon = true;
+            lu.notify_all();
+            ecrit.notify_all();
+            break;
+        }
+        ++nbEcrits;
+        ecrit.notify_one();
+    }
+    p_sortie.flush();
+
+    lecteur.join();
+    for (auto &f : fils) f.join();
+    if (erreurLecture) rethrow_exception(erreurLecture);
+    if (p_entree.bad()) throw logic_error("LotRequetes::traiter(): erreur de lecture des requêtes");
+    if (echecEcriture || !p_sortie) throw logic_error("LotRequetes::traiter(): erreur d'écriture des itinéraires");
+    rapport.duree = chronometre.ecoule();
+    rapport.calcul = calcul;
+    return rapport;
+}
+
+//! \brief traite le fichier de requêtes p_entree et écrit les itinéraires dans le fichier p_sortie
+//! \throws logic_error si un des fichiers ne peut être ouvert, ou comme traiter(istream &, ostream &)
+RapportLot LotRequetes::traiter(const string &p_entree, const string &p_sortie, unsigned int p_nbFils) const
+{
+    ifstream entree(p_entree);
+    if (!entree) throw logic_error("LotRequetes::traiter(): impossible d'ouvrir " + p_entree);
+    ofstream sortie(p_sortie);
+    if (!sortie) throw logic_error("LotRequetes::traiter(): impossible de créer " + p_sortie);
+    return traiter(entree, sortie, p_nbFils);
+}
+
+//! \brief répond à une requête et écrit son itinéraire en JSON, suivi d'une fin de ligne
+//! \return vrai si la destination est atteignable
+//! \throws logic_error si la ligne est mal formée, ou si ReseauGTFS::calculerItineraire() refuse la requête
+bool LotRequetes::repondre(const string &p_ligne, EspaceRequete &p_espace, ostream &p_flux) const
+{
+    double valeurs[4];
+    const char *debut = p_ligne.c_str();
+    for (double &valeur : valeurs)
+    {
+        char *fin;
+        valeur = strtod(debut, &fin);
+        if (fin == debut || *fin != ',') throw logic_error("LotRequetes: ligne mal formée: " + p_ligne);
+        debut = fin + 1;
+    }
+    unsigned int heures, minutes, secondes;
+    char reste;
+    if (sscanf(debut, "%u:%u:%u %c", &heures, &minutes, &secondes, &reste) != 3 || minutes >= 60 || secondes >= 60)
+        throw logic_error("LotRequetes: heure mal formée: " + p_ligne);
+    if (!Coordonnees::is_valide_coord(valeurs[0], valeurs[1]) || !Coordonnees::is_valide_coord(valeurs[2], valeurs[3]))
+        throw logic_error("LotRequetes: coordonnées invalides: " + p_ligne);
+
+    Itineraire itineraire = m_reseau.calculerItineraire(m_gtfs, Coordonnees(valeurs[0], valeurs[1]),
+                                                        Coordonnees(valeurs[2], valeurs[3]),
+                                                        Heure(heures, minutes, secondes), p_espace);
+    m_reseau.ecrireItineraireJSON(m_gtfs, itineraire, p_flux);
+    p_flux << '\n';
+    return itineraire.atteignable;
+}
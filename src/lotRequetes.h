@@ -0,0 +1,59 @@
+//
+//  lotRequetes.h
+//  Rejeu en lot de requêtes origine/destination lues d'un fichier, sur un réseau partagé par plusieurs fils
+//
+
+#ifndef TP2_LOTREQUETES_H
+#define TP2_LOTREQUETES_H
+
+#include <string>
+#include <iostream>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+//! \brief Le bilan d'un lot; les durées sont en microsecondes
+//! \note calcul est la somme, sur tous les fils de calcul, du temps passé à répondre aux requêtes: s'il approche
+//! duree * nbFils, le lot est limité par le processeur plutôt que par la lecture ou l'écriture
+struct RapportLot
+{
+    size_t requetes;
+    size_t erreurs; //lignes mal formées ou requêtes refusées (heure hors de l'intervalle, etc.)
+    size_t inatteignables;
+    unsigned int nbFils;
+    long duree;
+    long calcul;
+
+    RapportLot();
+};
+
+std::ostream &operator<<(std::ostream &p_flux, const RapportLot &p_rapport);
+
+//! \brief Répond à un flux de requêtes (une par ligne) et écrit les itinéraires dans l'ordre des requêtes
+//! \note une requête est une ligne "latitude,longitude,latitude,longitude,HH:MM:SS" (origine, destination, heure
+//! de départ); les lignes vides et celles qui commencent par '#' sont ignorées. Chaque requête donne une ligne de
+//! sortie: l'itinéraire en JSON (ecrireItineraireJSON()), ou {"erreur":"..."} si elle n'a pas pu être traitée
+//! \note la lecture, le calcul et l'écriture se chevauchent: un fil lit des blocs de tailleBloc requêtes, les fils
+//! de calcul prennent le prochain bloc lu (chacun avec son EspaceRequete, sans modifier le réseau), et le fil
+//! appelant écrit les blocs terminés dans l'ordre de lecture. Au plus p_blocsEnVol blocs sont en mémoire à la fois
+//! (lus, en calcul ou en attente d'écriture), quelle que soit la taille du fichier
+//! \note les requêtes passent par le cache du réseau s'il est actif (ReseauGTFS::activerCache()), avec l'heure de
+//! départ dans la clé: des requêtes voisines d'un lot partagent alors leur itinéraire
+class LotRequetes
+{
+public:
+    static const size_t tailleBloc = 1024;
+
+    LotRequetes(const DonneesGTFS &, const ReseauGTFS &);
+
+    RapportLot traiter(std::istream &, std::ostream &, unsigned int = 0, size_t = 0) const;
+    RapportLot traiter(const std::string &, const std::string &, unsigned int = 0) const;
+
+private:
+    bool repondre(const std::string &, EspaceRequete &, std::ostream &) const;
+
+    const DonneesGTFS &m_gtfs;
+    const ReseauGTFS &m_reseau;
+};
+
+#endif //TP2_LOTREQUETES_H
@@ -4,13 +4,19 @@
 
 #include <iostream>
 #include <ctime>
+#include <cstdlib>
 
 #include "DonneesGTFS.h"
 #include "ReseauGTFS.h"
+#include "chargementGTFS.h"
+#include "lotRequetes.h"
+#include "memoire.h"
 
 using namespace std;
 
-int main()
+//  Usage: test_exe [--lot requetes.csv itineraires.jsonl [nb_fils]]
+//  --lot: répond aux requêtes du fichier (voir LotRequetes) au lieu de la démonstration
+int main(int argc, char *argv[])
 {
     const string chemin_dossier = "RTC-9dec-24fev";
     Date today(2017, 2, 9);
@@ -20,21 +26,35 @@ int main()
 
     Heure now2 = now1.add_secondes(72000); //on désire obtenir tous les arrêts du reste de la journée
 
+    if (getenv("GTFS_TRACE")) Chronometre::activerTrace(&cerr); //trace des phases chronométrées (make STATS=1)
+
     clock_t begin = clock();
     DonneesGTFS donnees_rtc(today, now1, now2);
 
-    donnees_rtc.ajouterLignes(chemin_dossier + "/routes.txt");
-    cout << "Nombre de lignes = " << donnees_rtc.getNbLignes() << endl;
-    donnees_rtc.ajouterStations(chemin_dossier + "/stops.txt");
-    cout << "Nombre de stations initiales = " << donnees_rtc.getNbStations() << endl;
-    donnees_rtc.ajouterServices(chemin_dossier + "/calendar_dates.txt");
-    cout << "Nombre de services = " << donnees_rtc.getNbServices() << endl;
-    donnees_rtc.ajouterVoyagesDeLaDate(chemin_dossier + "/trips.txt");
-    donnees_rtc.ajouterArretsDesVoyagesDeLaDate(chemin_dossier + "/stop_times.txt");
-    donnees_rtc.ajouterTransferts(chemin_dossier + "/transfers.txt");
+    StatistiquesChargement statsChargement;
+    chargerDonneesGTFS(donnees_rtc, chemin_dossier, &statsChargement, true, [&](EtapeChargement p_etape)
+    {
+        switch (p_etape)
+        {
+            case EtapeChargement::lignes:
+                cout << "Nombre de lignes = " << donnees_rtc.getNbLignes() << endl;
+                break;
+            case EtapeChargement::stations:
+                cout << "Nombre de stations initiales = " << donnees_rtc.getNbStations() << endl;
+                break;
+            case EtapeChargement::services:
+                cout << "Nombre de services = " << donnees_rtc.getNbServices() << endl;
+                break;
+            case EtapeChargement::voyages:
+            case EtapeChargement::arrets:
+            case EtapeChargement::transferts:
+                break;
+        }
+    });
 
     clock_t end = clock();
     cout << "Chargement des données effectué en " << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl;
+    GTFS_STAT(cout << "Durée des chargements: " << statsChargement << endl);
 
     cout << "Nombre de stations ayant au moins 1 arret = " << donnees_rtc.getNbStations() << endl;
     cout << "Nombre de transferts = " << donnees_rtc.getNbTransferts() << endl;
@@ -47,6 +67,17 @@ int main()
 
 
     cout << "Graphe (sans le point source et destination) a été produit en " << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl;
+    GTFS_STAT(cout << "Durée des phases de construction: " << reseau_rtc.getStatistiquesConstruction() << endl);
+    GTFS_STAT(RapportMemoire memoire; mesurerMemoire(donnees_rtc, memoire); reseau_rtc.mesurerMemoire(memoire));
+    GTFS_STAT(cout << "Mémoire par composant:" << endl << memoire);
+
+    if (argc >= 4 && string(argv[1]) == "--lot")
+    {
+        LotRequetes lot(donnees_rtc, reseau_rtc);
+        unsigned int nbFils = argc >= 5 ? strtoul(argv[4], nullptr, 10) : 0;
+        cout << "Lot " << argv[2] << " -> " << argv[3] << ": " << lot.traiter(argv[2], argv[3], nbFils) << endl;
+        return 0;
+    }
 
     // cout << endl;
     // cout << "=============================================" << endl;
@@ -70,6 +101,7 @@ int main()
     // reseau_rtc.itineraire(donnees_rtc, true, tempsExecution);
     // cout << endl << "Temps d'exécution de l'algorithme de plus court chemin: " << tempsExecution
     //      << " microsecondes" << endl;
+    // GTFS_STAT(cout << "Recherche: " << reseau_rtc.getStatistiquesRecherche() << endl);
 
     // cout << endl;
     // cout << "=============================================" << endl;
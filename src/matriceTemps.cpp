@@ -0,0 +1,301 @@
+//
+//  matriceTemps.cpp
+//  Matrice des durées de trajet de station à station pour une heure de départ, calculée sur ReseauGTFS
+//
+
+#include "matriceTemps.h"
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+const unsigned int MatriceTemps::inatteignable;
+const uint32_t MatriceTemps::tailleTuile;
+
+namespace
+{
+    const char magique[8] = {'G', 'T', 'F', 'S', 'M', 'T', '0', '1'};
+    const size_t alignementTuiles = 4096; //les tuiles commencent sur une page
+
+    struct Entete
+    {
+        char magique[8];
+        uint32_t nbStations;
+        uint32_t tailleTuile;
+        uint32_t octetsParDuree;
+        uint32_t pas;
+        uint32_t heureDepart;
+        uint32_t reserve;
+    };
+
+    //! \return la position (en octets) des tuiles dans le fichier
+    size_t debutTuiles(size_t p_nbStations)
+    {
+        size_t taille = sizeof(Entete) + p_nbStations * sizeof(uint32_t);
+        return (taille + alignementTuiles - 1) / alignementTuiles * alignementTuiles;
+    }
+
+    //! \return la position d'une durée parmi les tuiles, en nombre de durées
+    size_t positionDansTuiles(size_t p_nbStations, size_t i, size_t j)
+    {
+        const size_t t = MatriceTemps::tailleTuile;
+        const size_t tuilesParRangee = (p_nbStations + t - 1) / t;
+        return ((i / t) * tuilesParRangee + j / t) * t * t + (i % t) * t + j % t;
+    }
+}
+
+MatriceTemps::MatriceTemps()
+    : m_heureDepart(0), m_tuiles(nullptr), m_projection(nullptr), m_tailleProjection(0), m_octetsParDuree(4), m_pas(1)
+{
+}
+
+MatriceTemps::~MatriceTemps()
+{
+    liberer();
+}
+
+//! \brief libère le fichier projeté par charger(), s'il y a lieu
+void MatriceTemps::liberer()
+{
+    if (m_projection) munmap(m_projection, m_tailleProjection);
+    m_projection = nullptr;
+    m_tuiles = nullptr;
+    m_tailleProjection = 0;
+}
+
+//! \brief calcule la durée de trajet au plus tôt de chaque station vers chaque station
+//! \param[in] p_gtfs: les données ayant servi à construire p_reseau
+//! \param[in] p_reseau: le réseau (ses points origine et destination, s'il y en a, sont ignorés)
+//! \param[in] p_heureDepart: l'heure de départ de chaque station source
+//! \param[in] p_dureeMax: les stations atteintes après cette durée (en secondes) sont inatteignables; une petite
+//! durée limite l'exploration de chaque recherche
+//! \param[in] p_nbFils: le nombre de fils d'exécution (0: autant que de coeurs)
+//! \post getDuree(i, i) vaut 0; getDuree(i, j) vaut inatteignable si la station j n'est pas atteinte
+void MatriceTemps::calculer(const DonneesGTFS &p_gtfs, const ReseauGTFS &p_reseau, const Heure &p_heureDepart,
+                            unsigned int p_dureeMax, unsigned int p_nbFils)
+{
+    liberer();
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+    const Heure minuit(0, 0, 0);
+    m_heureDepart = p_heureDepart - minuit;
+    m_octetsParDuree = 4;
+    m_pas = 1;
+
+    //les sommets de chaque station, par heure croissante (l'ordre de Station::getArrets())
+    const auto &stations = p_gtfs.getStations();
+    const size_t n = stations.size();
+    m_stations.clear();
+    m_stations.reserve(n);
+    vector<size_t> debutStation(1, 0), sommets;
+    vector<unsigned int> heures;
+    for (const auto &stationPair : stations)
+    {
+        m_stations.push_back(stationPair.first);
+        for (const auto &arret : stationPair.second.getArrets())
+        {
+            sommets.push_back(p_reseau.getSommetDeArret(arret.second));
+            heures.push_back(arret.second->getHeureArrivee() - minuit);
+        }
+        debutStation.push_back(sommets.size());
+    }
+
+    m_durees.assign(n * n, inatteignable);
+    const GrapheAbstrait &graphe = p_reseau.getGraphe();
+    atomic<size_t> prochaine(0);
+    auto travailler = [&]()
+    {
+        vector<unsigned int> distance;
+        vector<size_t> parent;
+        for (size_t s = prochaine++; s < n; s = prochaine++)
+        {
+            uint32_t *rangee = &m_durees[s * n];
+            rangee[s] = 0;
+            auto premier = lower_bound(heures.begin() + debutStation[s], heures.begin() + debutStation[s + 1],
+                                       m_heureDepart);
+            if (premier == heures.begin() + debutStation[s + 1]) continue; //plus aucun départ de cette station
+            const unsigned int attente = *premier - m_heureDepart;
+            if (attente > p_dureeMax) continue;
+            const unsigned int borne = p_dureeMax == inatteignable ? inatteignable : p_dureeMax - attente;
+            graphe.arbrePlusCourtsChemins(sommets[premier - heures.begin()], false, borne, distance, parent);
+            for (size_t t = 0; t < n; ++t)
+            {
+                unsigned int meilleure = inatteignable;
+                for (size_t k = debutStation[t]; k < debutStation[t + 1]; ++k)
+                    meilleure = min(meilleure, distance[sommets[k]]);
+                if (t != s && meilleure <= borne) rangee[t] = attente + meilleure;
+            }
+        }
+    };
+    vector<thread> fils;
+    for (unsigned int f = 1; f < p_nbFils; ++f) fils.push_back(thread(travailler));
+    travailler();
+    for (auto &f : fils) f.join();
+}
+
+//! \brief Écrit la matrice dans un fichier binaire en tuiles (voir charger())
+//! \param[in] p_codage: entiers32 (durées exactes) ou quantifie16 (moitié moins d'espace, durées arrondies)
+//! \throws logic_error si la matrice est vide ou si le fichier ne peut être écrit
+void MatriceTemps::sauvegarder(const string &p_fichier, Codage p_codage) const
+{
+    const size_t n = m_stations.size();
+    if (n == 0) throw logic_error("MatriceTemps::sauvegarder(): matrice vide");
+    Entete entete;
+    memcpy(entete.magique, magique, sizeof(magique));
+    entete.nbStations = static_cast<uint32_t>(n);
+    entete.tailleTuile = tailleTuile;
+    entete.octetsParDuree = p_codage == Codage::quantifie16 ? 2 : 4;
+    entete.pas = 1;
+    entete.heureDepart = m_heureDepart;
+    entete.reserve = 0;
+    const uint16_t inatteignable16 = numeric_limits<uint16_t>::max();
+    if (p_codage == Codage::quantifie16)
+    {
+        //le plus petit pas pour lequel la plus grande durée tient sous la valeur réservée
+        unsigned int plusGrande = 0;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                unsigned int d = getDuree(i, j);
+                if (d != inatteignable) plusGrande = max(plusGrande, d);
+            }
+        entete.pas = max(1u, (plusGrande + inatteignable16 - 2) / (inatteignable16 - 1));
+    }
+
+    ofstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("MatriceTemps::sauvegarder(): impossible d'écrire " + p_fichier);
+    flux.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    flux.write(reinterpret_cast<const char *>(m_stations.data()), n * sizeof(uint32_t));
+    const size_t remplissage = debutTuiles(n) - sizeof(entete) - n * sizeof(uint32_t);
+    flux.write(string(remplissage, '\0').data(), remplissage);
+
+    //les tuiles incomplètes (dernière rangée et dernière colonne) sont complétées: leur adresse reste calculable
+    const size_t tuilesParRangee = (n + tailleTuile - 1) / tailleTuile;
+    vector<char> tuile(tailleTuile * tailleTuile * entete.octetsParDuree);
+    for (size_t ti = 0; ti < tuilesParRangee; ++ti)
+        for (size_t tj = 0; tj < tuilesParRangee; ++tj)
+        {
+            char *position = tuile.data();
+            for (size_t r = 0; r < tailleTuile; ++r)
+                for (size_t c = 0; c < tailleTuile; ++c, position += entete.octetsParDuree)
+                {
+                    size_t i = ti * tailleTuile + r, j = tj * tailleTuile + c;
+                    uint32_t d = i < n && j < n ? getDuree(i, j) : inatteignable;
+                    if (entete.octetsParDuree == 4)
+                        memcpy(position, &d, sizeof(d));
+                    else
+                    {
+                        uint16_t q = d == inatteignable ? inatteignable16
+                                                        : static_cast<uint16_t>((d + entete.pas - 1) / entete.pas);
+                        memcpy(position, &q, sizeof(q));
+                    }
+                }
+            flux.write(tuile.data(), tuile.size());
+        }
+    if (!flux) throw logic_error("MatriceTemps::sauvegarder(): erreur d'écriture dans " + p_fichier);
+}
+
+//! \brief Projette en mémoire (mmap) un fichier écrit par MatriceTemps::sauvegarder()
+//! \note rien n'est lu avant le premier accès: les pages sont chargées par le système à la demande
+//! \throws logic_error si le fichier est illisible ou n'a pas le format attendu
+void MatriceTemps::charger(const string &p_fichier)
+{
+    int descripteur = open(p_fichier.c_str(), O_RDONLY);
+    if (descripteur < 0) throw logic_error("MatriceTemps::charger(): impossible de lire " + p_fichier);
+    struct stat infos;
+    if (fstat(descripteur, &infos) != 0 || static_cast<size_t>(infos.st_size) < sizeof(Entete))
+    {
+        close(descripteur);
+        throw logic_error("MatriceTemps::charger(): format invalide dans " + p_fichier);
+    }
+    const size_t taille = infos.st_size;
+    void *projection = mmap(nullptr, taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (projection == MAP_FAILED) throw logic_error("MatriceTemps::charger(): mmap() a échoué pour " + p_fichier);
+
+    Entete entete;
+    memcpy(&entete, projection, sizeof(entete));
+    const size_t n = entete.nbStations;
+    const size_t tuilesParRangee = (n + tailleTuile - 1) / tailleTuile;
+    if (memcmp(entete.magique, magique, sizeof(magique)) != 0 || entete.tailleTuile != tailleTuile ||
+        (entete.octetsParDuree != 2 && entete.octetsParDuree != 4) || entete.pas == 0 ||
+        taille != debutTuiles(n) + tuilesParRangee * tuilesParRangee * tailleTuile * tailleTuile * entete.octetsParDuree)
+    {
+        munmap(projection, taille);
+        throw logic_error("MatriceTemps::charger(): format invalide dans " + p_fichier);
+    }
+
+    liberer();
+    const char *octets = static_cast<const char *>(projection);
+    m_stations.assign(reinterpret_cast<const uint32_t *>(octets + sizeof(Entete)),
+                      reinterpret_cast<const uint32_t *>(octets + sizeof(Entete)) + n);
+    m_durees.clear();
+    m_durees.shrink_to_fit();
+    m_heureDepart = entete.heureDepart;
+    m_octetsParDuree = entete.octetsParDuree;
+    m_pas = entete.pas;
+    m_projection = projection;
+    m_tailleProjection = taille;
+    m_tuiles = octets + debutTuiles(n);
+}
+
+//! \return la durée (en secondes) du trajet au plus tôt de la station d'indice i vers celle d'indice j,
+//! en partant à getHeureDepart(), ou inatteignable
+//! \note les indices sont ceux de getStations() (voir getIndiceStation())
+//! \throws logic_error si un indice est hors limites
+unsigned int MatriceTemps::getDuree(size_t i, size_t j) const
+{
+    const size_t n = m_stations.size();
+    if (i >= n || j >= n) throw logic_error("MatriceTemps::getDuree(): indice de station hors limites");
+    if (!m_tuiles) return m_durees[i * n + j];
+    const char *position = m_tuiles + positionDansTuiles(n, i, j) * m_octetsParDuree;
+    if (m_octetsParDuree == 4)
+    {
+        uint32_t d;
+        memcpy(&d, position, sizeof(d));
+        return d;
+    }
+    uint16_t q;
+    memcpy(&q, position, sizeof(q));
+    return q == numeric_limits<uint16_t>::max() ? inatteignable : q * m_pas;
+}
+
+//! \return l'indice d'une station dans getStations()
+//! \throws logic_error si la station n'est pas dans la matrice
+size_t MatriceTemps::getIndiceStation(unsigned int p_stationId) const
+{
+    auto it = lower_bound(m_stations.begin(), m_stations.end(), p_stationId);
+    if (it == m_stations.end() || *it != p_stationId)
+        throw logic_error("MatriceTemps::getIndiceStation(): station absente de la matrice");
+    return it - m_stations.begin();
+}
+
+const std::vector<uint32_t> &MatriceTemps::getStations() const
+{
+    return m_stations;
+}
+
+size_t MatriceTemps::getNbStations() const
+{
+    return m_stations.size();
+}
+
+//! \return l'heure de départ de la matrice, en secondes depuis minuit
+unsigned int MatriceTemps::getHeureDepart() const
+{
+    return m_heureDepart;
+}
+
+//! \return la résolution des durées, en secondes (1 sauf pour un fichier quantifié)
+unsigned int MatriceTemps::getPas() const
+{
+    return m_pas;
+}
@@ -0,0 +1,64 @@
+//
+//  matriceTemps.h
+//  Matrice des durées de trajet de station à station pour une heure de départ, calculée sur ReseauGTFS
+//
+
+#ifndef TP2_MATRICETEMPS_H
+#define TP2_MATRICETEMPS_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+//! \brief Durées de trajet au plus tôt de chaque station vers chaque station, pour une heure de départ donnée
+//! \note MatriceTemps::calculer() fait une recherche vers tous les sommets (Graphe::arbrePlusCourtsChemins())
+//! par station source, à partir du premier arrêt de la source à l'heure de départ ou après; la durée vers une
+//! station est celle du premier de ses arrêts atteint (l'attente initiale à la source est comptée).
+//! Les sources sont réparties entre les fils à la demande: un fil libre prend la prochaine source non traitée
+//! \note le fichier écrit par sauvegarder() est découpé en tuiles de tailleTuile x tailleTuile durées, de sorte
+//! qu'un bloc de stations voisines dans l'ordre de getStations() tient dans quelques pages; charger() le
+//! projette en mémoire (mmap) sans le lire, et getDuree() n'accède qu'à la page de la durée demandée
+//! \note en 16 bits, une durée est arrondie au multiple supérieur de getPas() secondes (choisi pour que la plus
+//! grande durée tienne); elle n'est donc jamais sous-estimée
+class MatriceTemps
+{
+public:
+    enum class Codage { entiers32, quantifie16 };
+
+    static const unsigned int inatteignable = std::numeric_limits<unsigned int>::max();
+    static const uint32_t tailleTuile = 64;
+
+    MatriceTemps();
+    ~MatriceTemps();
+    MatriceTemps(const MatriceTemps &) = delete;
+    MatriceTemps &operator=(const MatriceTemps &) = delete;
+
+    void calculer(const DonneesGTFS &, const ReseauGTFS &, const Heure &, unsigned int = inatteignable,
+                  unsigned int = 0);
+    void sauvegarder(const std::string &, Codage = Codage::entiers32) const;
+    void charger(const std::string &);
+    unsigned int getDuree(size_t, size_t) const;
+    size_t getIndiceStation(unsigned int) const;
+    const std::vector<uint32_t> &getStations() const;
+    size_t getNbStations() const;
+    unsigned int getHeureDepart() const;
+    unsigned int getPas() const;
+
+private:
+    void liberer();
+
+    std::vector<uint32_t> m_stations; //les stationId, dans l'ordre de getStations() (croissant)
+    unsigned int m_heureDepart; //en secondes depuis minuit
+    std::vector<uint32_t> m_durees; //après calculer(): n x n durées, rangée par rangée
+    const char *m_tuiles; //après charger(): le début des tuiles dans le fichier projeté
+    void *m_projection; //après charger(): le fichier projeté en mémoire (munmap() à la destruction)
+    size_t m_tailleProjection;
+    uint32_t m_octetsParDuree; //4, ou 2 pour un fichier quantifié
+    uint32_t m_pas; //la résolution des durées d'un fichier quantifié, en secondes (1 sinon)
+};
+
+#endif //TP2_MATRICETEMPS_H
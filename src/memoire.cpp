@@ -0,0 +1,142 @@
+//
+//  memoire.cpp
+//  Mémoire occupée par composant (données GTFS, graphe, tables du réseau), mesurée en parcourant les structures
+//
+
+#include "memoire.h"
+#include "DonneesGTFS.h"
+
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    //l'en-tête d'un noeud de std::unordered_map et std::unordered_set (libstdc++: le pointeur vers le suivant)
+    const size_t octetsNoeudHachage = sizeof(void *);
+
+    //le bloc de contrôle d'un shared_ptr construit à partir d'un pointeur (vtable, deux compteurs, le pointeur)
+    const size_t octetsControlePartage = 24;
+
+    //le tableau des alvéoles d'une table de hachage (libstdc++: aucun tableau alloué pour une seule alvéole)
+    size_t octetsAlveoles(size_t p_nbAlveoles)
+    {
+        return p_nbAlveoles > 1 ? octetsTas(p_nbAlveoles * sizeof(void *)) : 0;
+    }
+}
+
+void RapportMemoire::ajouter(const string &p_nom, size_t p_octets, size_t p_objets)
+{
+    m_composants.push_back(MemoireComposant{p_nom, p_octets, p_objets});
+}
+
+const vector<MemoireComposant> &RapportMemoire::getComposants() const
+{
+    return m_composants;
+}
+
+size_t RapportMemoire::getTotal() const
+{
+    size_t total = 0;
+    for (const auto &composant : m_composants) total += composant.octets;
+    return total;
+}
+
+//! \brief écrit les champs JSON du rapport ("nom_octets" et "nom_objets" par composant, les points devenant des
+//! soulignés, puis "memoire_totale_octets"), chacun précédé d'une virgule
+void RapportMemoire::ecrireChampsJSON(ostream &p_flux) const
+{
+    for (const auto &composant : m_composants)
+    {
+        string nom = composant.nom;
+        for (char &c : nom)
+            if (c == '.') c = '_';
+        p_flux << ",\"" << nom << "_octets\":" << composant.octets << ",\"" << nom << "_objets\":" << composant.objets;
+    }
+    p_flux << ",\"memoire_totale_octets\":" << getTotal();
+}
+
+ostream &operator<<(ostream &p_flux, const RapportMemoire &p_rapport)
+{
+    for (const auto &composant : p_rapport.getComposants())
+        p_flux << setw(24) << left << composant.nom << right << setw(14) << composant.octets << " octets"
+               << setw(12) << composant.objets << " objets" << endl;
+    return p_flux << setw(24) << left << "total" << right << setw(14) << p_rapport.getTotal() << " octets" << endl;
+}
+
+//! \return les octets occupés sur le tas par une allocation de p_demande octets: malloc de la glibc ajoute un
+//! en-tête de 8 octets et arrondit au multiple de 16 supérieur, avec un minimum de 32
+size_t octetsTas(size_t p_demande)
+{
+    return max<size_t>(32, (p_demande + 8 + 15) & ~static_cast<size_t>(15));
+}
+
+//! \return les octets sur le tas d'une chaîne (aucun pour une chaîne courte, gardée dans l'objet par libstdc++)
+size_t octetsChaine(const string &p_chaine)
+{
+    return p_chaine.capacity() > 15 ? octetsTas(p_chaine.capacity() + 1) : 0;
+}
+
+//! \brief ajoute à p_rapport la mémoire des structures de p_gtfs
+//! \note composants: gtfs.lignes (et l'index des lignes par numéro), gtfs.services, gtfs.stations,
+//! gtfs.stations.arrets (les multimap des arrêts par heure), gtfs.voyages, gtfs.voyages.arrets (les ensembles
+//! des arrêts par voyage), gtfs.arrets (les objets Arret, partagés par les deux précédents) et gtfs.transferts
+//! \note l'index des lignes par numéro et les services sont privés: on les estime à partir du nombre de lignes
+//! et de services (la clé d'un service est supposée courte)
+void mesurerMemoire(const DonneesGTFS &p_gtfs, RapportMemoire &p_rapport)
+{
+    const auto &lignes = p_gtfs.getLignes();
+    size_t octets = octetsAlveoles(lignes.bucket_count());
+    for (const auto &ligne : lignes)
+    {
+        const size_t chaines = octetsChaine(ligne.second.getNumero()) + octetsChaine(ligne.second.getDescription());
+        octets += octetsTas(octetsNoeudHachage + sizeof(ligne)) + chaines;
+        //le même objet Ligne, copié dans l'index par numéro (ses chaînes, plus la clé: une autre copie du numéro)
+        octets += octetsTas(octetsNoeudArbre + sizeof(pair<const string, Ligne>)) +
+                  octetsChaine(ligne.second.getNumero()) + chaines;
+    }
+    p_rapport.ajouter("gtfs.lignes", octets, lignes.size());
+
+    const size_t nbServices = p_gtfs.getNbServices();
+    p_rapport.ajouter("gtfs.services",
+                      octetsAlveoles(nbServices) +
+                      nbServices * octetsTas(octetsNoeudHachage + sizeof(string) + sizeof(size_t)),
+                      nbServices);
+
+    const auto &stations = p_gtfs.getStations();
+    octets = 0;
+    size_t octetsArretsStations = 0, nbArretsStations = 0;
+    for (const auto &station : stations)
+    {
+        octets += octetsTas(octetsNoeudArbre + sizeof(station)) + octetsChaine(station.second.getNom()) +
+                  octetsChaine(station.second.getDescription());
+        const size_t nb = station.second.getArrets().size();
+        octetsArretsStations += nb * octetsTas(octetsNoeudArbre + sizeof(pair<const Heure, Arret::Ptr>));
+        nbArretsStations += nb;
+    }
+    p_rapport.ajouter("gtfs.stations", octets, stations.size());
+    p_rapport.ajouter("gtfs.stations.arrets", octetsArretsStations, nbArretsStations);
+
+    const auto &voyages = p_gtfs.getVoyages();
+    octets = 0;
+    size_t octetsArretsVoyages = 0, nbArretsVoyages = 0, octetsArrets = 0;
+    for (const auto &voyage : voyages)
+    {
+        octets += octetsTas(octetsNoeudArbre + sizeof(voyage)) + octetsChaine(voyage.first) +
+                  octetsChaine(voyage.second.getId()) + octetsChaine(voyage.second.getServiceId()) +
+                  octetsChaine(voyage.second.getDestination());
+        const auto &arrets = voyage.second.getArrets();
+        octetsArretsVoyages += arrets.size() * octetsTas(octetsNoeudArbre + sizeof(Arret::Ptr));
+        nbArretsVoyages += arrets.size();
+        //chaque arrêt appartient à un seul voyage: c'est ici qu'on compte les objets Arret
+        for (const auto &arret : arrets)
+            octetsArrets += octetsTas(sizeof(Arret)) + octetsTas(octetsControlePartage) +
+                            octetsChaine(arret->getVoyageId());
+    }
+    p_rapport.ajouter("gtfs.voyages", octets, voyages.size());
+    p_rapport.ajouter("gtfs.voyages.arrets", octetsArretsVoyages, nbArretsVoyages);
+    p_rapport.ajouter("gtfs.arrets", octetsArrets, nbArretsVoyages);
+
+    p_rapport.ajouter("gtfs.transferts", octetsVecteur(p_gtfs.getTransferts()), p_gtfs.getTransferts().size());
+}
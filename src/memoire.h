@@ -0,0 +1,57 @@
+//
+//  memoire.h
+//  Mémoire occupée par composant (données GTFS, graphe, tables du réseau), mesurée en parcourant les structures
+//
+
+#ifndef TP2_MEMOIRE_H
+#define TP2_MEMOIRE_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstddef>
+
+class DonneesGTFS;
+
+//! \brief Les octets et le nombre d'objets d'un composant
+struct MemoireComposant
+{
+    std::string nom;
+    size_t octets;
+    size_t objets;
+};
+
+//! \brief Mémoire occupée par composant, dans l'ordre où les composants ont été ajoutés
+//! \note les octets sont ceux des allocations sur le tas (plus la taille des tableaux et des noeuds), comptés selon
+//! la disposition de libstdc++ et l'arrondi de malloc de la glibc (octetsTas()); un objet partagé (Arret::Ptr) est
+//! compté une seule fois, dans le composant qui le possède. Les noms sont de la forme "sous-système.structure"
+class RapportMemoire
+{
+public:
+    void ajouter(const std::string &p_nom, size_t p_octets, size_t p_objets);
+    const std::vector<MemoireComposant> &getComposants() const;
+    size_t getTotal() const;
+    void ecrireChampsJSON(std::ostream &p_flux) const;
+
+private:
+    std::vector<MemoireComposant> m_composants;
+};
+
+std::ostream &operator<<(std::ostream &p_flux, const RapportMemoire &p_rapport);
+
+//! \brief l'en-tête d'un noeud de std::map, std::multimap et std::set (libstdc++: couleur et trois pointeurs)
+const size_t octetsNoeudArbre = 32;
+
+size_t octetsTas(size_t p_demande);
+size_t octetsChaine(const std::string &p_chaine);
+
+//! \return les octets sur le tas du tableau d'un vecteur (selon sa capacité)
+template<typename T>
+size_t octetsVecteur(const std::vector<T> &p_vecteur)
+{
+    return p_vecteur.capacity() ? octetsTas(p_vecteur.capacity() * sizeof(T)) : 0;
+}
+
+void mesurerMemoire(const DonneesGTFS &p_gtfs, RapportMemoire &p_rapport);
+
+#endif //TP2_MEMOIRE_H
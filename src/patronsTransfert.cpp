@@ -0,0 +1,577 @@
+//
+//  patronsTransfert.cpp
+//  Patrons de transfert précalculés sur ReseauStations pour des requêtes de quelques millisecondes
+//
+
+#include "patronsTransfert.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <cstring>
+#include <stdexcept>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t infini = numeric_limits<uint32_t>::max();
+    const uint32_t parAutobus = infini; //Noeud::marche d'un tronçon d'autobus
+    const char magique[8] = {'G', 'T', 'F', 'S', 'P', 'T', '0', '1'};
+
+    uint32_t secondes(const Heure &p_heure)
+    {
+        return static_cast<uint32_t>(p_heure - Heure(0, 0, 0));
+    }
+
+    long tempsEcoule(const timeval &tv1, const timeval &tv2)
+    {
+        return 1000000L * (tv2.tv_sec - tv1.tv_sec) + (tv2.tv_usec - tv1.tv_usec);
+    }
+
+    //FNV-1a
+    void melanger(uint64_t &p_h, const void *p_donnees, size_t p_taille)
+    {
+        const unsigned char *octets = static_cast<const unsigned char *>(p_donnees);
+        for (size_t i = 0; i < p_taille; ++i)
+        {
+            p_h ^= octets[i];
+            p_h *= 1099511628211ULL;
+        }
+    }
+
+    template<typename T>
+    void ecrire(ostream &p_flux, const T &p_valeur)
+    {
+        p_flux.write(reinterpret_cast<const char *>(&p_valeur), sizeof(T));
+    }
+
+    template<typename T>
+    void lire(istream &p_flux, T &p_valeur)
+    {
+        p_flux.read(reinterpret_cast<char *>(&p_valeur), sizeof(T));
+    }
+}
+
+//! \brief construit les tables de trajets directs; les patrons restent à précalculer ou à charger
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire p_reseau
+//! \param[in] p_reseau: le réseau par stations dont on précalcule les patrons
+//! \post les voyages de même séquence de stations sont regroupés en lignes directes sans dépassement
+PatronsTransfert::PatronsTransfert(const DonneesGTFS &p_gtfs, const ReseauStations &p_reseau)
+    : m_reseau(p_reseau), m_pasEchantillonnage(0), m_origine_dest_ajoute(false)
+{
+    const size_t nbStations = m_reseau.getNbSommets();
+
+    //regroupement des voyages par séquence de stations
+    map<vector<uint32_t>, vector<uint32_t> > parSequence;
+    vector<vector<uint32_t> > heuresDuVoyage;
+    for (auto &v : p_gtfs.getVoyages())
+    {
+        uint32_t indiceVoyage = static_cast<uint32_t>(m_idDuVoyage.size());
+        m_idDuVoyage.push_back(v.first);
+        m_ligneDuVoyage.push_back(v.second.getLigne());
+        vector<uint32_t> sequence, heures;
+        for (auto &arret : v.second.getArrets())
+        {
+            sequence.push_back(m_reseau.getIndiceDeStation(arret->getStationId()));
+            heures.push_back(secondes(arret->getHeureArrivee()));
+        }
+        heuresDuVoyage.push_back(heures);
+        if (sequence.size() > 1) parSequence[sequence].push_back(indiceVoyage);
+    }
+
+    vector<vector<Passage> > passages(nbStations);
+    for (auto &groupe : parSequence)
+    {
+        const vector<uint32_t> &sequence = groupe.first;
+        vector<uint32_t> voyages = groupe.second;
+        sort(voyages.begin(), voyages.end(), [&](uint32_t a, uint32_t b)
+        {
+            return heuresDuVoyage[a] < heuresDuVoyage[b];
+        });
+        //un voyage qui en dépasse un autre va dans une autre ligne directe, pour que chaque position reste triée
+        vector<vector<uint32_t> > lignes;
+        for (uint32_t v : voyages)
+        {
+            bool place = false;
+            for (auto &ligne : lignes)
+            {
+                const vector<uint32_t> &dernier = heuresDuVoyage[ligne.back()];
+                bool depasse = false;
+                for (size_t i = 0; i < sequence.size() && !depasse; ++i) depasse = heuresDuVoyage[v][i] < dernier[i];
+                if (!depasse)
+                {
+                    ligne.push_back(v);
+                    place = true;
+                    break;
+                }
+            }
+            if (!place) lignes.push_back(vector<uint32_t>(1, v));
+        }
+        for (auto &ligne : lignes)
+        {
+            LigneDirecte directe;
+            directe.voyages = ligne;
+            directe.heures.resize(sequence.size() * ligne.size());
+            for (size_t i = 0; i < sequence.size(); ++i)
+                for (size_t k = 0; k < ligne.size(); ++k)
+                    directe.heures[i * ligne.size() + k] = heuresDuVoyage[ligne[k]][i];
+            uint32_t indiceLigne = static_cast<uint32_t>(m_lignesDirectes.size());
+            for (size_t i = 0; i < sequence.size(); ++i)
+                passages[sequence[i]].push_back({indiceLigne, static_cast<uint32_t>(i)});
+            m_lignesDirectes.push_back(std::move(directe));
+        }
+    }
+
+    m_debutPassages.assign(nbStations + 1, 0);
+    for (size_t s = 0; s < nbStations; ++s)
+    {
+        m_debutPassages[s + 1] = m_debutPassages[s] + static_cast<uint32_t>(passages[s].size());
+        m_passages.insert(m_passages.end(), passages[s].begin(), passages[s].end());
+    }
+
+    m_marcheVersDestination.assign(nbStations, infini);
+}
+
+//! \brief Précalcule les patrons de transfert de toutes les stations sources
+//! \param[in] p_nbFils: le nombre de fils d'exécution (0: autant que de coeurs)
+//! \param[in] p_pasEchantillonnage: l'écart minimal, en secondes, entre deux heures de départ échantillonnées
+//! pour une même source (0: toutes les heures de départ utiles, patrons exacts aux heures de départ)
+//! \note chaque fil traite une source à la fois; le coût croît avec le nombre d'heures de départ échantillonnées
+void PatronsTransfert::precalculer(unsigned int p_nbFils, unsigned int p_pasEchantillonnage)
+{
+    const uint32_t nbStations = static_cast<uint32_t>(m_reseau.getNbSommets());
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+    m_patrons.assign(nbStations, Patrons());
+    m_pasEchantillonnage = p_pasEchantillonnage;
+
+    atomic<uint32_t> prochaine(0);
+    auto travailler = [&]()
+    {
+        for (uint32_t s = prochaine++; s < nbStations; s = prochaine++)
+            m_patrons[s] = calculerPatrons(s, p_pasEchantillonnage);
+    };
+    vector<thread> fils;
+    for (unsigned int i = 1; i < p_nbFils; ++i) fils.push_back(thread(travailler));
+    travailler();
+    for (auto &f : fils) f.join();
+}
+
+//! \brief les patrons d'une station source, fusionnés sur les heures de départ échantillonnées
+PatronsTransfert::Patrons PatronsTransfert::calculerPatrons(uint32_t p_source, unsigned int p_pas) const
+{
+    const uint32_t heureDepart = m_reseau.getHeureDepart();
+    const uint32_t dureeMaxAcces = static_cast<uint32_t>(distanceMaxMarche / vitesseDeMarche * 3600);
+    vector<uint32_t> toutes = m_reseau.heuresDeDepart(p_source, heureDepart, heureDepart + dureeMaxAcces);
+    vector<uint32_t> heures(1, heureDepart);
+    for (uint32_t h : toutes)
+        if (h >= heures.back() + max(1u, p_pas)) heures.push_back(h);
+
+    Patrons patrons;
+    patrons.noeuds.push_back({p_source, infini, 0});
+    unordered_map<uint64_t, uint32_t> enfants; //(parent, station, autobus?) -> noeud
+
+    const size_t nbStations = m_reseau.getNbSommets();
+    vector<uint32_t> noeud(nbStations), debutTroncon(nbStations), voyageCourant(nbStations);
+    ReseauStations::Arbre arbre;
+    for (uint32_t h : heures)
+    {
+        m_reseau.calculerArbre(p_source, h, arbre);
+        for (uint32_t s : arbre.ordre)
+        {
+            if (s == p_source)
+            {
+                noeud[s] = 0;
+                voyageCourant[s] = Troncon::aucunVoyage;
+                continue;
+            }
+            uint32_t p = arbre.predStation[s];
+            uint32_t voyage = m_reseau.voyageDeConnexion(arbre.predConnexion[s]);
+            uint32_t base, marche;
+            if (voyage == Troncon::aucunVoyage)
+            {
+                base = noeud[p];
+                marche = arbre.arrivee[s] - arbre.arrivee[p];
+            }
+            else
+            {
+                //on reste dans le même autobus: le tronçon commence là où on y est monté
+                base = voyageCourant[p] == voyage ? debutTroncon[p] : noeud[p];
+                marche = parAutobus;
+                debutTroncon[s] = base;
+            }
+            voyageCourant[s] = voyage;
+            uint64_t cle = (static_cast<uint64_t>(base) << 32) | (static_cast<uint64_t>(s) << 1) | (marche == parAutobus);
+            auto insere = enfants.insert(make_pair(cle, static_cast<uint32_t>(patrons.noeuds.size())));
+            if (insere.second) patrons.noeuds.push_back({s, base, marche});
+            noeud[s] = insere.first->second;
+        }
+    }
+    patrons.noeuds.shrink_to_fit();
+    indexerParStation(patrons);
+    return patrons;
+}
+
+void PatronsTransfert::indexerParStation(Patrons &p_patrons)
+{
+    p_patrons.parStation.resize(p_patrons.noeuds.size());
+    for (uint32_t i = 0; i < p_patrons.parStation.size(); ++i) p_patrons.parStation[i] = i;
+    const vector<Noeud> &noeuds = p_patrons.noeuds;
+    stable_sort(p_patrons.parStation.begin(), p_patrons.parStation.end(),
+                [&](uint32_t a, uint32_t b) { return noeuds[a].station < noeuds[b].station; });
+}
+
+//! \brief empreinte du réseau et des données dont dépendent les patrons (stations, voyages, heure de départ)
+uint64_t PatronsTransfert::empreinte() const
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (uint32_t s = 0; s < m_reseau.getNbSommets(); ++s)
+    {
+        unsigned int id = m_reseau.getIdDeStation(s);
+        melanger(h, &id, sizeof(id));
+    }
+    for (auto &voyage : m_idDuVoyage) melanger(h, voyage.data(), voyage.size() + 1);
+    for (auto &ligne : m_lignesDirectes) melanger(h, ligne.heures.data(), ligne.heures.size() * sizeof(uint32_t));
+    unsigned int heureDepart = m_reseau.getHeureDepart();
+    melanger(h, &heureDepart, sizeof(heureDepart));
+    size_t nbArcs = m_reseau.getNbArcs();
+    melanger(h, &nbArcs, sizeof(nbArcs));
+    return h;
+}
+
+//! \brief Écrit les patrons précalculés dans un fichier binaire
+//! \throws logic_error si rien n'est précalculé ou si le fichier ne peut être écrit
+void PatronsTransfert::sauvegarder(const string &p_fichier) const
+{
+    if (!estPrecalcule()) throw logic_error("PatronsTransfert::sauvegarder(): aucun patron précalculé");
+    ofstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("PatronsTransfert::sauvegarder(): impossible d'écrire " + p_fichier);
+    flux.write(magique, sizeof(magique));
+    ecrire(flux, empreinte());
+    ecrire(flux, static_cast<uint32_t>(m_pasEchantillonnage));
+    ecrire(flux, static_cast<uint32_t>(m_patrons.size()));
+    for (auto &patrons : m_patrons)
+    {
+        ecrire(flux, static_cast<uint32_t>(patrons.noeuds.size()));
+        flux.write(reinterpret_cast<const char *>(patrons.noeuds.data()), patrons.noeuds.size() * sizeof(Noeud));
+    }
+    if (!flux) throw logic_error("PatronsTransfert::sauvegarder(): erreur d'écriture dans " + p_fichier);
+}
+
+//! \brief Lit des patrons écrits par PatronsTransfert::sauvegarder()
+//! \throws logic_error si le fichier est illisible ou s'il a été calculé pour d'autres données
+void PatronsTransfert::charger(const string &p_fichier)
+{
+    ifstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("PatronsTransfert::charger(): impossible de lire " + p_fichier);
+    char entete[sizeof(magique)];
+    uint64_t empreinteFichier = 0;
+    uint32_t pas = 0, nbSources = 0;
+    flux.read(entete, sizeof(entete));
+    lire(flux, empreinteFichier);
+    lire(flux, pas);
+    lire(flux, nbSources);
+    if (!flux || memcmp(entete, magique, sizeof(magique)) != 0)
+        throw logic_error("PatronsTransfert::charger(): format invalide dans " + p_fichier);
+    if (empreinteFichier != empreinte() || nbSources != m_reseau.getNbSommets())
+        throw logic_error("PatronsTransfert::charger(): " + p_fichier + " a été calculé pour d'autres données");
+
+    vector<Patrons> patrons(nbSources);
+    for (auto &p : patrons)
+    {
+        uint32_t nbNoeuds = 0;
+        lire(flux, nbNoeuds);
+        if (!flux) throw logic_error("PatronsTransfert::charger(): fichier tronqué " + p_fichier);
+        p.noeuds.resize(nbNoeuds);
+        flux.read(reinterpret_cast<char *>(p.noeuds.data()), nbNoeuds * sizeof(Noeud));
+        if (!flux) throw logic_error("PatronsTransfert::charger(): fichier tronqué " + p_fichier);
+        indexerParStation(p);
+    }
+    m_patrons.swap(patrons);
+    m_pasEchantillonnage = pas;
+}
+
+bool PatronsTransfert::estPrecalcule() const
+{
+    return !m_patrons.empty();
+}
+
+//! \brief mémorise les stations accessibles à pieds du point origine et celles d'où on peut marcher au point destination
+//! \throws logic_error si un point origine et un point destination sont déjà présents
+//! \note comme ReseauStations, filtre les stations par les distances par lots de m_reseau.getCoordsStations()
+void PatronsTransfert::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                                     const Coordonnees &p_pointDestination)
+{
+    if (m_origine_dest_ajoute)
+        throw logic_error("PatronsTransfert::ajouterArcsOrigineDestination(): origine et destination déjà présentes");
+    m_reseau.getCoordsStations().distancesDepuis(p_pointOrigine, m_distancesOrigine);
+    m_reseau.getCoordsStations().distancesDepuis(p_pointDestination, m_distancesDestination);
+    const double seuil = distanceMaxMarche + TableCoordonnees::margeOperateur;
+    for (auto &s : p_gtfs.getStations())
+    {
+        uint32_t indice = m_reseau.getIndiceDeStation(s.first);
+        if (m_distancesOrigine[indice] <= seuil)
+        {
+            double distanceOrigine = s.second.getCoords() - p_pointOrigine;
+            if (distanceOrigine <= distanceMaxMarche)
+                m_accesOrigine.push_back(
+                    make_pair(indice, static_cast<uint32_t>(distanceOrigine / vitesseDeMarche * 3600)));
+        }
+        if (m_distancesDestination[indice] > seuil) continue;
+        double distanceDestination = p_pointDestination - s.second.getCoords();
+        if (distanceDestination <= distanceMaxMarche)
+        {
+            m_marcheVersDestination[indice] = static_cast<uint32_t>(distanceDestination / vitesseDeMarche * 3600);
+            m_stationsVersDestination.push_back(indice);
+        }
+    }
+    m_origine_dest_ajoute = true;
+}
+
+//! \brief Remet PatronsTransfert dans l'état qu'il était avant PatronsTransfert::ajouterArcsOrigineDestination()
+void PatronsTransfert::enleverArcsOrigineDestination()
+{
+    for (uint32_t s : m_stationsVersDestination) m_marcheVersDestination[s] = infini;
+    m_stationsVersDestination.clear();
+    m_accesOrigine.clear();
+    m_origine_dest_ajoute = false;
+}
+
+//! \brief le trajet direct (sans correspondance) le plus rapide de la station p_de à la station p_vers
+//! \param[in] p_heure: l'heure à laquelle on est à la station p_de
+//! \param[out] p_voyage: l'indice du voyage emprunté
+//! \param[out] p_depart: l'heure de départ de p_de
+//! \return l'heure d'arrivée à p_vers, ou infini si aucun voyage direct ne part à p_heure ou plus tard
+uint32_t PatronsTransfert::trajetDirect(uint32_t p_de, uint32_t p_vers, uint32_t p_heure, uint32_t &p_voyage,
+                                        uint32_t &p_depart) const
+{
+    uint32_t meilleure = infini;
+    auto finVers = m_passages.begin() + m_debutPassages[p_vers + 1];
+    auto courant = m_passages.begin() + m_debutPassages[p_vers];
+    for (uint32_t i = m_debutPassages[p_de]; i < m_debutPassages[p_de + 1]; ++i)
+    {
+        const Passage &de = m_passages[i];
+        //les passages sont triés par ligne puis par position: le premier passage à p_vers après p_de
+        while (courant != finVers && (courant->ligne < de.ligne || (courant->ligne == de.ligne && courant->position <= de.position)))
+            ++courant;
+        if (courant == finVers) break;
+        if (courant->ligne != de.ligne) continue;
+        const LigneDirecte &ligne = m_lignesDirectes[de.ligne];
+        const size_t nbVoyages = ligne.voyages.size();
+        auto debut = ligne.heures.begin() + de.position * nbVoyages;
+        auto k = lower_bound(debut, debut + nbVoyages, p_heure);
+        if (k == debut + nbVoyages) continue;
+        size_t indice = k - debut;
+        uint32_t arrivee = ligne.heures[courant->position * nbVoyages + indice];
+        if (arrivee < meilleure)
+        {
+            meilleure = arrivee;
+            p_voyage = ligne.voyages[indice];
+            p_depart = *k;
+        }
+    }
+    return meilleure;
+}
+
+//! \brief Trouve l'itinéraire le plus rapide du point origine au point destination à l'aide des patrons
+//! \param[out] p_tempsExecution: le temps d'exécution de la recherche, en microsecondes
+//! \return l'itinéraire sous forme de tronçons (marche ou autobus)
+//! \throws logic_error si les patrons ne sont pas précalculés ou si les points origine et destination n'ont pas été ajoutés
+//! \note Dijkstra dépendant du temps sur le graphe des patrons menant des stations d'accès aux stations de sortie
+Itineraire PatronsTransfert::calculerItineraire(long &p_tempsExecution) const
+{
+    if (!estPrecalcule())
+        throw logic_error("PatronsTransfert::calculerItineraire(): il faut précalculer ou charger les patrons");
+    if (!m_origine_dest_ajoute)
+        throw logic_error("PatronsTransfert::calculerItineraire(): il faut ajouter un point origine et un point destination");
+
+    timeval tv1, tv2;
+    gettimeofday(&tv1, 0);
+    StatistiquesRecherche stats;
+    const uint32_t heureDepart = m_reseau.getHeureDepart();
+
+    //le graphe de requête: l'union des patrons (station d'accès -> station de sortie)
+    unordered_map<uint32_t, uint32_t> local; //station -> sommet du graphe de requête
+    vector<uint32_t> stationDe;
+    vector<vector<pair<uint32_t, uint32_t> > > arcs; //(sommet, durée de marche ou parAutobus)
+    auto sommet = [&](uint32_t p_station)
+    {
+        auto insere = local.insert(make_pair(p_station, static_cast<uint32_t>(stationDe.size())));
+        if (insere.second)
+        {
+            stationDe.push_back(p_station);
+            arcs.push_back(vector<pair<uint32_t, uint32_t> >());
+        }
+        return insere.first->second;
+    };
+    unordered_set<uint64_t> arcsVus;
+    for (auto &acces : m_accesOrigine)
+    {
+        const Patrons &patrons = m_patrons[acces.first];
+        sommet(acces.first);
+        vector<bool> vu(patrons.noeuds.size(), false);
+        for (uint32_t e : m_stationsVersDestination)
+        {
+            auto premier = partition_point(patrons.parStation.begin(), patrons.parStation.end(),
+                                           [&](uint32_t n) { return patrons.noeuds[n].station < e; });
+            for (auto it = premier; it != patrons.parStation.end() && patrons.noeuds[*it].station == e; ++it)
+                for (uint32_t n = *it; n != 0 && !vu[n]; n = patrons.noeuds[n].parent)
+                {
+                    vu[n] = true;
+                    const Noeud &noeud = patrons.noeuds[n];
+                    uint32_t u = sommet(patrons.noeuds[noeud.parent].station);
+                    uint32_t v = sommet(noeud.station);
+                    uint64_t cle = (static_cast<uint64_t>(u) << 33) | (static_cast<uint64_t>(v) << 1) |
+                                   (noeud.marche == parAutobus);
+                    if (arcsVus.insert(cle).second) arcs[u].push_back(make_pair(v, noeud.marche));
+                }
+        }
+    }
+
+    //Dijkstra dépendant du temps sur le graphe de requête
+    const size_t nbSommets = stationDe.size();
+    vector<uint32_t> arrivee(nbSommets, infini), pred(nbSommets, infini), voyage(nbSommets, Troncon::aucunVoyage),
+            depart(nbSommets, 0);
+    typedef pair<uint32_t, uint32_t> Entree; //(heure d'arrivée, sommet)
+    priority_queue<Entree, vector<Entree>, greater<Entree> > file;
+    for (auto &acces : m_accesOrigine)
+    {
+        uint32_t u = local[acces.first];
+        if (heureDepart + acces.second < arrivee[u])
+        {
+            arrivee[u] = heureDepart + acces.second;
+            file.push(Entree(arrivee[u], u));
+        }
+    }
+    uint32_t meilleure = infini, sortie = infini;
+    while (!file.empty())
+    {
+        Entree e = file.top();
+        file.pop();
+        if (e.first != arrivee[e.second]) continue;
+        if (e.first >= meilleure) break;
+        GTFS_STAT(++stats.sommetsFixes);
+        uint32_t u = e.second;
+        uint32_t marcheDestination = m_marcheVersDestination[stationDe[u]];
+        if (marcheDestination != infini && e.first + marcheDestination < meilleure)
+        {
+            meilleure = e.first + marcheDestination;
+            sortie = u;
+        }
+        for (auto &arc : arcs[u])
+        {
+            GTFS_STAT(++stats.arcsRelaches);
+            uint32_t v = arc.first, heure, voyageArc = Troncon::aucunVoyage, departArc = e.first;
+            if (arc.second == parAutobus)
+                heure = trajetDirect(stationDe[u], stationDe[v], e.first, voyageArc, departArc);
+            else
+                heure = e.first + arc.second;
+            if (heure < arrivee[v])
+            {
+                arrivee[v] = heure;
+                pred[v] = u;
+                voyage[v] = voyageArc;
+                depart[v] = departArc;
+                file.push(Entree(heure, v));
+            }
+        }
+    }
+    m_statsRecherche = stats;
+
+    Itineraire resultat;
+    resultat.heureDepart = heureDepart;
+    resultat.atteignable = meilleure != infini;
+    resultat.duree = resultat.atteignable ? meilleure - heureDepart : numeric_limits<unsigned int>::max();
+    if (resultat.atteignable)
+    {
+        vector<uint32_t> chemin;
+        for (uint32_t u = sortie; u != infini; u = pred[u]) chemin.insert(chemin.begin(), u);
+        auto troncon = [&](Troncon::Mode p_mode, unsigned int p_de, unsigned int p_vers, uint32_t p_voyage,
+                           uint32_t p_depart, uint32_t p_arrivee)
+        {
+            Troncon t;
+            t.mode = p_mode;
+            t.stationDepart = p_de;
+            t.stationArrivee = p_vers;
+            t.voyage = p_voyage;
+            t.ligne = p_voyage == Troncon::aucunVoyage ? 0 : m_ligneDuVoyage[p_voyage];
+            t.heureDepart = p_depart;
+            t.heureArrivee = p_arrivee;
+            return t;
+        };
+        resultat.troncons.push_back(troncon(Troncon::MARCHE, stationIdOrigine, m_reseau.getIdDeStation(stationDe[chemin[0]]),
+                                            Troncon::aucunVoyage, heureDepart, arrivee[chemin[0]]));
+        for (size_t i = 1; i < chemin.size(); ++i)
+        {
+            uint32_t u = chemin[i - 1], v = chemin[i];
+            Troncon &dernier = resultat.troncons.back();
+            if (voyage[v] != Troncon::aucunVoyage && dernier.voyage == voyage[v])
+            {
+                dernier.stationArrivee = m_reseau.getIdDeStation(stationDe[v]);
+                dernier.heureArrivee = arrivee[v];
+            }
+            else
+                resultat.troncons.push_back(troncon(voyage[v] == Troncon::aucunVoyage ? Troncon::MARCHE : Troncon::AUTOBUS,
+                                                    m_reseau.getIdDeStation(stationDe[u]),
+                                                    m_reseau.getIdDeStation(stationDe[v]), voyage[v],
+                                                    voyage[v] == Troncon::aucunVoyage ? arrivee[u] : depart[v], arrivee[v]));
+        }
+        resultat.troncons.push_back(troncon(Troncon::MARCHE, m_reseau.getIdDeStation(stationDe[chemin.back()]),
+                                            stationIdDestination, Troncon::aucunVoyage, arrivee[chemin.back()], meilleure));
+    }
+
+    gettimeofday(&tv2, 0);
+    p_tempsExecution = tempsEcoule(tv1, tv2);
+    return resultat;
+}
+
+void PatronsTransfert::afficherItineraire(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire,
+                                          std::ostream &p_flux) const
+{
+    ::afficherItineraire(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+void PatronsTransfert::ecrireItineraireJSON(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire,
+                                            std::ostream &p_flux) const
+{
+    ::ecrireItineraireJSON(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+size_t PatronsTransfert::getNbNoeuds() const
+{
+    size_t nb = 0;
+    for (auto &patrons : m_patrons) nb += patrons.noeuds.size();
+    return nb;
+}
+
+size_t PatronsTransfert::getNbLignesDirectes() const
+{
+    return m_lignesDirectes.size();
+}
+
+size_t PatronsTransfert::getNbArcsOrigineVersStations() const
+{
+    return m_accesOrigine.size();
+}
+
+size_t PatronsTransfert::getNbArcsStationsVersDestination() const
+{
+    return m_stationsVersDestination.size();
+}
+
+double PatronsTransfert::getDistMaxMarche() const
+{
+    return distanceMaxMarche;
+}
+
+const StatistiquesRecherche & PatronsTransfert::getStatistiquesRecherche() const
+{
+    return m_statsRecherche;
+}
@@ -0,0 +1,109 @@
+//
+//  patronsTransfert.h
+//  Patrons de transfert précalculés sur ReseauStations pour des requêtes de quelques millisecondes
+//
+
+#ifndef TP2_PATRONSTRANSFERT_H
+#define TP2_PATRONSTRANSFERT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+#include "DonneesGTFS.h"
+#include "itineraire.h"
+#include "reseauStations.h"
+#include "statistiques.h"
+
+//! \brief Patrons de transfert (transfer patterns) du réseau par stations
+//! \note un patron est la suite des stations où un itinéraire optimal change de mode ou d'autobus.
+//! Pour chaque station source, PatronsTransfert::precalculer() calcule l'arbre des plus courts chemins
+//! de ReseauStations à chaque heure de départ utile de la fenêtre d'accès (l'heure de départ du point origine
+//! plus la durée maximale de marche) et fusionne les patrons obtenus dans un arbre préfixe par source.
+//! \note une requête n'explore que le petit graphe formé des patrons (stations d'accès -> stations de sortie);
+//! chaque tronçon d'autobus y est évalué par une table de trajets directs (voyages de même séquence de stations).
+//! Les itinéraires trouvés sont toujours réalisables; ils sont optimaux aux heures échantillonnées.
+//! \note le réseau passé au constructeur doit survivre à cet objet
+class PatronsTransfert
+{
+
+public:
+    PatronsTransfert(const DonneesGTFS &, const ReseauStations &);
+    void precalculer(unsigned int = 0, unsigned int = 0);
+    void sauvegarder(const std::string &) const;
+    void charger(const std::string &);
+    bool estPrecalcule() const;
+    void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
+    void enleverArcsOrigineDestination();
+    Itineraire calculerItineraire(long &) const;
+    void afficherItineraire(const DonneesGTFS &, const Itineraire &, std::ostream & = std::cout) const;
+    void ecrireItineraireJSON(const DonneesGTFS &, const Itineraire &, std::ostream &) const;
+    size_t getNbNoeuds() const;
+    size_t getNbLignesDirectes() const;
+    size_t getNbArcsOrigineVersStations() const;
+    size_t getNbArcsStationsVersDestination() const;
+    double getDistMaxMarche() const;
+    const StatistiquesRecherche & getStatistiquesRecherche() const;
+
+private:
+
+    //! \brief un noeud de l'arbre préfixe des patrons d'une source; la racine (indice 0) est la source
+    struct Noeud
+    {
+        uint32_t station; //indice de station de ReseauStations
+        uint32_t parent; //indice du noeud parent
+        uint32_t marche; //durée de marche depuis la station du parent, ou parAutobus
+    };
+
+    struct Patrons
+    {
+        std::vector<Noeud> noeuds;
+        std::vector<uint32_t> parStation; //les indices des noeuds, triés par station
+    };
+
+    //! \brief voyages desservant la même séquence de stations sans se dépasser
+    struct LigneDirecte
+    {
+        std::vector<uint32_t> voyages; //triés par heure de départ
+        std::vector<uint32_t> heures; //heures[position * voyages.size() + k]: passage du voyage k à la position
+    };
+
+    struct Passage
+    {
+        uint32_t ligne; //indice dans m_lignesDirectes
+        uint32_t position; //position de la station dans la séquence de la ligne
+    };
+
+    Patrons calculerPatrons(uint32_t, unsigned int) const;
+    static void indexerParStation(Patrons &);
+    uint32_t trajetDirect(uint32_t, uint32_t, uint32_t, uint32_t &, uint32_t &) const;
+    uint64_t empreinte() const;
+
+    const ReseauStations &m_reseau;
+    std::vector<Patrons> m_patrons; //par station source (vide tant que rien n'est précalculé)
+    unsigned int m_pasEchantillonnage;
+
+    std::vector<LigneDirecte> m_lignesDirectes;
+    std::vector<uint32_t> m_debutPassages; //les passages à la station s sont m_passages[m_debutPassages[s]] à m_passages[m_debutPassages[s+1]-1]
+    std::vector<Passage> m_passages; //triés par ligne puis par position pour chaque station
+    std::vector<std::string> m_idDuVoyage; //dans l'ordre de getVoyages(), comme ReseauStations
+    std::vector<unsigned int> m_ligneDuVoyage;
+
+    bool m_origine_dest_ajoute; //indique si on a ajouté le point origine et le point destination
+    std::vector<std::pair<uint32_t, uint32_t> > m_accesOrigine; //(station, durée de marche depuis le point origine)
+    std::vector<uint32_t> m_marcheVersDestination; //par station: durée de marche vers le point destination (ou infini)
+    std::vector<uint32_t> m_stationsVersDestination; //les stations dont m_marcheVersDestination est fini
+    std::vector<double> m_distancesOrigine; //par station: distance (TableCoordonnees) au point origine de la requête
+    std::vector<double> m_distancesDestination;
+
+    mutable StatistiquesRecherche m_statsRecherche; //compteurs de la dernière recherche (si GTFS_STATS est défini)
+
+    const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure
+    const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
+    const unsigned int stationIdOrigine = 0; //stationId donné au point origine dans les itinéraires
+    const unsigned int stationIdDestination = 1; //stationId donné au point destination dans les itinéraires
+
+};
+
+#endif //TP2_PATRONSTRANSFERT_H
@@ -0,0 +1,456 @@
+//
+//  reseauStations.cpp
+//  Modèle dépendant du temps du réseau GTFS: un sommet par station, des arcs portant une table d'horaires
+//
+
+#include "reseauStations.h"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include <limits>
+#include <stdexcept>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace
+{
+    const uint32_t infini = numeric_limits<uint32_t>::max();
+    const uint32_t predOrigine = infini; //prédécesseur d'une station atteinte à pieds depuis le point origine
+    const uint32_t parMarche = infini; //connexion d'une station atteinte par un arc de marche
+
+    uint32_t secondes(const Heure &p_heure)
+    {
+        return static_cast<uint32_t>(p_heure - Heure(0, 0, 0));
+    }
+
+    //une connexion élémentaire avant regroupement par arc
+    struct ConnexionBrute
+    {
+        uint32_t de;
+        uint32_t vers;
+        uint32_t depart;
+        uint32_t arrivee;
+        uint32_t voyage;
+
+        bool operator<(const ConnexionBrute &p_autre) const
+        {
+            return tie(de, vers, depart, arrivee) < tie(p_autre.de, p_autre.vers, p_autre.depart, p_autre.arrivee);
+        }
+    };
+
+    long tempsEcoule(const timeval &tv1, const timeval &tv2)
+    {
+        return 1000000L * (tv2.tv_sec - tv1.tv_sec) + (tv2.tv_usec - tv1.tv_usec);
+    }
+}
+
+//! \brief construit le réseau de stations à partir des données GTFS
+//! \param[in] p_gtfs: un objet DonneesGTFS dont tous les arrêts et transferts ont été ajoutés
+//! \throws logic_error si une connexion arrive avant de partir
+//! \post un sommet par station ayant au moins un arrêt; pour chaque paire de stations consécutives d'un voyage,
+//! un arc dont la table de connexions ne garde que les connexions non dominées (FIFO)
+//! \post un arc de marche par transfert entre deux stations du réseau
+ReseauStations::ReseauStations(const DonneesGTFS &p_gtfs)
+    : m_heureDepart(secondes(p_gtfs.getTempsDebut())), m_origine_dest_ajoute(false)
+{
+    const map<unsigned int, Station> &stations = p_gtfs.getStations();
+    for (auto &s : stations)
+    {
+        m_indiceDeStation[s.first] = static_cast<uint32_t>(m_idDeStation.size());
+        m_idDeStation.push_back(s.first);
+        m_coordsStations.ajouter(s.second.getCoords());
+    }
+
+    vector<ConnexionBrute> brutes;
+    for (auto &v : p_gtfs.getVoyages())
+    {
+        uint32_t indiceVoyage = static_cast<uint32_t>(m_idDuVoyage.size());
+        m_idDuVoyage.push_back(v.first);
+        m_ligneDuVoyage.push_back(v.second.getLigne());
+        const set<Arret::Ptr, Voyage::compArret> &arrets = v.second.getArrets();
+        for (auto it = arrets.begin(); it != arrets.end(); ++it)
+        {
+            if (it == arrets.begin()) continue;
+            const Arret::Ptr &precedent = *prev(it);
+            ConnexionBrute c;
+            c.de = m_indiceDeStation.at(precedent->getStationId());
+            c.vers = m_indiceDeStation.at((*it)->getStationId());
+            c.depart = secondes(precedent->getHeureArrivee());
+            c.arrivee = secondes((*it)->getHeureArrivee());
+            c.voyage = indiceVoyage;
+            if (c.arrivee < c.depart) throw logic_error("ReseauStations::ReseauStations(): connexion de poids négatif");
+            brutes.push_back(c);
+        }
+    }
+    sort(brutes.begin(), brutes.end());
+
+    //regroupement par arc (de, vers) et élimination des connexions dominées
+    vector<pair<uint32_t, Arc> > arcs; //(station d'origine, arc)
+    for (size_t debut = 0; debut < brutes.size();)
+    {
+        size_t fin = debut;
+        while (fin < brutes.size() && brutes[fin].de == brutes[debut].de && brutes[fin].vers == brutes[debut].vers) ++fin;
+        Arc arc;
+        arc.destination = brutes[debut].vers;
+        arc.premiereConnexion = static_cast<uint32_t>(m_connexions.size());
+        arc.dureeMarche = 0;
+        uint32_t arriveeMin = infini;
+        for (size_t i = fin; i-- > debut;)
+        {
+            if (brutes[i].arrivee >= arriveeMin) continue; //un départ plus tardif arrive aussi tôt
+            arriveeMin = brutes[i].arrivee;
+            Connexion c = {brutes[i].depart, brutes[i].arrivee, brutes[i].voyage};
+            m_connexions.push_back(c);
+        }
+        reverse(m_connexions.begin() + arc.premiereConnexion, m_connexions.end());
+        arc.nbConnexions = static_cast<uint32_t>(m_connexions.size()) - arc.premiereConnexion;
+        arcs.push_back(make_pair(brutes[debut].de, arc));
+        debut = fin;
+    }
+
+    for (auto &t : p_gtfs.getTransferts())
+    {
+        auto de = m_indiceDeStation.find(get<0>(t));
+        auto vers = m_indiceDeStation.find(get<1>(t));
+        if (de == m_indiceDeStation.end() || vers == m_indiceDeStation.end()) continue;
+        Arc arc = {vers->second, 0, 0, get<2>(t)};
+        arcs.push_back(make_pair(de->second, arc));
+    }
+
+    //représentation compacte des listes d'adjacence
+    stable_sort(arcs.begin(), arcs.end(),
+                [](const pair<uint32_t, Arc> &a, const pair<uint32_t, Arc> &b) { return a.first < b.first; });
+    m_debutArcs.assign(m_idDeStation.size() + 1, 0);
+    for (auto &a : arcs) ++m_debutArcs[a.first + 1];
+    for (size_t s = 0; s < m_idDeStation.size(); ++s) m_debutArcs[s + 1] += m_debutArcs[s];
+    m_arcs.reserve(arcs.size());
+    for (auto &a : arcs) m_arcs.push_back(a.second);
+
+    m_marcheVersDestination.assign(m_idDeStation.size(), infini);
+}
+
+//! \brief mémorise les stations accessibles à pieds du point origine et celles d'où on peut marcher au point destination
+//! \param[in] p_gtfs: les données GTFS ayant servi à construire ce réseau
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \throws logic_error si un point origine et un point destination sont déjà présents
+//! \note aucun arc n'est ajouté: l'accès et la sortie sont des tables consultées par la recherche
+//! \note les distances sont d'abord calculées par lots (TableCoordonnees); operator- ne sert qu'aux stations proches
+void ReseauStations::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                                   const Coordonnees &p_pointDestination)
+{
+    if (m_origine_dest_ajoute)
+        throw logic_error("ReseauStations::ajouterArcsOrigineDestination(): origine et destination déjà présentes");
+    m_coordsStations.distancesDepuis(p_pointOrigine, m_distancesOrigine);
+    m_coordsStations.distancesDepuis(p_pointDestination, m_distancesDestination);
+    const double seuil = distanceMaxMarche + TableCoordonnees::margeOperateur;
+    for (auto &s : p_gtfs.getStations())
+    {
+        uint32_t indice = m_indiceDeStation.at(s.first);
+        if (m_distancesOrigine[indice] <= seuil)
+        {
+            double distanceOrigine = s.second.getCoords() - p_pointOrigine;
+            if (distanceOrigine <= distanceMaxMarche)
+                m_accesOrigine.push_back(
+                    make_pair(indice, static_cast<uint32_t>(distanceOrigine / vitesseDeMarche * 3600)));
+        }
+        if (m_distancesDestination[indice] > seuil) continue;
+        double distanceDestination = p_pointDestination - s.second.getCoords();
+        if (distanceDestination <= distanceMaxMarche)
+        {
+            m_marcheVersDestination[indice] = static_cast<uint32_t>(distanceDestination / vitesseDeMarche * 3600);
+            m_stationsVersDestination.push_back(indice);
+        }
+    }
+    m_origine_dest_ajoute = true;
+}
+
+//! \brief Remet ReseauStations dans l'état qu'il était avant ReseauStations::ajouterArcsOrigineDestination()
+void ReseauStations::enleverArcsOrigineDestination()
+{
+    for (uint32_t s : m_stationsVersDestination) m_marcheVersDestination[s] = infini;
+    m_stationsVersDestination.clear();
+    m_accesOrigine.clear();
+    m_origine_dest_ajoute = false;
+}
+
+//! \brief heure d'arrivée au bout d'un arc lorsqu'on est à son origine à l'heure p_heure
+//! \param[out] p_connexion: l'indice de la connexion utilisée (parMarche pour un arc de marche)
+//! \return l'heure d'arrivée, ou infini si aucune connexion ne part à p_heure ou plus tard
+uint32_t ReseauStations::arriveeParArc(const Arc &p_arc, uint32_t p_heure, uint32_t &p_connexion) const
+{
+    if (p_arc.nbConnexions == 0)
+    {
+        p_connexion = parMarche;
+        return p_heure + p_arc.dureeMarche;
+    }
+    auto debut = m_connexions.begin() + p_arc.premiereConnexion;
+    auto fin = debut + p_arc.nbConnexions;
+    auto c = lower_bound(debut, fin, p_heure, [](const Connexion &c, uint32_t h) { return c.depart < h; });
+    if (c == fin) return infini;
+    p_connexion = static_cast<uint32_t>(c - m_connexions.begin());
+    return c->arrivee;
+}
+
+//! \brief Dijkstra dépendant du temps (file de priorité binaire) à partir de plusieurs stations sources
+//! \param[in] p_sources: les paires (station, heure d'arrivée à cette station)
+//! \param[in] p_marcheVersDestination: par station, la durée de marche vers le point destination (infini sinon);
+//! nullptr pour explorer tout le réseau
+//! \param[out] p_arbre: l'arbre des plus courts chemins (seulement les stations fixées y sont exactes)
+//! \param[out] p_sortie: la station d'où on marche vers le point destination (infini si aucune)
+//! \param[out] p_stats: les compteurs de la recherche, s'ils sont demandés
+//! \return l'heure d'arrivée au point destination (infini si non atteignable ou si p_marcheVersDestination est nul)
+//! \note avec un point destination, la recherche s'arrête dès que la prochaine station de la file
+//! ne peut plus améliorer l'arrivée à destination
+uint32_t ReseauStations::explorer(const vector<pair<uint32_t, uint32_t> > &p_sources,
+                                  const vector<uint32_t> *p_marcheVersDestination, Arbre &p_arbre,
+                                  uint32_t &p_sortie, StatistiquesRecherche *p_stats) const
+{
+    const size_t nbStations = m_idDeStation.size();
+    p_arbre.arrivee.assign(nbStations, infini);
+    p_arbre.predStation.assign(nbStations, predOrigine);
+    p_arbre.predConnexion.assign(nbStations, parMarche);
+    p_arbre.ordre.clear();
+    StatistiquesRecherche stats;
+    typedef pair<uint32_t, uint32_t> Entree; //(heure d'arrivée, station)
+    priority_queue<Entree, vector<Entree>, greater<Entree> > file;
+
+    for (auto &source : p_sources)
+    {
+        if (source.second < p_arbre.arrivee[source.first])
+        {
+            p_arbre.arrivee[source.first] = source.second;
+            file.push(Entree(source.second, source.first));
+            GTFS_STAT(++stats.insertionsFile);
+        }
+    }
+
+    uint32_t meilleure = infini;
+    p_sortie = infini;
+    while (!file.empty())
+    {
+        GTFS_STAT(stats.tailleMaxFile = max<unsigned long>(stats.tailleMaxFile, file.size()));
+        Entree e = file.top();
+        file.pop();
+        GTFS_STAT(++stats.retraitsFile);
+        if (e.first != p_arbre.arrivee[e.second]) continue; //entrée périmée
+        if (e.first >= meilleure) break;
+        GTFS_STAT(++stats.sommetsFixes);
+        uint32_t s = e.second;
+        p_arbre.ordre.push_back(s);
+        if (p_marcheVersDestination && (*p_marcheVersDestination)[s] != infini &&
+            e.first + (*p_marcheVersDestination)[s] < meilleure)
+        {
+            meilleure = e.first + (*p_marcheVersDestination)[s];
+            p_sortie = s;
+        }
+        for (uint32_t a = m_debutArcs[s]; a < m_debutArcs[s + 1]; ++a)
+        {
+            GTFS_STAT(++stats.arcsRelaches);
+            uint32_t connexion;
+            uint32_t heure = arriveeParArc(m_arcs[a], e.first, connexion);
+            uint32_t v = m_arcs[a].destination;
+            if (heure < p_arbre.arrivee[v])
+            {
+                p_arbre.arrivee[v] = heure;
+                p_arbre.predStation[v] = s;
+                p_arbre.predConnexion[v] = connexion;
+                file.push(Entree(heure, v));
+                GTFS_STAT(++stats.insertionsFile);
+            }
+        }
+    }
+    if (p_stats) *p_stats = stats;
+    return meilleure;
+}
+
+//! \brief Calcule l'arbre des plus courts chemins de toutes les stations à partir d'une station
+//! \param[in] p_station: l'indice de la station de départ
+//! \param[in] p_heure: l'heure de départ, en secondes depuis minuit
+//! \param[out] p_arbre: l'arbre des plus courts chemins; p_arbre.ordre donne les stations atteintes par heure croissante
+//! \throws logic_error si la station n'existe pas
+void ReseauStations::calculerArbre(uint32_t p_station, uint32_t p_heure, Arbre &p_arbre) const
+{
+    if (p_station >= m_idDeStation.size()) throw logic_error("ReseauStations::calculerArbre(): station inexistante");
+    uint32_t sortie;
+    explorer(vector<pair<uint32_t, uint32_t> >(1, make_pair(p_station, p_heure)), nullptr, p_arbre, sortie, nullptr);
+}
+
+//! \brief Les heures auxquelles il peut valoir la peine de partir d'une station, dans l'intervalle [p_debut, p_fin]
+//! \return les heures de départ triées des connexions qui quittent la station ou une station voisine à pieds
+//! (moins la durée de marche), en secondes depuis minuit
+vector<uint32_t> ReseauStations::heuresDeDepart(uint32_t p_station, uint32_t p_debut, uint32_t p_fin) const
+{
+    vector<uint32_t> heures;
+    auto ajouter = [&](uint32_t p_de, uint32_t p_marche)
+    {
+        for (uint32_t a = m_debutArcs[p_de]; a < m_debutArcs[p_de + 1]; ++a)
+            for (uint32_t c = 0; c < m_arcs[a].nbConnexions; ++c)
+            {
+                uint32_t depart = m_connexions[m_arcs[a].premiereConnexion + c].depart;
+                if (depart >= p_debut + p_marche && depart - p_marche <= p_fin) heures.push_back(depart - p_marche);
+            }
+    };
+    ajouter(p_station, 0);
+    for (uint32_t a = m_debutArcs[p_station]; a < m_debutArcs[p_station + 1]; ++a)
+        if (m_arcs[a].nbConnexions == 0) ajouter(m_arcs[a].destination, m_arcs[a].dureeMarche);
+    sort(heures.begin(), heures.end());
+    heures.erase(unique(heures.begin(), heures.end()), heures.end());
+    return heures;
+}
+
+//! \brief Le voyage d'une connexion d'un arbre (Troncon::aucunVoyage pour un déplacement à pieds)
+uint32_t ReseauStations::voyageDeConnexion(uint32_t p_connexion) const
+{
+    return p_connexion == parMarche ? Troncon::aucunVoyage : m_connexions[p_connexion].voyage;
+}
+
+//! \brief Trouve l'itinéraire le plus rapide du point origine au point destination préalablement choisis
+//! \param[out] p_tempsExecution: le temps d'exécution de la recherche, en microsecondes
+//! \return l'itinéraire sous forme de tronçons (marche ou autobus)
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés
+//! \note voir ReseauStations::explorer()
+Itineraire ReseauStations::calculerItineraire(long &p_tempsExecution) const
+{
+    if (!m_origine_dest_ajoute)
+        throw logic_error("ReseauStations::calculerItineraire(): il faut ajouter un point origine et un point destination");
+
+    timeval tv1, tv2;
+    gettimeofday(&tv1, 0);
+    vector<pair<uint32_t, uint32_t> > sources;
+    for (auto &acces : m_accesOrigine) sources.push_back(make_pair(acces.first, m_heureDepart + acces.second));
+    Arbre arbre;
+    uint32_t sortie = infini;
+    uint32_t meilleure = explorer(sources, &m_marcheVersDestination, arbre, sortie, &m_statsRecherche);
+    const vector<uint32_t> &arrivee = arbre.arrivee;
+    const vector<uint32_t> &predStation = arbre.predStation;
+    const vector<uint32_t> &predConnexion = arbre.predConnexion;
+
+    Itineraire resultat;
+    resultat.heureDepart = m_heureDepart;
+    resultat.atteignable = meilleure != infini;
+    resultat.duree = resultat.atteignable ? meilleure - m_heureDepart : numeric_limits<unsigned int>::max();
+    if (resultat.atteignable)
+    {
+        //remonter de la station de sortie jusqu'à une station atteinte depuis le point origine
+        size_t longueur = 0;
+        for (uint32_t s = sortie; s != predOrigine; s = predStation[s]) ++longueur;
+        vector<uint32_t> chemin(longueur);
+        for (uint32_t s = sortie; s != predOrigine; s = predStation[s]) chemin[--longueur] = s;
+
+        resultat.troncons.push_back(troncon(Troncon::MARCHE, infini, chemin[0], Troncon::aucunVoyage, m_heureDepart,
+                                            arrivee[chemin[0]]));
+        for (size_t i = 1; i < chemin.size(); ++i)
+        {
+            uint32_t c = predConnexion[chemin[i]];
+            if (c == parMarche)
+            {
+                resultat.troncons.push_back(troncon(Troncon::MARCHE, chemin[i - 1], chemin[i], Troncon::aucunVoyage,
+                                                    arrivee[chemin[i - 1]], arrivee[chemin[i]]));
+                continue;
+            }
+            const Connexion &connexion = m_connexions[c];
+            Troncon &dernier = resultat.troncons.back();
+            if (dernier.mode == Troncon::AUTOBUS && dernier.voyage == connexion.voyage)
+            {
+                //on reste dans le même autobus
+                dernier.stationArrivee = m_idDeStation[chemin[i]];
+                dernier.heureArrivee = connexion.arrivee;
+            }
+            else
+                resultat.troncons.push_back(troncon(Troncon::AUTOBUS, chemin[i - 1], chemin[i], connexion.voyage,
+                                                    connexion.depart, connexion.arrivee));
+        }
+        resultat.troncons.push_back(troncon(Troncon::MARCHE, chemin.back(), infini, Troncon::aucunVoyage,
+                                            arrivee[chemin.back()], meilleure));
+    }
+
+    gettimeofday(&tv2, 0);
+    p_tempsExecution = tempsEcoule(tv1, tv2);
+    return resultat;
+}
+
+//construit un tronçon; les indices de station infini désignent le point origine (en départ) ou destination (en arrivée)
+Troncon ReseauStations::troncon(Troncon::Mode p_mode, uint32_t p_de, uint32_t p_vers, uint32_t p_voyage,
+                                uint32_t p_heureDepart, uint32_t p_heureArrivee) const
+{
+    Troncon t;
+    t.mode = p_mode;
+    t.stationDepart = p_de == infini ? stationIdOrigine : m_idDeStation[p_de];
+    t.stationArrivee = p_vers == infini ? stationIdDestination : m_idDeStation[p_vers];
+    t.voyage = p_voyage;
+    t.ligne = p_voyage == Troncon::aucunVoyage ? 0 : m_ligneDuVoyage[p_voyage];
+    t.heureDepart = p_heureDepart;
+    t.heureArrivee = p_heureArrivee;
+    return t;
+}
+
+void ReseauStations::afficherItineraire(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire,
+                                        std::ostream &p_flux) const
+{
+    ::afficherItineraire(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+void ReseauStations::ecrireItineraireJSON(const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire,
+                                          std::ostream &p_flux) const
+{
+    ::ecrireItineraireJSON(p_gtfs, m_idDuVoyage, p_itineraire, p_flux);
+}
+
+size_t ReseauStations::getNbSommets() const
+{
+    return m_idDeStation.size();
+}
+
+size_t ReseauStations::getNbArcs() const
+{
+    return m_arcs.size();
+}
+
+size_t ReseauStations::getNbConnexions() const
+{
+    return m_connexions.size();
+}
+
+size_t ReseauStations::getNbArcsOrigineVersStations() const
+{
+    return m_accesOrigine.size();
+}
+
+size_t ReseauStations::getNbArcsStationsVersDestination() const
+{
+    return m_stationsVersDestination.size();
+}
+
+double ReseauStations::getDistMaxMarche() const
+{
+    return distanceMaxMarche;
+}
+
+const StatistiquesRecherche & ReseauStations::getStatistiquesRecherche() const
+{
+    return m_statsRecherche;
+}
+
+unsigned int ReseauStations::getIdDeStation(uint32_t p_indice) const
+{
+    return m_idDeStation.at(p_indice);
+}
+
+uint32_t ReseauStations::getIndiceDeStation(unsigned int p_stationId) const
+{
+    return m_indiceDeStation.at(p_stationId);
+}
+
+//! \return les coordonnées des stations, par indice de station (voir getIndiceDeStation())
+const TableCoordonnees &ReseauStations::getCoordsStations() const
+{
+    return m_coordsStations;
+}
+
+unsigned int ReseauStations::getHeureDepart() const
+{
+    return m_heureDepart;
+}
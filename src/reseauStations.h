@@ -0,0 +1,110 @@
+//
+//  reseauStations.h
+//  Modèle dépendant du temps du réseau GTFS: un sommet par station, des arcs portant une table d'horaires
+//
+
+#ifndef TP2_RESEAUSTATIONS_H
+#define TP2_RESEAUSTATIONS_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <iostream>
+
+#include "DonneesGTFS.h"
+#include "itineraire.h"
+#include "statistiques.h"
+#include "tableCoordonnees.h"
+
+//! \brief Réseau GTFS dont les sommets sont les stations (et non les arrêts, comme dans ReseauGTFS)
+//! \note un arc (u,v) d'autobus porte la table triée des connexions (départ de u, arrivée à v, voyage);
+//! son coût est évalué pendant la recherche par une recherche dichotomique sur l'heure d'arrivée à u.
+//! Un arc de transfert a une durée de marche constante. L'attente en station est implicite.
+//! \note offre la même interface origine/destination/itinéraire que ReseauGTFS; l'heure d'arrivée peut être
+//! légèrement meilleure, car on n'attend pas un arrêt avant de quitter à pieds une station atteinte à pieds
+class ReseauStations
+{
+
+public:
+    //! \brief arbre des plus courts chemins, indexé par station
+    struct Arbre
+    {
+        std::vector<uint32_t> arrivee; //heure d'arrivée (infini si non atteinte)
+        std::vector<uint32_t> predStation; //station précédente (infini pour une source)
+        std::vector<uint32_t> predConnexion; //connexion empruntée depuis predStation (infini pour la marche)
+        std::vector<uint32_t> ordre; //les stations fixées, par heure d'arrivée croissante
+    };
+
+    ReseauStations(const DonneesGTFS &);
+    void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
+    void enleverArcsOrigineDestination();
+    Itineraire calculerItineraire(long &) const;
+    void afficherItineraire(const DonneesGTFS &, const Itineraire &, std::ostream & = std::cout) const;
+    void ecrireItineraireJSON(const DonneesGTFS &, const Itineraire &, std::ostream &) const;
+    size_t getNbSommets() const;
+    size_t getNbArcs() const;
+    size_t getNbConnexions() const;
+    size_t getNbArcsOrigineVersStations() const;
+    size_t getNbArcsStationsVersDestination() const;
+    double getDistMaxMarche() const;
+    const StatistiquesRecherche & getStatistiquesRecherche() const;
+
+    //pour les structures précalculées (PatronsTransfert)
+    void calculerArbre(uint32_t, uint32_t, Arbre &) const;
+    std::vector<uint32_t> heuresDeDepart(uint32_t, uint32_t, uint32_t) const;
+    uint32_t voyageDeConnexion(uint32_t) const;
+    unsigned int getIdDeStation(uint32_t) const;
+    uint32_t getIndiceDeStation(unsigned int) const;
+    const TableCoordonnees &getCoordsStations() const;
+    unsigned int getHeureDepart() const;
+
+private:
+
+    struct Connexion
+    {
+        uint32_t depart; //en secondes depuis minuit
+        uint32_t arrivee;
+        uint32_t voyage; //indice dans m_idDuVoyage
+    };
+
+    struct Arc
+    {
+        uint32_t destination; //indice de station
+        uint32_t premiereConnexion; //indice dans m_connexions
+        uint32_t nbConnexions; //0 pour un arc de marche
+        uint32_t dureeMarche; //en secondes, pour un arc de marche
+    };
+
+    uint32_t explorer(const std::vector<std::pair<uint32_t, uint32_t> > &, const std::vector<uint32_t> *, Arbre &,
+                      uint32_t &, StatistiquesRecherche *) const;
+    uint32_t arriveeParArc(const Arc &, uint32_t, uint32_t &) const;
+    Troncon troncon(Troncon::Mode, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) const;
+
+    std::vector<uint32_t> m_debutArcs; //les arcs sortant de la station s sont m_arcs[m_debutArcs[s]] à m_arcs[m_debutArcs[s+1]-1]
+    std::vector<Arc> m_arcs;
+    std::vector<Connexion> m_connexions; //pour chaque arc, triées par départ croissant et arrivée strictement croissante
+    std::vector<unsigned int> m_idDeStation; //m_idDeStation[s] est le stationId de la station d'indice s
+    std::unordered_map<unsigned int, uint32_t> m_indiceDeStation;
+    TableCoordonnees m_coordsStations; //les coordonnées des stations, par indice de station
+    std::vector<double> m_distancesOrigine; //par station: distance (TableCoordonnees) au point origine de la requête
+    std::vector<double> m_distancesDestination;
+    std::vector<std::string> m_idDuVoyage; //m_idDuVoyage[v] est le trip_id du voyage d'indice v
+    std::vector<unsigned int> m_ligneDuVoyage; //m_ligneDuVoyage[v] est l'identifiant de la ligne du voyage d'indice v
+    unsigned int m_heureDepart; //l'heure de départ du point origine (getTempsDebut()), en secondes depuis minuit
+
+    bool m_origine_dest_ajoute; //indique si on a ajouté le point origine et le point destination
+    std::vector<std::pair<uint32_t, uint32_t> > m_accesOrigine; //(station, durée de marche depuis le point origine)
+    std::vector<uint32_t> m_marcheVersDestination; //par station: durée de marche vers le point destination (ou infini)
+    std::vector<uint32_t> m_stationsVersDestination; //les stations dont m_marcheVersDestination est fini
+
+    mutable StatistiquesRecherche m_statsRecherche; //compteurs de la dernière recherche (si GTFS_STATS est défini)
+
+    const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure
+    const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
+    const unsigned int stationIdOrigine = 0; //stationId donné au point origine dans les itinéraires
+    const unsigned int stationIdDestination = 1; //stationId donné au point destination dans les itinéraires
+
+};
+
+#endif //TP2_RESEAUSTATIONS_H
@@ -0,0 +1,239 @@
+//
+//  statistiques.cpp
+//  Compteurs et chronométrage de la recherche, de la construction du réseau et du chargement
+//
+
+#include "statistiques.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    ostream *fluxTrace = nullptr;
+    const chrono::steady_clock::time_point origineTrace = chrono::steady_clock::now();
+}
+
+StatistiquesRecherche::StatistiquesRecherche()
+    : sommetsFixes(0), arcsRelaches(0), insertionsFile(0), retraitsFile(0), tailleMaxFile(0)
+{
+}
+
+StatistiquesConstruction::StatistiquesConstruction()
+    : arcsVoyages(0), arcsAttente(0), arcsTransferts(0), renumerotation(0)
+{
+}
+
+StatistiquesChargement::StatistiquesChargement()
+    : lignes(0), stations(0), services(0), voyages(0), arrets(0), transferts(0)
+{
+}
+
+ostream &operator<<(ostream &p_flux, const StatistiquesRecherche &p_stats)
+{
+    return p_flux << "sommets fixés: " << p_stats.sommetsFixes << ", arcs relâchés: " << p_stats.arcsRelaches
+           << ", insertions: " << p_stats.insertionsFile << ", retraits: " << p_stats.retraitsFile
+           << ", taille max de la file: " << p_stats.tailleMaxFile;
+}
+
+ostream &operator<<(ostream &p_flux, const StatistiquesConstruction &p_stats)
+{
+    return p_flux << "arcs des voyages: " << p_stats.arcsVoyages << " us, arcs d'attente: " << p_stats.arcsAttente
+           << " us, arcs de transfert: " << p_stats.arcsTransferts << " us, renumérotation: "
+           << p_stats.renumerotation << " us";
+}
+
+ostream &operator<<(ostream &p_flux, const StatistiquesChargement &p_stats)
+{
+    return p_flux << "lignes: " << p_stats.lignes << " us, stations: " << p_stats.stations << " us, services: "
+           << p_stats.services << " us, voyages: " << p_stats.voyages << " us, arrets: " << p_stats.arrets
+           << " us, transferts: " << p_stats.transferts << " us";
+}
+
+Chronometre::Chronometre()
+    : m_debut(chrono::steady_clock::now())
+{
+}
+
+//! \return le temps écoulé depuis la construction (ou le dernier arreter()), en microsecondes
+long Chronometre::ecoule() const
+{
+    return static_cast<long>(
+        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - m_debut).count());
+}
+
+//! \brief termine une phase et redémarre le chronomètre
+//! \param[in] p_phase: le nom de la phase, écrit dans la trace si elle est active
+//! \return la durée de la phase, en microsecondes
+long Chronometre::arreter(const char *p_phase)
+{
+    chrono::steady_clock::time_point fin = chrono::steady_clock::now();
+    long duree = static_cast<long>(chrono::duration_cast<chrono::microseconds>(fin - m_debut).count());
+    if (fluxTrace)
+        *fluxTrace << "trace " << chrono::duration_cast<chrono::microseconds>(fin - origineTrace).count() << " "
+                   << p_phase << " " << duree << endl;
+    m_debut = fin;
+    return duree;
+}
+
+//! \brief active (p_flux non nul) ou désactive (p_flux nul) la trace des phases chronométrées
+//! \note chaque ligne de trace a la forme: trace <instant en us depuis le démarrage> <phase> <durée en us>
+void Chronometre::activerTrace(ostream *p_flux)
+{
+    fluxTrace = p_flux;
+}
+
+CompteursMateriel::CompteursMateriel()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        m_descripteurs[i] = -1;
+        m_valeurs[i] = 0;
+    }
+#ifdef __linux__
+    const uint64_t evenements[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < 3; ++i)
+    {
+        perf_event_attr attributs;
+        memset(&attributs, 0, sizeof(attributs));
+        attributs.size = sizeof(attributs);
+        attributs.type = PERF_TYPE_HARDWARE;
+        attributs.config = evenements[i];
+        attributs.disabled = 1;
+        attributs.exclude_kernel = 1;
+        attributs.exclude_hv = 1;
+        m_descripteurs[i] = static_cast<int>(syscall(__NR_perf_event_open, &attributs, 0, -1, -1, 0));
+    }
+#endif
+}
+
+CompteursMateriel::~CompteursMateriel()
+{
+#ifdef __linux__
+    for (int i = 0; i < 3; ++i)
+        if (m_descripteurs[i] >= 0) close(m_descripteurs[i]);
+#endif
+}
+
+bool CompteursMateriel::disponible() const
+{
+    return m_descripteurs[0] >= 0 && m_descripteurs[1] >= 0 && m_descripteurs[2] >= 0;
+}
+
+//! \brief remet les compteurs à zéro et commence à compter
+void CompteursMateriel::demarrer()
+{
+#ifdef __linux__
+    for (int i = 0; i < 3; ++i)
+        if (m_descripteurs[i] >= 0)
+        {
+            ioctl(m_descripteurs[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_descripteurs[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+}
+
+//! \brief arrête de compter et lit les valeurs accumulées depuis demarrer()
+void CompteursMateriel::arreter()
+{
+#ifdef __linux__
+    for (int i = 0; i < 3; ++i)
+        if (m_descripteurs[i] >= 0)
+        {
+            ioctl(m_descripteurs[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t valeur = 0;
+            if (read(m_descripteurs[i], &valeur, sizeof(valeur)) == static_cast<ssize_t>(sizeof(valeur)))
+                m_valeurs[i] = valeur;
+        }
+#endif
+}
+
+uint64_t CompteursMateriel::getCycles() const
+{
+    return m_valeurs[0];
+}
+
+uint64_t CompteursMateriel::getInstructions() const
+{
+    return m_valeurs[1];
+}
+
+uint64_t CompteursMateriel::getDefautsCache() const
+{
+    return m_valeurs[2];
+}
+
+//! \return un champ en Ko de /proc/self/status (VmRSS: la mémoire résidente, VmHWM: son pic), 0 s'il est absent
+long lireMemoireKo(const string &p_champ)
+{
+    ifstream status("/proc/self/status");
+    string ligne;
+    while (getline(status, ligne))
+        if (ligne.compare(0, p_champ.size(), p_champ) == 0)
+            return strtol(ligne.c_str() + p_champ.size(), nullptr, 10);
+    return 0;
+}
+
+//! \brief prend un premier échantillon et démarre le fil d'échantillonnage
+EchantillonneurMemoire::EchantillonneurMemoire(unsigned int p_periodeMs)
+    : m_arret(false), m_debut(lireMemoireKo("VmRSS:")), m_pointe(m_debut), m_periode(max(1u, p_periodeMs))
+{
+    m_fil = thread(&EchantillonneurMemoire::echantillonner, this);
+}
+
+EchantillonneurMemoire::~EchantillonneurMemoire()
+{
+    {
+        lock_guard<mutex> verrou(m_verrou);
+        m_arret = true;
+    }
+    m_reveil.notify_one();
+    m_fil.join();
+}
+
+//! \return la mémoire résidente au début de la période, en Ko
+long EchantillonneurMemoire::getDebut() const
+{
+    lock_guard<mutex> verrou(m_verrou);
+    return m_debut;
+}
+
+//! \return le pic de la mémoire résidente depuis le début de la période (un échantillon est pris maintenant)
+long EchantillonneurMemoire::getPointe() const
+{
+    const long courante = lireMemoireKo("VmRSS:");
+    lock_guard<mutex> verrou(m_verrou);
+    m_pointe = max(m_pointe, courante);
+    return m_pointe;
+}
+
+//! \brief commence une nouvelle période à la mémoire résidente courante
+void EchantillonneurMemoire::reinitialiser()
+{
+    const long courante = lireMemoireKo("VmRSS:");
+    lock_guard<mutex> verrou(m_verrou);
+    m_debut = m_pointe = courante;
+}
+
+//le corps du fil: un échantillon par période jusqu'à la destruction
+void EchantillonneurMemoire::echantillonner()
+{
+    unique_lock<mutex> verrou(m_verrou);
+    while (!m_reveil.wait_for(verrou, m_periode, [this]() { return m_arret; }))
+    {
+        verrou.unlock();
+        const long courante = lireMemoireKo("VmRSS:");
+        verrou.lock();
+        m_pointe = max(m_pointe, courante);
+    }
+}
@@ -0,0 +1,133 @@
+//
+//  statistiques.h
+//  Compteurs et chronométrage de la recherche, de la construction du réseau et du chargement
+//
+//  Les compteurs ne sont compilés que si GTFS_STATS est défini (make STATS=1);
+//  sinon les structures existent mais restent à zéro et GTFS_STAT() ne génère aucun code.
+//
+
+#ifndef TP2_STATISTIQUES_H
+#define TP2_STATISTIQUES_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#ifdef GTFS_STATS
+#define GTFS_STAT(instruction) instruction
+#else
+#define GTFS_STAT(instruction)
+#endif
+
+//! \brief Compteurs d'une exécution de l'algorithme de plus court chemin
+struct StatistiquesRecherche
+{
+    unsigned long sommetsFixes; //sommets dont la distance a été fixée (retirés de la file)
+    unsigned long arcsRelaches;
+    unsigned long insertionsFile;
+    unsigned long retraitsFile;
+    unsigned long tailleMaxFile;
+
+    StatistiquesRecherche();
+};
+
+//! \brief Durées (en microsecondes) des phases du constructeur de ReseauGTFS
+struct StatistiquesConstruction
+{
+    long arcsVoyages;
+    long arcsAttente;
+    long arcsTransferts;
+    long renumerotation;
+
+    StatistiquesConstruction();
+};
+
+//! \brief Durées (en microsecondes) de chacune des méthodes DonneesGTFS::ajouter*
+struct StatistiquesChargement
+{
+    long lignes;
+    long stations;
+    long services;
+    long voyages;
+    long arrets;
+    long transferts;
+
+    StatistiquesChargement();
+};
+
+std::ostream &operator<<(std::ostream &p_flux, const StatistiquesRecherche &p_stats);
+std::ostream &operator<<(std::ostream &p_flux, const StatistiquesConstruction &p_stats);
+std::ostream &operator<<(std::ostream &p_flux, const StatistiquesChargement &p_stats);
+
+//! \brief Chronomètre basé sur l'horloge monotone (std::chrono::steady_clock)
+//! \note si une trace est active (activerTrace()), chaque appel à arreter() y écrit une ligne
+class Chronometre
+{
+public:
+    Chronometre();
+    long ecoule() const;
+    long arreter(const char *p_phase);
+
+    static void activerTrace(std::ostream *p_flux);
+
+private:
+    std::chrono::steady_clock::time_point m_debut;
+};
+
+//! \brief Compteurs matériels (cycles, instructions, défauts de cache) du processus, via perf_event_open (Linux)
+//! \note disponible() est faux si le noyau ou la machine virtuelle ne les expose pas; les valeurs restent alors nulles
+class CompteursMateriel
+{
+public:
+    CompteursMateriel();
+    ~CompteursMateriel();
+    bool disponible() const;
+    void demarrer();
+    void arreter();
+    uint64_t getCycles() const;
+    uint64_t getInstructions() const;
+    uint64_t getDefautsCache() const;
+
+private:
+    CompteursMateriel(const CompteursMateriel &);
+    CompteursMateriel &operator=(const CompteursMateriel &);
+
+    int m_descripteurs[3]; //cycles, instructions, défauts de cache (-1 si indisponible)
+    uint64_t m_valeurs[3];
+};
+
+long lireMemoireKo(const std::string &p_champ);
+
+//! \brief Suit la mémoire résidente (VmRSS) du processus sur un fil d'arrière-plan, pour en connaître le pic sur
+//! une période, sans toucher aux compteurs globaux du noyau (VmHWM, ru_maxrss)
+//! \note un échantillon toutes les getPeriode() millisecondes: un pic plus bref peut échapper à la mesure.
+//! Sans /proc/self/status, les valeurs restent nulles
+class EchantillonneurMemoire
+{
+public:
+    explicit EchantillonneurMemoire(unsigned int p_periodeMs = 2);
+    ~EchantillonneurMemoire();
+    EchantillonneurMemoire(const EchantillonneurMemoire &) = delete;
+    EchantillonneurMemoire &operator=(const EchantillonneurMemoire &) = delete;
+
+    long getDebut() const;
+    long getPointe() const;
+    void reinitialiser();
+
+private:
+    void echantillonner();
+
+    mutable std::mutex m_verrou;
+    std::condition_variable m_reveil;
+    bool m_arret;
+    mutable long m_debut; //VmRSS à la construction ou au dernier reinitialiser(), en Ko
+    mutable long m_pointe; //le plus grand échantillon depuis, en Ko
+    std::chrono::milliseconds m_periode;
+    std::thread m_fil;
+};
+
+#endif //TP2_STATISTIQUES_H
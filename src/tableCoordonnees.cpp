@@ -0,0 +1,258 @@
+//
+//  tableCoordonnees.cpp
+//  Distances à vol d'oiseau calculées par lots (structure de tableaux, SSE2/AVX lorsque disponibles)
+//
+
+#include "tableCoordonnees.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define TABLE_COORDONNEES_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    const double rayonTerre = 6371.0; //en km, comme Coordonnees::operator-
+    const double degre = M_PI / 180.0;
+    const double piSur2 = M_PI / 2.0;
+
+    //asin(u) = u + u^3 (c[0] + c[1] u^2 + c[2] u^4 + ...): la série de Taylor, utilisée pour u <= 1/2 seulement.
+    //22 termes y suffisent à la précision d'un double (le terme suivant est inférieur à 1e-16 u)
+    const size_t nbTermes = 22;
+
+    struct SerieArcsinus
+    {
+        double c[nbTermes];
+
+        SerieArcsinus()
+        {
+            double b = 1.0; //(2n)! / (4^n (n!)^2)
+            for (size_t n = 1; n <= nbTermes; ++n)
+            {
+                b *= (2.0 * n - 1.0) / (2.0 * n);
+                c[n - 1] = b / (2.0 * n + 1.0);
+            }
+        }
+    };
+
+    const SerieArcsinus serie;
+
+    //distances de (p_x, p_y, p_z) aux points [p_debut, p_fin) d'une table, une à la fois.
+    //les noyaux vectoriels font exactement les mêmes opérations, dans le même ordre
+    void noyauScalaire(const double *p_xs, const double *p_ys, const double *p_zs, size_t p_debut, size_t p_fin,
+                       double p_x, double p_y, double p_z, double *p_distances)
+    {
+        for (size_t i = p_debut; i < p_fin; ++i)
+        {
+            const double dx = p_xs[i] - p_x, dy = p_ys[i] - p_y, dz = p_zs[i] - p_z;
+            const double h = min(sqrt(dx * dx + dy * dy + dz * dz) * 0.5, 1.0); //le sinus du demi-angle
+            //au-delà de 1/2, asin(h) = pi/2 - 2 asin(sqrt((1 - h) / 2)) ramène l'argument sous 1/2
+            const bool grand = h > 0.5;
+            const double u = grand ? sqrt((1.0 - h) * 0.5) : h;
+            const double w = u * u;
+            double p = serie.c[nbTermes - 1];
+            for (size_t k = nbTermes - 1; k-- > 0;) p = p * w + serie.c[k];
+            const double a = u + (u * w) * p;
+            p_distances[i] = (grand ? piSur2 - (a + a) : a) * (2.0 * rayonTerre);
+        }
+    }
+
+#ifdef TABLE_COORDONNEES_X86
+    void noyauSSE2(const double *p_xs, const double *p_ys, const double *p_zs, size_t p_n, double p_x, double p_y,
+                   double p_z, double *p_distances)
+    {
+        const __m128d x = _mm_set1_pd(p_x), y = _mm_set1_pd(p_y), z = _mm_set1_pd(p_z);
+        const __m128d demi = _mm_set1_pd(0.5), un = _mm_set1_pd(1.0);
+        size_t i = 0;
+        for (; i + 2 <= p_n; i += 2)
+        {
+            const __m128d dx = _mm_sub_pd(_mm_loadu_pd(p_xs + i), x);
+            const __m128d dy = _mm_sub_pd(_mm_loadu_pd(p_ys + i), y);
+            const __m128d dz = _mm_sub_pd(_mm_loadu_pd(p_zs + i), z);
+            const __m128d corde2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+            const __m128d h = _mm_min_pd(_mm_mul_pd(_mm_sqrt_pd(corde2), demi), un);
+            const __m128d grand = _mm_cmpgt_pd(h, demi);
+            const __m128d reduit = _mm_sqrt_pd(_mm_mul_pd(_mm_sub_pd(un, h), demi));
+            const __m128d u = _mm_or_pd(_mm_and_pd(grand, reduit), _mm_andnot_pd(grand, h));
+            const __m128d w = _mm_mul_pd(u, u);
+            __m128d p = _mm_set1_pd(serie.c[nbTermes - 1]);
+            for (size_t k = nbTermes - 1; k-- > 0;) p = _mm_add_pd(_mm_mul_pd(p, w), _mm_set1_pd(serie.c[k]));
+            const __m128d a = _mm_add_pd(u, _mm_mul_pd(_mm_mul_pd(u, w), p));
+            const __m128d complement = _mm_sub_pd(_mm_set1_pd(piSur2), _mm_add_pd(a, a));
+            const __m128d angle = _mm_or_pd(_mm_and_pd(grand, complement), _mm_andnot_pd(grand, a));
+            _mm_storeu_pd(p_distances + i, _mm_mul_pd(angle, _mm_set1_pd(2.0 * rayonTerre)));
+        }
+        noyauScalaire(p_xs, p_ys, p_zs, i, p_n, p_x, p_y, p_z, p_distances);
+    }
+
+    __attribute__((target("avx")))
+    void noyauAVX(const double *p_xs, const double *p_ys, const double *p_zs, size_t p_n, double p_x, double p_y,
+                  double p_z, double *p_distances)
+    {
+        const __m256d x = _mm256_set1_pd(p_x), y = _mm256_set1_pd(p_y), z = _mm256_set1_pd(p_z);
+        const __m256d demi = _mm256_set1_pd(0.5), un = _mm256_set1_pd(1.0);
+        size_t i = 0;
+        for (; i + 4 <= p_n; i += 4)
+        {
+            const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(p_xs + i), x);
+            const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(p_ys + i), y);
+            const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(p_zs + i), z);
+            const __m256d corde2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                                                 _mm256_mul_pd(dz, dz));
+            const __m256d h = _mm256_min_pd(_mm256_mul_pd(_mm256_sqrt_pd(corde2), demi), un);
+            const __m256d grand = _mm256_cmp_pd(h, demi, _CMP_GT_OQ);
+            const __m256d u = _mm256_blendv_pd(h, _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(un, h), demi)), grand);
+            const __m256d w = _mm256_mul_pd(u, u);
+            __m256d p = _mm256_set1_pd(serie.c[nbTermes - 1]);
+            for (size_t k = nbTermes - 1; k-- > 0;)
+                p = _mm256_add_pd(_mm256_mul_pd(p, w), _mm256_set1_pd(serie.c[k]));
+            const __m256d a = _mm256_add_pd(u, _mm256_mul_pd(_mm256_mul_pd(u, w), p));
+            const __m256d complement = _mm256_sub_pd(_mm256_set1_pd(piSur2), _mm256_add_pd(a, a));
+            _mm256_storeu_pd(p_distances + i,
+                             _mm256_mul_pd(_mm256_blendv_pd(a, complement, grand), _mm256_set1_pd(2.0 * rayonTerre)));
+        }
+        noyauScalaire(p_xs, p_ys, p_zs, i, p_n, p_x, p_y, p_z, p_distances);
+    }
+#endif
+
+    JeuInstructions meilleurJeu()
+    {
+        if (TableCoordonnees::estDisponible(JeuInstructions::avx)) return JeuInstructions::avx;
+        if (TableCoordonnees::estDisponible(JeuInstructions::sse2)) return JeuInstructions::sse2;
+        return JeuInstructions::scalaire;
+    }
+
+    //le jeu d'instructions choisi, commun à toutes les tables; -1 tant que meilleurJeu() n'a pas été consulté
+    atomic<int> jeuChoisi(-1);
+}
+
+TableCoordonnees::TableCoordonnees()
+{
+}
+
+TableCoordonnees::TableCoordonnees(const vector<Coordonnees> &p_points)
+{
+    m_x.reserve(p_points.size());
+    m_y.reserve(p_points.size());
+    m_z.reserve(p_points.size());
+    for (auto &point : p_points) ajouter(point);
+}
+
+//! \brief ajoute un point à la fin de la table (son indice est taille() - 1)
+void TableCoordonnees::ajouter(const Coordonnees &p_point)
+{
+    const double latitude = p_point.getLatitude() * degre;
+    const double longitude = p_point.getLongitude() * degre;
+    m_x.push_back(cos(latitude) * cos(longitude));
+    m_y.push_back(cos(latitude) * sin(longitude));
+    m_z.push_back(sin(latitude));
+}
+
+void TableCoordonnees::vider()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+}
+
+size_t TableCoordonnees::taille() const
+{
+    return m_x.size();
+}
+
+//! \brief distances (en km) de p_point à chacun des points de la table
+//! \param[out] p_distances: redimensionné à taille(); p_distances[i] est la distance de p_point au point i
+void TableCoordonnees::distancesDepuis(const Coordonnees &p_point, vector<double> &p_distances) const
+{
+    const double latitude = p_point.getLatitude() * degre;
+    const double longitude = p_point.getLongitude() * degre;
+    p_distances.resize(taille());
+    distancesDepuis(cos(latitude) * cos(longitude), cos(latitude) * sin(longitude), sin(latitude), 0, taille(),
+                    p_distances.data());
+}
+
+//! \brief distances (en km) de chacun des points de la table à chacun des points de p_autres
+//! \param[out] p_matrice: redimensionnée à taille() * p_autres.taille(), par rangées: p_matrice[i * p_autres.taille() + j]
+//! est la distance du point i de cette table au point j de p_autres
+void TableCoordonnees::distancesEntre(const TableCoordonnees &p_autres, vector<double> &p_matrice) const
+{
+    const size_t n = p_autres.taille();
+    p_matrice.resize(taille() * n);
+    for (size_t i = 0; i < taille(); ++i)
+        p_autres.distancesDepuis(m_x[i], m_y[i], m_z[i], 0, n, p_matrice.data() + i * n);
+}
+
+//! \brief distances (en km) du point p_indice de la table aux points d'indices [p_debut, p_fin) de la même table
+//! \param[out] p_distances: redimensionné à p_fin - p_debut; p_distances[k] est la distance au point p_debut + k
+//! \note sert aux index spatiaux: les points d'une même cellule sont rangés consécutivement dans la table
+void TableCoordonnees::distancesDepuis(size_t p_indice, size_t p_debut, size_t p_fin, vector<double> &p_distances) const
+{
+    p_distances.resize(p_fin - p_debut);
+    distancesDepuis(m_x[p_indice], m_y[p_indice], m_z[p_indice], p_debut, p_fin, p_distances.data());
+}
+
+//le noyau: distances du vecteur unitaire (p_x, p_y, p_z) aux points [p_debut, p_fin) de la table, avec le jeu
+//d'instructions choisi; p_distances reçoit p_fin - p_debut distances
+void TableCoordonnees::distancesDepuis(double p_x, double p_y, double p_z, size_t p_debut, size_t p_fin,
+                                       double *p_distances) const
+{
+    const double *xs = m_x.data() + p_debut, *ys = m_y.data() + p_debut, *zs = m_z.data() + p_debut;
+    switch (getJeuInstructions())
+    {
+#ifdef TABLE_COORDONNEES_X86
+        case JeuInstructions::avx:
+            noyauAVX(xs, ys, zs, p_fin - p_debut, p_x, p_y, p_z, p_distances);
+            break;
+        case JeuInstructions::sse2:
+            noyauSSE2(xs, ys, zs, p_fin - p_debut, p_x, p_y, p_z, p_distances);
+            break;
+#endif
+        default:
+            noyauScalaire(xs, ys, zs, 0, p_fin - p_debut, p_x, p_y, p_z, p_distances);
+    }
+}
+
+//! \return le jeu d'instructions utilisé par les calculs de distances (par défaut, le meilleur disponible)
+JeuInstructions TableCoordonnees::getJeuInstructions()
+{
+    int jeu = jeuChoisi.load(memory_order_relaxed);
+    if (jeu < 0)
+    {
+        jeu = static_cast<int>(meilleurJeu());
+        jeuChoisi.store(jeu, memory_order_relaxed);
+    }
+    return static_cast<JeuInstructions>(jeu);
+}
+
+//! \return vrai si le processeur (et le compilateur) permettent d'utiliser p_jeu
+bool TableCoordonnees::estDisponible(JeuInstructions p_jeu)
+{
+    switch (p_jeu)
+    {
+        case JeuInstructions::scalaire:
+            return true;
+#ifdef TABLE_COORDONNEES_X86
+        case JeuInstructions::sse2:
+            return true; //toujours présent en x86-64
+        case JeuInstructions::avx:
+            return __builtin_cpu_supports("avx");
+#endif
+        default:
+            return false;
+    }
+}
+
+//! \brief impose un jeu d'instructions à toutes les tables (pour comparer les noyaux entre eux)
+//! \throws logic_error si p_jeu n'est pas disponible
+void TableCoordonnees::choisirJeuInstructions(JeuInstructions p_jeu)
+{
+    if (!estDisponible(p_jeu))
+        throw logic_error("TableCoordonnees::choisirJeuInstructions(): jeu d'instructions non disponible");
+    jeuChoisi.store(static_cast<int>(p_jeu), memory_order_relaxed);
+}
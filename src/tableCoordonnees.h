@@ -0,0 +1,54 @@
+//
+//  tableCoordonnees.h
+//  Distances à vol d'oiseau calculées par lots (structure de tableaux, SSE2/AVX lorsque disponibles)
+//
+
+#ifndef TP2_TABLECOORDONNEES_H
+#define TP2_TABLECOORDONNEES_H
+
+#include <vector>
+#include <cstddef>
+
+#include "coordonnees.h"
+
+//! \brief le jeu d'instructions utilisé par les calculs de distances par lots
+enum class JeuInstructions { scalaire, sse2, avx };
+
+//! \brief Table de coordonnées GPS rangées en structure de tableaux, pour calculer des distances par lots
+//! \note Coordonnees::operator- recalcule sin, cos et acos à chaque appel. Ici, chaque point est converti une seule
+//! fois en vecteur unitaire (x, y, z) sur la sphère; la distance devient 2R asin(|p - q| / 2), dont la racine et
+//! l'arcsinus (polynôme) se calculent sur 2 (SSE2) ou 4 (AVX) distances à la fois, sans appel à la libm.
+//! \note le rayon terrestre est celui de Coordonnees::operator- (6371 km). operator- perd de la précision dans acos
+//! pour les points rapprochés: de l'ordre de 1e-6 km à quelques km, jusqu'à 1.3e-4 km (ou NaN) pour deux points
+//! confondus; les distances de la table restent à 1e-11 km près de la valeur exacte. Pour garder les résultats
+//! d'operator-, on se sert de la table comme filtre: seuls les points à moins de seuil + margeOperateur sont
+//! recalculés par operator-
+class TableCoordonnees
+{
+public:
+    TableCoordonnees();
+    explicit TableCoordonnees(const std::vector<Coordonnees> &p_points);
+
+    void ajouter(const Coordonnees &p_point);
+    void vider();
+    size_t taille() const;
+
+    void distancesDepuis(const Coordonnees &p_point, std::vector<double> &p_distances) const;
+    void distancesEntre(const TableCoordonnees &p_autres, std::vector<double> &p_matrice) const;
+    void distancesDepuis(size_t p_indice, size_t p_debut, size_t p_fin, std::vector<double> &p_distances) const;
+
+    static constexpr double margeOperateur = 1e-4; //en km, couvre largement l'écart avec operator- au-delà de 100 m
+
+    static JeuInstructions getJeuInstructions();
+    static bool estDisponible(JeuInstructions p_jeu);
+    static void choisirJeuInstructions(JeuInstructions p_jeu);
+
+private:
+    void distancesDepuis(double p_x, double p_y, double p_z, size_t p_debut, size_t p_fin, double *p_distances) const;
+
+    std::vector<double> m_x; //m_x[i], m_y[i], m_z[i]: le vecteur unitaire du point i
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+};
+
+#endif //TP2_TABLECOORDONNEES_H
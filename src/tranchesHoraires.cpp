@@ -0,0 +1,870 @@
+//
+//  tranchesHoraires.cpp
+//  Le réseau découpé en tranches horaires (une heure par défaut), construites en parallèle et projetées à la demande
+//
+
+#include "tranchesHoraires.h"
+
+#include <algorithm>
+#include <thread>
+#include <queue>
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+const unsigned int TranchesHoraires::largeurParDefaut;
+
+namespace
+{
+    const char magique[8] = {'G', 'T', 'F', 'S', 'T', 'H', '0', '2'};
+    const size_t alignementTranches = 4096; //les tranches commencent sur une page
+    const uint32_t aucun = numeric_limits<uint32_t>::max();
+
+    //l'en-tête du fichier (64 octets)
+    struct Entete
+    {
+        char magique[8];
+        uint32_t nbTranches;
+        uint32_t largeur;
+        uint32_t nbArrets;
+        uint32_t nbStations;
+        uint32_t nbVoyages;
+        uint32_t tempsDebut;
+        uint32_t tempsFin;
+        uint32_t reserve;
+        double distanceMaxMarche;
+        double vitesseMarche;
+        uint64_t tailleIds; //les trip_id, mis bout à bout
+    };
+
+    //une entrée du répertoire des tranches, qui suit l'en-tête
+    struct EntreeRepertoire
+    {
+        uint32_t premier;
+        uint32_t nbSommets;
+        uint32_t nbArcs;
+        uint32_t heureDebut;
+        uint64_t position;
+    };
+
+    //une station, après le répertoire des tranches; viennent ensuite la ligne de chaque voyage, la fin du trip_id
+    //de chaque voyage puis les trip_id
+    struct EntreeStation
+    {
+        double latitude;
+        double longitude;
+        uint32_t stationId;
+        uint32_t derniereHeure;
+    };
+
+    size_t aligner(size_t p_position)
+    {
+        return (p_position + alignementTranches - 1) / alignementTranches * alignementTranches;
+    }
+
+    size_t tailleTranche(size_t p_nbSommets, size_t p_nbArcs, size_t p_nbStations)
+    {
+        return 5 * p_nbSommets + 1 + p_nbStations + 1 + 2 * p_nbArcs;
+    }
+}
+
+TranchesHoraires::Tranche::Tranche()
+    : premier(0), nbSommets(0), nbArcs(0), heureDebut(0), position(0), donnees(nullptr), projection(nullptr)
+{
+}
+
+size_t TranchesHoraires::Tranche::taille(size_t p_nbStations) const
+{
+    return tailleTranche(nbSommets, nbArcs, p_nbStations);
+}
+
+void TranchesHoraires::Vue::decouper(const uint32_t *p_donnees, const Tranche &p_tranche, size_t p_nbStations)
+{
+    debuts = p_donnees;
+    stations = debuts + p_tranche.nbSommets + 1;
+    voyages = stations + p_tranche.nbSommets;
+    heures = voyages + p_tranche.nbSommets;
+    debutsArrets = heures + p_tranche.nbSommets;
+    arrets = debutsArrets + p_nbStations + 1;
+    destinations = arrets + p_tranche.nbSommets;
+    poids = destinations + p_tranche.nbArcs;
+}
+
+TranchesHoraires::TranchesHoraires()
+    : m_largeur(largeurParDefaut), m_nbArrets(0), m_tempsDebut(0), m_tempsFin(0), m_distanceMaxMarche(0),
+      m_vitesseMarche(0), m_descripteur(-1), m_nbProjetees(0)
+{
+}
+
+TranchesHoraires::~TranchesHoraires()
+{
+    liberer();
+}
+
+//! \brief libère les tranches projetées et le fichier ouvert par charger(), s'il y a lieu
+void TranchesHoraires::liberer()
+{
+    for (Tranche &tranche : m_tranches)
+        if (tranche.projection) munmap(tranche.projection, tranche.taille(m_idDeStation.size()) * sizeof(uint32_t));
+    if (m_descripteur >= 0) close(m_descripteur);
+    m_descripteur = -1;
+    m_fichier.clear();
+    m_tranches.clear();
+    m_premiers.clear();
+    m_heuresDebut.clear();
+    m_nbArrets = 0;
+    m_idDeStation.clear();
+    m_coordonnees.clear();
+    m_coordsStations.vider();
+    m_derniereHeure.clear();
+    m_idDuVoyage.clear();
+    m_ligneDuVoyage.clear();
+    m_nbProjetees = 0;
+}
+
+//! \brief découpe le réseau en tranches de p_largeur secondes
+//! \param[in] p_reseau: un réseau renuméroté par heure, sans points origine et destination; p_gtfs: les données qui
+//! l'ont construit. Les tranches en gardent tout ce que demande calculerItineraire(): les deux peuvent être
+//! détruits ensuite
+//! \param[in] p_largeur: la largeur d'une tranche, en secondes; les tranches commencent à un multiple de p_largeur
+//! depuis minuit, et les heures sans aucun arrêt n'en ont pas
+//! \param[in] p_nbFils: le nombre de fils d'exécution (0: autant que de coeurs); un fil libre prend la prochaine
+//! tranche non construite
+//! \throws logic_error si p_largeur est nulle, si le réseau n'est pas renuméroté par heure, s'il a des points
+//! origine et destination, si les données ne sont pas les siennes, ou si un arc remonte le temps
+void TranchesHoraires::construire(const ReseauGTFS &p_reseau, const DonneesGTFS &p_gtfs, unsigned int p_largeur,
+                                  unsigned int p_nbFils)
+{
+    if (p_largeur == 0) throw logic_error("TranchesHoraires::construire(): largeur nulle");
+    if (p_nbFils == 0) p_nbFils = max(1u, thread::hardware_concurrency());
+    const GrapheAbstrait &graphe = p_reseau.getGraphe();
+    const size_t premierSortie = p_reseau.getPremierSommetSortie();
+    const size_t nbStations = p_reseau.getNbSommetsSortie();
+    const auto &stationMap = p_gtfs.getStations();
+    if (graphe.getNbSommets() != premierSortie + nbStations)
+        throw logic_error("TranchesHoraires::construire(): le réseau a des points origine et destination");
+    if (graphe.getNbSommets() >= numeric_limits<uint32_t>::max())
+        throw logic_error("TranchesHoraires::construire(): trop de sommets");
+    if (stationMap.size() != nbStations)
+        throw logic_error("TranchesHoraires::construire(): les données ne sont pas celles du réseau");
+
+    //les bornes des tranches, en un parcours des arrêts (getHeureDuSommet() refuse un sommet qui n'en est pas un)
+    struct Bornes
+    {
+        uint32_t premier;
+        uint32_t nbSommets;
+        uint32_t heureDebut;
+    };
+    vector<Bornes> descriptions;
+    unsigned int precedente = 0;
+    for (size_t v = 0; v < premierSortie; ++v)
+    {
+        const unsigned int heure = p_reseau.getHeureDuSommet(v);
+        if (heure < precedente)
+            throw logic_error("TranchesHoraires::construire(): le réseau n'est pas renuméroté par heure");
+        precedente = heure;
+        if (descriptions.empty() || heure >= descriptions.back().heureDebut + p_largeur)
+        {
+            descriptions.push_back(Bornes{static_cast<uint32_t>(v), 0, heure / p_largeur * p_largeur});
+        }
+        ++descriptions.back().nbSommets;
+    }
+
+    //les arrêts de chaque station dans l'ordre de Station::getArrets() (par heure d'arrivée), pour les sources
+    //des requêtes; leurs heures suivent celles des sommets, et donc celles des tranches
+    vector<uint32_t> debutsStation(1, 0), sommetsStation, stationDuSommet(premierSortie, aucun);
+    sommetsStation.reserve(premierSortie);
+    liberer();
+    for (const auto &stationPair : stationMap)
+    {
+        const uint32_t s = static_cast<uint32_t>(m_idDeStation.size());
+        uint32_t derniere = aucun;
+        for (const auto &arretPair : stationPair.second.getArrets())
+        {
+            const size_t v = p_reseau.getSommetDeArret(arretPair.second);
+            derniere = static_cast<uint32_t>(arretPair.first - Heure(0, 0, 0));
+            if (v >= premierSortie || stationDuSommet[v] != aucun || p_reseau.getHeureDuSommet(v) != derniere)
+            {
+                liberer();
+                throw logic_error("TranchesHoraires::construire(): les arrêts des stations ne sont pas ceux du réseau");
+            }
+            stationDuSommet[v] = s;
+            sommetsStation.push_back(static_cast<uint32_t>(v));
+        }
+        debutsStation.push_back(static_cast<uint32_t>(sommetsStation.size()));
+        m_idDeStation.push_back(stationPair.first);
+        m_coordonnees.push_back(stationPair.second.getCoords());
+        m_coordsStations.ajouter(stationPair.second.getCoords());
+        m_derniereHeure.push_back(derniere);
+    }
+    if (sommetsStation.size() != premierSortie)
+    {
+        liberer();
+        throw logic_error("TranchesHoraires::construire(): les arrêts des stations ne sont pas ceux du réseau");
+    }
+
+    m_idDuVoyage = p_reseau.getIdDuVoyage();
+    for (uint32_t voyage = 0; voyage < m_idDuVoyage.size(); ++voyage)
+        m_ligneDuVoyage.push_back(p_reseau.getLigneDuVoyage(voyage));
+
+    vector<Tranche>(descriptions.size()).swap(m_tranches);
+    for (size_t k = 0; k < descriptions.size(); ++k)
+    {
+        m_tranches[k].premier = descriptions[k].premier;
+        m_tranches[k].nbSommets = descriptions[k].nbSommets;
+        m_tranches[k].heureDebut = descriptions[k].heureDebut;
+        m_premiers.push_back(descriptions[k].premier);
+        m_heuresDebut.push_back(descriptions[k].heureDebut);
+    }
+    m_largeur = p_largeur;
+    m_nbArrets = premierSortie;
+    m_tempsDebut = static_cast<unsigned int>(p_gtfs.getTempsDebut() - Heure(0, 0, 0));
+    m_tempsFin = static_cast<unsigned int>(p_gtfs.getTempsFin() - Heure(0, 0, 0));
+    m_distanceMaxMarche = p_reseau.getDistMaxMarche();
+    m_vitesseMarche = p_reseau.getVitesseMarche();
+
+    atomic<size_t> prochaine(0);
+    atomic<bool> arcInvalide(false);
+    auto travailler = [&]()
+    {
+        vector<pair<size_t, unsigned int> > arcs;
+        vector<uint32_t> debuts, stations, voyages, heures, debutsArrets, arrets, destinations, poids;
+        auto heureDuSommet = [&](uint32_t p_sommet) { return p_reseau.getHeureDuSommet(p_sommet); };
+        for (size_t k = prochaine++; k < m_tranches.size(); k = prochaine++)
+        {
+            Tranche &tranche = m_tranches[k];
+            debuts.assign(1, 0);
+            stations.clear();
+            voyages.clear();
+            heures.clear();
+            destinations.clear();
+            poids.clear();
+            for (size_t v = tranche.premier; v < tranche.premier + tranche.nbSommets; ++v)
+            {
+                graphe.getArcsSortants(v, arcs);
+                bool sortie = false;
+                for (const auto &arc : arcs)
+                {
+                    if (arc.first >= premierSortie)
+                    {
+                        //l'arc vers le sommet de sortie de la station: un seul, de poids nul
+                        if (sortie || arc.second != 0 || arc.first - premierSortie != stationDuSommet[v])
+                            arcInvalide = true;
+                        sortie = true;
+                        continue;
+                    }
+                    if (arc.first < tranche.premier) arcInvalide = true;
+                    destinations.push_back(static_cast<uint32_t>(arc.first));
+                    poids.push_back(arc.second);
+                }
+                if (!sortie) arcInvalide = true;
+                stations.push_back(stationDuSommet[v]);
+                voyages.push_back(p_reseau.getVoyageDuSommet(v));
+                heures.push_back(p_reseau.getHeureDuSommet(v));
+                debuts.push_back(static_cast<uint32_t>(destinations.size()));
+            }
+
+            //les arrêts de chaque station dans la tranche: ceux dont l'heure est dans [heureDebut, heureDebut + largeur)
+            debutsArrets.assign(1, 0);
+            arrets.clear();
+            for (size_t s = 0; s < nbStations; ++s)
+            {
+                auto debut = sommetsStation.begin() + debutsStation[s];
+                auto fin = sommetsStation.begin() + debutsStation[s + 1];
+                debut = partition_point(debut, fin, [&](uint32_t v) { return heureDuSommet(v) < tranche.heureDebut; });
+                fin = partition_point(debut, fin,
+                                      [&](uint32_t v) { return heureDuSommet(v) < tranche.heureDebut + m_largeur; });
+                for (auto it = debut; it != fin; ++it) arrets.push_back(*it - tranche.premier);
+                debutsArrets.push_back(static_cast<uint32_t>(arrets.size()));
+            }
+
+            tranche.nbArcs = static_cast<uint32_t>(destinations.size());
+            tranche.construite.reserve(tranche.taille(nbStations));
+            tranche.construite = debuts;
+            for (const vector<uint32_t> *tableau : {&stations, &voyages, &heures, &debutsArrets, &arrets, &destinations,
+                                                    &poids})
+                tranche.construite.insert(tranche.construite.end(), tableau->begin(), tableau->end());
+            tranche.donnees = tranche.construite.data();
+        }
+    };
+    vector<thread> fils;
+    for (unsigned int f = 1; f < p_nbFils; ++f) fils.push_back(thread(travailler));
+    travailler();
+    for (auto &f : fils) f.join();
+    if (arcInvalide)
+    {
+        liberer();
+        throw logic_error("TranchesHoraires::construire(): un arc remonte le temps ou mène à une autre station");
+    }
+}
+
+//! \brief Écrit les tranches dans un fichier binaire: un en-tête, le répertoire (tranches, stations et voyages),
+//! puis chaque tranche à partir d'une page (voir charger())
+//! \throws logic_error si aucune tranche n'est construite ou si le fichier ne peut être écrit
+void TranchesHoraires::sauvegarder(const string &p_fichier) const
+{
+    if (m_tranches.empty()) throw logic_error("TranchesHoraires::sauvegarder(): aucune tranche");
+    const size_t nbStations = m_idDeStation.size();
+    vector<uint32_t> finIds;
+    string ids;
+    for (const string &id : m_idDuVoyage)
+    {
+        ids += id;
+        finIds.push_back(static_cast<uint32_t>(ids.size()));
+    }
+
+    Entete entete;
+    memcpy(entete.magique, magique, sizeof(magique));
+    entete.nbTranches = static_cast<uint32_t>(m_tranches.size());
+    entete.largeur = m_largeur;
+    entete.nbArrets = static_cast<uint32_t>(m_nbArrets);
+    entete.nbStations = static_cast<uint32_t>(nbStations);
+    entete.nbVoyages = static_cast<uint32_t>(m_idDuVoyage.size());
+    entete.tempsDebut = m_tempsDebut;
+    entete.tempsFin = m_tempsFin;
+    entete.reserve = 0;
+    entete.distanceMaxMarche = m_distanceMaxMarche;
+    entete.vitesseMarche = m_vitesseMarche;
+    entete.tailleIds = ids.size();
+
+    vector<EntreeStation> stations;
+    for (size_t s = 0; s < nbStations; ++s)
+        stations.push_back(EntreeStation{m_coordonnees[s].getLatitude(), m_coordonnees[s].getLongitude(),
+                                         m_idDeStation[s], m_derniereHeure[s]});
+
+    vector<EntreeRepertoire> repertoire;
+    size_t ecrits = sizeof(Entete) + m_tranches.size() * sizeof(EntreeRepertoire) +
+                    nbStations * sizeof(EntreeStation) + 2 * m_idDuVoyage.size() * sizeof(uint32_t) + ids.size();
+    size_t position = aligner(ecrits);
+    for (const Tranche &tranche : m_tranches)
+    {
+        repertoire.push_back(EntreeRepertoire{tranche.premier, tranche.nbSommets, tranche.nbArcs, tranche.heureDebut,
+                                              position});
+        position = aligner(position + tranche.taille(nbStations) * sizeof(uint32_t));
+    }
+
+    ofstream flux(p_fichier, ios::binary);
+    if (!flux) throw logic_error("TranchesHoraires::sauvegarder(): impossible d'écrire " + p_fichier);
+    flux.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    flux.write(reinterpret_cast<const char *>(repertoire.data()), repertoire.size() * sizeof(EntreeRepertoire));
+    flux.write(reinterpret_cast<const char *>(stations.data()), stations.size() * sizeof(EntreeStation));
+    for (uint32_t ligne : m_ligneDuVoyage) flux.write(reinterpret_cast<const char *>(&ligne), sizeof(ligne));
+    flux.write(reinterpret_cast<const char *>(finIds.data()), finIds.size() * sizeof(uint32_t));
+    flux.write(ids.data(), ids.size());
+    for (size_t k = 0; k < m_tranches.size(); ++k)
+    {
+        flux.write(string(repertoire[k].position - ecrits, '\0').data(), repertoire[k].position - ecrits);
+        const size_t octets = m_tranches[k].taille(nbStations) * sizeof(uint32_t);
+        flux.write(reinterpret_cast<const char *>(getDonnees(k)), octets);
+        ecrits = repertoire[k].position + octets;
+    }
+    if (!flux) throw logic_error("TranchesHoraires::sauvegarder(): erreur d'écriture dans " + p_fichier);
+}
+
+//! \brief Ouvre un fichier écrit par TranchesHoraires::sauvegarder()
+//! \note seuls l'en-tête et le répertoire sont lus; chaque tranche est projetée (mmap) et vérifiée la première
+//! fois qu'une requête la lit, et le fichier reste ouvert jusqu'à la destruction
+//! \throws logic_error si le fichier est illisible ou si son en-tête ou son répertoire n'a pas le format attendu
+void TranchesHoraires::charger(const string &p_fichier)
+{
+    int descripteur = open(p_fichier.c_str(), O_RDONLY);
+    if (descripteur < 0) throw logic_error("TranchesHoraires::charger(): impossible de lire " + p_fichier);
+    struct stat infos;
+    Entete entete = Entete();
+    vector<char> lu;
+    bool valide = fstat(descripteur, &infos) == 0 && static_cast<size_t>(infos.st_size) >= sizeof(Entete) &&
+                  pread(descripteur, &entete, sizeof(entete), 0) == static_cast<ssize_t>(sizeof(entete)) &&
+                  memcmp(entete.magique, magique, sizeof(magique)) == 0 && entete.largeur != 0 &&
+                  entete.nbTranches != 0 && entete.tempsDebut < entete.tempsFin &&
+                  entete.distanceMaxMarche >= 0 && entete.vitesseMarche > 0;
+    const size_t octetsRepertoire = static_cast<size_t>(entete.nbTranches) * sizeof(EntreeRepertoire);
+    const size_t octetsStations = static_cast<size_t>(entete.nbStations) * sizeof(EntreeStation);
+    const size_t octetsVoyages = 2 * static_cast<size_t>(entete.nbVoyages) * sizeof(uint32_t);
+    if (valide)
+    {
+        const uint64_t taille = octetsRepertoire + octetsStations + octetsVoyages + entete.tailleIds;
+        valide = entete.tailleIds <= static_cast<uint64_t>(infos.st_size) &&
+                 sizeof(Entete) + taille <= static_cast<uint64_t>(infos.st_size);
+        if (valide)
+        {
+            lu.resize(taille);
+            valide = pread(descripteur, lu.data(), taille, sizeof(Entete)) == static_cast<ssize_t>(taille);
+        }
+    }
+    vector<EntreeRepertoire> repertoire(valide ? entete.nbTranches : 0);
+    vector<EntreeStation> stations(valide ? entete.nbStations : 0);
+    vector<uint32_t> lignes(valide ? entete.nbVoyages : 0), finIds(valide ? entete.nbVoyages : 0);
+    if (valide)
+    {
+        const char *p = lu.data();
+        memcpy(repertoire.data(), p, octetsRepertoire);
+        memcpy(stations.data(), p += octetsRepertoire, octetsStations);
+        memcpy(lignes.data(), p += octetsStations, octetsVoyages / 2);
+        memcpy(finIds.data(), p += octetsVoyages / 2, octetsVoyages / 2);
+    }
+    //les tranches couvrent tous les arrêts, dans l'ordre, et tiennent dans le fichier
+    size_t attendu = 0;
+    for (size_t k = 0; valide && k < repertoire.size(); ++k)
+    {
+        const EntreeRepertoire &entree = repertoire[k];
+        const size_t taille = tailleTranche(entree.nbSommets, entree.nbArcs, entete.nbStations) * sizeof(uint32_t);
+        valide = entree.premier == attendu && entree.nbSommets != 0 && entree.position % alignementTranches == 0 &&
+                 entree.position + taille <= static_cast<uint64_t>(infos.st_size) &&
+                 (k == 0 || entree.heureDebut > repertoire[k - 1].heureDebut);
+        attendu += entree.nbSommets;
+    }
+    for (size_t v = 0; valide && v < finIds.size(); ++v)
+        valide = finIds[v] >= (v == 0 ? 0 : finIds[v - 1]) && finIds[v] <= entete.tailleIds;
+    for (size_t s = 0; valide && s < stations.size(); ++s)
+        valide = Coordonnees::is_valide_coord(stations[s].latitude, stations[s].longitude);
+    if (!valide || attendu != entete.nbArrets)
+    {
+        close(descripteur);
+        throw logic_error("TranchesHoraires::charger(): format invalide dans " + p_fichier);
+    }
+
+    liberer();
+    vector<Tranche>(repertoire.size()).swap(m_tranches);
+    for (size_t k = 0; k < repertoire.size(); ++k)
+    {
+        m_tranches[k].premier = repertoire[k].premier;
+        m_tranches[k].nbSommets = repertoire[k].nbSommets;
+        m_tranches[k].nbArcs = repertoire[k].nbArcs;
+        m_tranches[k].heureDebut = repertoire[k].heureDebut;
+        m_tranches[k].position = repertoire[k].position;
+        m_premiers.push_back(repertoire[k].premier);
+        m_heuresDebut.push_back(repertoire[k].heureDebut);
+    }
+    for (const EntreeStation &station : stations)
+    {
+        m_idDeStation.push_back(station.stationId);
+        m_coordonnees.push_back(Coordonnees(station.latitude, station.longitude));
+        m_coordsStations.ajouter(m_coordonnees.back());
+        m_derniereHeure.push_back(station.derniereHeure);
+    }
+    const char *ids = lu.data() + octetsRepertoire + octetsStations + octetsVoyages;
+    for (size_t v = 0; v < finIds.size(); ++v)
+    {
+        const uint32_t debut = v == 0 ? 0 : finIds[v - 1];
+        m_idDuVoyage.push_back(string(ids + debut, ids + finIds[v]));
+    }
+    m_ligneDuVoyage.assign(lignes.begin(), lignes.end());
+    m_largeur = entete.largeur;
+    m_nbArrets = entete.nbArrets;
+    m_tempsDebut = entete.tempsDebut;
+    m_tempsFin = entete.tempsFin;
+    m_distanceMaxMarche = entete.distanceMaxMarche;
+    m_vitesseMarche = entete.vitesseMarche;
+    m_descripteur = descripteur;
+    m_fichier = p_fichier;
+}
+
+//! \return les données de la tranche d'indice p_indice, projetées à leur premier accès si elles viennent de charger()
+//! \throws logic_error si la projection échoue ou si la tranche est incohérente
+const uint32_t *TranchesHoraires::getDonnees(size_t p_indice) const
+{
+    const Tranche &tranche = m_tranches[p_indice];
+    const uint32_t *donnees = tranche.donnees.load(memory_order_acquire);
+    if (donnees) return donnees;
+
+    lock_guard<mutex> verrou(m_verrouProjection);
+    donnees = tranche.donnees.load(memory_order_relaxed);
+    if (donnees) return donnees;
+    const size_t nbStations = m_idDeStation.size();
+    const size_t octets = tranche.taille(nbStations) * sizeof(uint32_t);
+    void *projection = mmap(nullptr, octets, PROT_READ, MAP_SHARED, m_descripteur, tranche.position);
+    if (projection == MAP_FAILED)
+        throw logic_error("TranchesHoraires: mmap() a échoué pour une tranche de " + m_fichier);
+
+    //une tranche corrompue ne doit pas mener une recherche hors des tableaux
+    Vue vue;
+    vue.decouper(static_cast<const uint32_t *>(projection), tranche, nbStations);
+    bool valide = vue.debuts[0] == 0 && vue.debuts[tranche.nbSommets] == tranche.nbArcs &&
+                  vue.debutsArrets[0] == 0 && vue.debutsArrets[nbStations] == tranche.nbSommets;
+    for (size_t i = 0; valide && i < tranche.nbSommets; ++i)
+        valide = vue.debuts[i] <= vue.debuts[i + 1] && vue.stations[i] < nbStations &&
+                 vue.voyages[i] < m_idDuVoyage.size() && vue.heures[i] >= tranche.heureDebut &&
+                 vue.heures[i] - tranche.heureDebut < m_largeur && vue.arrets[i] < tranche.nbSommets;
+    for (size_t s = 0; valide && s < nbStations; ++s) valide = vue.debutsArrets[s] <= vue.debutsArrets[s + 1];
+    for (size_t a = 0; valide && a < tranche.nbArcs; ++a)
+        valide = vue.destinations[a] >= tranche.premier && vue.destinations[a] < m_nbArrets;
+    if (!valide)
+    {
+        munmap(projection, octets);
+        throw logic_error("TranchesHoraires: tranche invalide dans " + m_fichier);
+    }
+
+    tranche.projection = projection;
+    ++m_nbProjetees;
+    tranche.donnees.store(vue.debuts, memory_order_release);
+    return vue.debuts;
+}
+
+//! \return les tableaux de la tranche d'indice p_indice (voir getDonnees())
+TranchesHoraires::Vue TranchesHoraires::getVue(size_t p_indice) const
+{
+    Vue vue;
+    vue.decouper(getDonnees(p_indice), m_tranches[p_indice], m_idDeStation.size());
+    return vue;
+}
+
+//! \return l'indice de la tranche d'un sommet d'arrêt
+size_t TranchesHoraires::trancheDuSommet(size_t p_sommet) const
+{
+    return upper_bound(m_premiers.begin(), m_premiers.end(), p_sommet) - m_premiers.begin() - 1;
+}
+
+//! \return l'indice de la première tranche pouvant avoir un arrêt à l'heure p_heure (ou après)
+size_t TranchesHoraires::trancheDeLHeure(unsigned int p_heure) const
+{
+    const size_t k = upper_bound(m_heuresDebut.begin(), m_heuresDebut.end(), p_heure) - m_heuresDebut.begin();
+    return k == 0 ? 0 : k - 1;
+}
+
+//! \return le sommet du premier arrêt de la station d'indice p_station à l'heure p_heure ou après (celui de
+//! Station::getArrets().lower_bound()), numeric_limits<size_t>::max() s'il n'y en a pas
+//! \note les tranches sans arrêt de la station entre p_heure et celui-ci sont projetées, mais pas parcourues
+size_t TranchesHoraires::premierArret(size_t p_station, unsigned int p_heure) const
+{
+    if (m_derniereHeure[p_station] == aucun || p_heure > m_derniereHeure[p_station])
+        return numeric_limits<size_t>::max();
+    for (size_t k = trancheDeLHeure(p_heure); k < m_tranches.size(); ++k)
+    {
+        const Vue vue = getVue(k);
+        const uint32_t *debut = vue.arrets + vue.debutsArrets[p_station];
+        const uint32_t *fin = vue.arrets + vue.debutsArrets[p_station + 1];
+        const uint32_t *trouve = partition_point(debut, fin, [&](uint32_t i) { return vue.heures[i] < p_heure; });
+        if (trouve != fin) return m_tranches[k].premier + *trouve;
+    }
+    return numeric_limits<size_t>::max();
+}
+
+//! \brief les sommets d'un chemin de plusCourtChemin(), lus dans les tranches
+class TranchesHoraires::Sommets : public SommetsHoraires
+{
+public:
+    explicit Sommets(const TranchesHoraires &p_tranches) : m_tranches(p_tranches) {}
+    bool estSommetSortie(size_t) const { return false; } //le chemin s'arrête au dernier arrêt
+    unsigned int stationDuSommet(size_t p_sommet) const
+    {
+        return m_tranches.m_idDeStation[lire(p_sommet, &Vue::stations)];
+    }
+    uint32_t voyageDuSommet(size_t p_sommet) const { return lire(p_sommet, &Vue::voyages); }
+    unsigned int heureDuSommet(size_t p_sommet) const { return lire(p_sommet, &Vue::heures); }
+    unsigned int ligneDuVoyage(uint32_t p_voyage) const { return m_tranches.m_ligneDuVoyage[p_voyage]; }
+
+private:
+    uint32_t lire(size_t p_sommet, const uint32_t *Vue::*p_tableau) const
+    {
+        const size_t k = m_tranches.trancheDuSommet(p_sommet);
+        return (m_tranches.getVue(k).*p_tableau)[p_sommet - m_tranches.m_premiers[k]];
+    }
+
+    const TranchesHoraires &m_tranches;
+};
+
+//! \brief Trouve l'itinéraire d'une requête dans les tranches, comme ReseauGTFS::calculerItineraire() avec un
+//! EspaceRequete (sans le cache)
+//! \param[in] p_depart: l'heure de départ du point origine, dans l'intervalle des données du réseau découpé
+//! \param[in,out] p_espace: les tableaux de travail de cette requête
+//! \param[out] p_tranchesTouchees: si non nul, reçoit le nombre de tranches où un sommet a été fixé
+//! \return le même itinéraire que le réseau découpé (durée égale; le chemin peut différer entre deux chemins de
+//! même durée)
+//! \throws logic_error si aucune tranche n'est construite ou chargée, ou si p_depart est hors de l'intervalle
+Itineraire TranchesHoraires::calculerItineraire(const Coordonnees &p_pointOrigine,
+                                                const Coordonnees &p_pointDestination, const Heure &p_depart,
+                                                EspaceTranches &p_espace, size_t *p_tranchesTouchees) const
+{
+    preparerRequete(p_pointOrigine, p_pointDestination, p_depart, p_espace);
+    unsigned int tempsDuTrajet = plusCourtChemin(p_espace, p_tranchesTouchees);
+
+    //les points origine et destination, absents des tranches, ont des numéros qu'aucun sommet ne peut avoir
+    const size_t origine = numeric_limits<size_t>::max() - 1;
+    const size_t destination = numeric_limits<size_t>::max();
+    p_espace.chemin.insert(p_espace.chemin.begin(), origine);
+    p_espace.chemin.push_back(destination);
+    return decoderChemin(Sommets(*this), p_espace.chemin, tempsDuTrajet, p_depart - Heure(0, 0, 0), origine,
+                         destination);
+}
+
+//! \brief Calcule les sources et les cibles d'une requête, comme ReseauGTFS::preparerRequete()
+//! \post p_espace.sources: pour chaque station à distance de marche de l'origine, le premier arrêt atteignable
+//! à pieds après p_depart et la durée depuis p_depart
+//! \post p_espace.cibles: l'indice de chaque station ayant des arrêts à distance de marche de la destination, et
+//! la durée de marche vers celle-ci
+//! \throws logic_error si aucune tranche n'est construite ou chargée, ou si p_depart est hors de l'intervalle
+void TranchesHoraires::preparerRequete(const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination,
+                                       const Heure &p_depart, EspaceTranches &p_espace) const
+{
+    if (m_tranches.empty()) throw logic_error("TranchesHoraires::preparerRequete(): aucune tranche");
+    const unsigned int depart = static_cast<unsigned int>(p_depart - Heure(0, 0, 0));
+    if (depart < m_tempsDebut || depart >= m_tempsFin)
+        throw logic_error("TranchesHoraires::preparerRequete(): l'heure de départ est hors de l'intervalle des données");
+
+    m_coordsStations.distancesDepuis(p_pointOrigine, p_espace.distancesOrigine);
+    m_coordsStations.distancesDepuis(p_pointDestination, p_espace.distancesDestination);
+    const double seuil = m_distanceMaxMarche + TableCoordonnees::margeOperateur;
+    p_espace.sources.clear();
+    p_espace.cibles.clear();
+
+    for (size_t s = 0; s < m_idDeStation.size(); ++s)
+    {
+        if (p_espace.distancesOrigine[s] <= seuil)
+        {
+            double distance = m_coordonnees[s] - p_pointOrigine;
+            if (distance <= m_distanceMaxMarche)
+            {
+                double travelTime = (distance / m_vitesseMarche) * 3600;
+                const size_t sommet =
+                    premierArret(s, static_cast<unsigned int>(p_depart.add_secondes(travelTime) - Heure(0, 0, 0)));
+                if (sommet != numeric_limits<size_t>::max())
+                {
+                    const size_t k = trancheDuSommet(sommet);
+                    p_espace.sources.push_back({sommet, getVue(k).heures[sommet - m_premiers[k]] - depart});
+                }
+            }
+        }
+        if (p_espace.distancesDestination[s] <= seuil && m_derniereHeure[s] != aucun)
+        {
+            double distance = p_pointDestination - m_coordonnees[s];
+            if (distance <= m_distanceMaxMarche)
+            {
+                int weight = (distance / m_vitesseMarche) * 3600;
+                p_espace.cibles.push_back({s, weight});
+            }
+        }
+    }
+}
+
+//! \brief Algorithme de Dijkstra à plusieurs sources et plusieurs cibles sur les tranches, comme
+//! GrapheAbstrait::plusCourtCheminMultiple() sur le graphe du réseau
+//! \param[in,out] p_espace: p_espace.sources (des sommets d'arrêts) et p_espace.cibles (des indices de stations)
+//! viennent de preparerRequete(); p_espace.chemin reçoit les sommets du meilleur chemin, d'une source au dernier
+//! arrêt (vide si aucun), et p_espace.stats les compteurs de la recherche
+//! \param[out] p_tranchesTouchees: si non nul, reçoit le nombre de tranches où un sommet a été fixé
+//! \return la meilleure durée, numeric_limits<unsigned int>::max() si aucune cible n'est atteignable
+//! \note un sommet fixé à la distance d appartient à la tranche de l'heure de départ + d, et la recherche s'arrête
+//! dès que d atteint la meilleure durée connue: les tranches suivantes ne sont ni lues, ni projetées, ni
+//! allouées dans p_espace
+//! \throws logic_error lorsqu'une source n'est pas un arrêt ou qu'une cible n'est pas une station
+unsigned int TranchesHoraires::plusCourtChemin(EspaceTranches &p_espace, size_t *p_tranchesTouchees) const
+{
+    p_espace.stats = StatistiquesRecherche();
+    GTFS_STAT(StatistiquesRecherche stats);
+    if (m_tranches.empty()) throw logic_error("TranchesHoraires::plusCourtChemin(): aucune tranche");
+    const size_t nbStations = m_idDeStation.size();
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    for (const auto &source : p_espace.sources)
+        if (source.first >= m_nbArrets)
+            throw logic_error("TranchesHoraires::plusCourtChemin(): une source n'est pas un arrêt");
+    for (const auto &cible : p_espace.cibles)
+        if (cible.first >= nbStations)
+            throw logic_error("TranchesHoraires::plusCourtChemin(): une cible n'est pas une station");
+
+    vector<vector<unsigned int> > &distance = p_espace.distance;
+    vector<vector<uint32_t> > &predecesseur = p_espace.predecesseur;
+    vector<pair<uint32_t, uint32_t> > &touches = p_espace.touches;
+    vector<unsigned int> &coutCible = p_espace.coutCible;
+    if (distance.size() != m_tranches.size() || coutCible.size() != nbStations)
+    {
+        distance.assign(m_tranches.size(), vector<unsigned int>());
+        predecesseur.assign(m_tranches.size(), vector<uint32_t>());
+        coutCible.assign(nbStations, infini);
+        touches.clear();
+    }
+    else if (!touches.empty()) //une recherche interrompue par une exception
+    {
+        for (const auto &t : touches)
+        {
+            distance[t.first][t.second] = infini;
+            predecesseur[t.first][t.second] = aucun;
+        }
+        touches.clear();
+        coutCible.assign(nbStations, infini);
+    }
+    for (const auto &cible : p_espace.cibles)
+        coutCible[cible.first] = min(coutCible[cible.first], cible.second);
+
+    //la tranche d'un sommet: celle de p_indice, la suivante (les arcs avancent dans le temps), sinon une recherche;
+    //ses tableaux de travail sont alloués à sa première visite
+    auto localiser = [&](uint32_t p_sommet, size_t p_indice) {
+        size_t k = p_indice;
+        if (p_sommet < m_premiers[k] || p_sommet - m_premiers[k] >= m_tranches[k].nbSommets)
+        {
+            k = p_indice + 1 < m_tranches.size() && p_sommet >= m_premiers[p_indice + 1] &&
+                        p_sommet - m_premiers[p_indice + 1] < m_tranches[p_indice + 1].nbSommets
+                    ? p_indice + 1
+                    : trancheDuSommet(p_sommet);
+        }
+        if (distance[k].size() != m_tranches[k].nbSommets)
+        {
+            distance[k].assign(m_tranches[k].nbSommets, infini);
+            predecesseur[k].assign(m_tranches[k].nbSommets, aucun);
+        }
+        return k;
+    };
+
+    typedef pair<unsigned int, uint32_t> Entree;
+    priority_queue<Entree, vector<Entree>, greater<Entree> > q;
+    size_t courante = 0; //la tranche du dernier sommet fixé
+    for (const auto &source : p_espace.sources)
+    {
+        const uint32_t v = static_cast<uint32_t>(source.first);
+        courante = localiser(v, courante);
+        unsigned int &d = distance[courante][v - m_premiers[courante]];
+        if (source.second < d)
+        {
+            if (d == infini) touches.push_back({static_cast<uint32_t>(courante), v - m_premiers[courante]});
+            d = source.second;
+            q.push(Entree(source.second, v));
+            GTFS_STAT(++stats.insertionsFile);
+        }
+    }
+
+    Vue vue = Vue();
+    size_t indiceVue = m_tranches.size(); //la tranche de vue
+    vector<bool> touchee(m_tranches.size(), false);
+    size_t nbTouchees = 0;
+
+    unsigned int meilleur = infini;
+    uint32_t arrivee = aucun;
+    while (!q.empty())
+    {
+        GTFS_STAT(stats.tailleMaxFile = std::max<unsigned long>(stats.tailleMaxFile, q.size()));
+        Entree e = q.top();
+        q.pop();
+        GTFS_STAT(++stats.retraitsFile);
+        const uint32_t uStar = e.second;
+        courante = localiser(uStar, courante);
+        const size_t i = uStar - m_premiers[courante];
+        if (e.first != distance[courante][i]) continue;
+        if (e.first >= meilleur) break;
+        GTFS_STAT(++stats.sommetsFixes);
+
+        if (courante != indiceVue)
+        {
+            vue = getVue(courante);
+            indiceVue = courante;
+            if (!touchee[courante])
+            {
+                touchee[courante] = true;
+                ++nbTouchees;
+            }
+        }
+
+        const unsigned int marche = coutCible[vue.stations[i]];
+        if (marche != infini && e.first + marche < meilleur)
+        {
+            meilleur = e.first + marche;
+            arrivee = uStar;
+        }
+
+        size_t k = courante;
+        for (uint32_t a = vue.debuts[i]; a < vue.debuts[i + 1]; ++a)
+        {
+            GTFS_STAT(++stats.arcsRelaches);
+            const uint32_t v = vue.destinations[a];
+            unsigned int temp = e.first + vue.poids[a];
+            k = localiser(v, k);
+            unsigned int &d = distance[k][v - m_premiers[k]];
+            if (temp < d)
+            {
+                if (d == infini) touches.push_back({static_cast<uint32_t>(k), v - m_premiers[k]});
+                d = temp;
+                predecesseur[k][v - m_premiers[k]] = uStar;
+                q.push(Entree(temp, v));
+                GTFS_STAT(++stats.insertionsFile);
+            }
+        }
+    }
+
+    GTFS_STAT(p_espace.stats = stats);
+    if (p_tranchesTouchees) *p_tranchesTouchees = nbTouchees;
+
+    p_espace.chemin.clear();
+    for (uint32_t numero = arrivee; numero != aucun;)
+    {
+        p_espace.chemin.push_back(numero);
+        const size_t k = trancheDuSommet(numero);
+        numero = predecesseur[k][numero - m_premiers[k]];
+    }
+    reverse(p_espace.chemin.begin(), p_espace.chemin.end());
+
+    for (const auto &t : touches)
+    {
+        distance[t.first][t.second] = infini;
+        predecesseur[t.first][t.second] = aucun;
+    }
+    touches.clear();
+    for (const auto &cible : p_espace.cibles) coutCible[cible.first] = infini;
+    return meilleur;
+}
+
+//! \return les trip_id des voyages, par indice (Troncon::voyage), pour afficherItineraire()
+const vector<string> &TranchesHoraires::getIdDuVoyage() const
+{
+    return m_idDuVoyage;
+}
+
+size_t TranchesHoraires::getNbTranches() const
+{
+    return m_tranches.size();
+}
+
+//! \return le nombre de tranches projetées en mémoire depuis charger() (0 après construire(): tout est en mémoire)
+size_t TranchesHoraires::getNbTranchesProjetees() const
+{
+    return m_nbProjetees;
+}
+
+unsigned int TranchesHoraires::getLargeur() const
+{
+    return m_largeur;
+}
+
+//! \return l'heure (en secondes depuis minuit) où commence la tranche d'indice p_indice
+//! \throws logic_error si l'indice est hors limites
+unsigned int TranchesHoraires::getHeureDebut(size_t p_indice) const
+{
+    if (p_indice >= m_tranches.size()) throw logic_error("TranchesHoraires::getHeureDebut(): indice hors limites");
+    return m_tranches[p_indice].heureDebut;
+}
+
+//! \brief ajoute à p_rapport la mémoire des tranches
+//! \note composants: tranches.repertoire, tranches.stations (identifiants, coordonnées et dernière heure),
+//! tranches.voyages (trip_id et lignes), tranches.construites (sur le tas, après construire()) et
+//! tranches.projetees (les octets projetés depuis le fichier de charger(), hors du tas: le système les charge
+//! et les évince à la demande)
+void TranchesHoraires::mesurerMemoire(RapportMemoire &p_rapport) const
+{
+    const size_t nbStations = m_idDeStation.size();
+    p_rapport.ajouter("tranches.repertoire",
+                      octetsVecteur(m_tranches) + octetsVecteur(m_premiers) + octetsVecteur(m_heuresDebut),
+                      m_tranches.size());
+    p_rapport.ajouter("tranches.stations",
+                      octetsVecteur(m_idDeStation) + octetsVecteur(m_coordonnees) + octetsVecteur(m_derniereHeure) +
+                          (nbStations ? 3 * octetsTas(nbStations * sizeof(double)) : 0),
+                      nbStations);
+    size_t voyages = octetsVecteur(m_idDuVoyage) + octetsVecteur(m_ligneDuVoyage);
+    for (const string &id : m_idDuVoyage) voyages += octetsChaine(id);
+    p_rapport.ajouter("tranches.voyages", voyages, m_idDuVoyage.size());
+    size_t construites = 0, nbConstruites = 0, projetees = 0;
+    for (const Tranche &tranche : m_tranches)
+    {
+        if (!tranche.construite.empty())
+        {
+            construites += octetsVecteur(tranche.construite);
+            ++nbConstruites;
+        }
+        if (tranche.donnees.load() && tranche.projection) projetees += tranche.taille(nbStations) * sizeof(uint32_t);
+    }
+    p_rapport.ajouter("tranches.construites", construites, nbConstruites);
+    p_rapport.ajouter("tranches.projetees", projetees, m_nbProjetees);
+}
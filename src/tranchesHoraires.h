@@ -0,0 +1,145 @@
+//
+//  tranchesHoraires.h
+//  Le réseau découpé en tranches horaires (une heure par défaut), construites en parallèle et projetées à la demande
+//
+
+#ifndef TP2_TRANCHESHORAIRES_H
+#define TP2_TRANCHESHORAIRES_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "itineraire.h"
+#include "tableCoordonnees.h"
+#include "statistiques.h"
+#include "memoire.h"
+
+//! \brief Les tableaux de travail d'une requête de TranchesHoraires::calculerItineraire() (un par fil d'exécution)
+//! \note les distances et les prédécesseurs sont rangés par tranche: ceux d'une tranche sont alloués la première
+//! fois qu'une recherche y atteint un sommet, puis réutilisés d'une requête à l'autre
+struct EspaceTranches
+{
+    std::vector<std::vector<unsigned int> > distance; //par tranche puis par sommet de la tranche; max() si non atteint
+    std::vector<std::vector<uint32_t> > predecesseur; //idem; le numéro (dans le réseau) du sommet précédent
+    std::vector<std::pair<uint32_t, uint32_t> > touches; //(tranche, sommet dans la tranche) dont distance[] a changé
+    std::vector<unsigned int> coutCible; //par station: la durée de marche vers la destination (max() si trop loin)
+    std::vector<double> distancesOrigine; //par station: distance (TableCoordonnees) au point origine
+    std::vector<double> distancesDestination;
+    std::vector<std::pair<size_t, unsigned int> > sources; //(arrêt atteint à pieds, durée depuis le départ)
+    std::vector<std::pair<size_t, unsigned int> > cibles; //(indice de station, durée de marche vers la destination)
+    std::vector<size_t> chemin;
+    StatistiquesRecherche stats; //compteurs de la dernière recherche (si GTFS_STATS est défini)
+};
+
+//! \brief Les arrêts de ReseauGTFS et leurs arcs, regroupés par tranche horaire, avec tout ce qu'une requête
+//! en lit: les tranches suffisent, sans ReseauGTFS ni DonneesGTFS, pour répondre aux requêtes
+//! \note un réseau renuméroté par heure range ses arrêts par heure d'arrivée: une tranche [h, h + largeur) est un
+//! intervalle de sommets consécutifs. Une tranche garde, pour ses sommets, les arcs sortants (en CSR, en numéros du
+//! réseau), la station, le voyage et l'heure; et, pour chaque station, ses arrêts de la tranche dans l'ordre de
+//! Station::getArrets() (pour trouver le premier arrêt atteignable à pieds). L'arc de poids nul de chaque arrêt
+//! vers le sommet de sortie de sa station n'est pas gardé: l'arrivée à une station se lit dans la station du sommet
+//! \note le répertoire (lu par charger()) décrit les tranches et garde les données par station (identifiant,
+//! coordonnées, heure du dernier arrêt) et par voyage (trip_id, ligne): sa taille ne dépend pas du nombre d'arrêts
+//! \note tous les arcs vont vers l'avant dans le temps: la distance d'un arrêt depuis l'heure de départ est son
+//! heure moins celle-ci. calculerItineraire() fixe donc les sommets dans l'ordre des tranches, et s'arrête avant
+//! la première tranche qui commence après la meilleure arrivée connue: seules les tranches entre le départ et
+//! l'arrivée sont lues, et l'EspaceTranches de la requête n'a de tableaux que pour celles-là
+//! \note charger() ne lit que le répertoire; chaque tranche est projetée en mémoire (mmap) au premier accès, et
+//! plusieurs fils peuvent chercher à la fois (chacun avec son EspaceTranches)
+class TranchesHoraires
+{
+public:
+    static const unsigned int largeurParDefaut = 3600;
+
+    TranchesHoraires();
+    ~TranchesHoraires();
+    TranchesHoraires(const TranchesHoraires &) = delete;
+    TranchesHoraires &operator=(const TranchesHoraires &) = delete;
+
+    void construire(const ReseauGTFS &, const DonneesGTFS &, unsigned int = largeurParDefaut, unsigned int = 0);
+    void sauvegarder(const std::string &) const;
+    void charger(const std::string &);
+
+    Itineraire calculerItineraire(const Coordonnees &, const Coordonnees &, const Heure &, EspaceTranches &,
+                                  size_t * = nullptr) const;
+    void preparerRequete(const Coordonnees &, const Coordonnees &, const Heure &, EspaceTranches &) const;
+    unsigned int plusCourtChemin(EspaceTranches &, size_t * = nullptr) const;
+
+    const std::vector<std::string> &getIdDuVoyage() const;
+    size_t getNbTranches() const;
+    size_t getNbTranchesProjetees() const;
+    unsigned int getLargeur() const;
+    unsigned int getHeureDebut(size_t) const;
+    void mesurerMemoire(RapportMemoire &) const;
+
+private:
+    //! \brief une tranche: les sommets [premier, premier + nbSommets); ses données sont, dans l'ordre, les
+    //! nbSommets + 1 débuts d'arcs, les nbSommets stations, voyages et heures, les nbStations + 1 débuts des
+    //! arrêts de chaque station, les nbSommets arrêts (rangs dans la tranche), puis les nbArcs destinations et
+    //! les nbArcs poids
+    struct Tranche
+    {
+        uint32_t premier;
+        uint32_t nbSommets;
+        uint32_t nbArcs;
+        uint32_t heureDebut; //en secondes depuis minuit
+        uint64_t position; //dans le fichier (charger()), alignée sur une page
+        std::vector<uint32_t> construite; //après construire()
+        mutable std::atomic<const uint32_t *> donnees;
+        mutable void *projection; //après charger(), une fois la tranche projetée (munmap() à la destruction)
+
+        Tranche();
+        size_t taille(size_t) const; //en uint32_t, selon le nombre de stations
+    };
+
+    //les tableaux d'une tranche, dans ses données
+    struct Vue
+    {
+        void decouper(const uint32_t *, const Tranche &, size_t);
+
+        const uint32_t *debuts;
+        const uint32_t *stations;
+        const uint32_t *voyages;
+        const uint32_t *heures;
+        const uint32_t *debutsArrets;
+        const uint32_t *arrets;
+        const uint32_t *destinations;
+        const uint32_t *poids;
+    };
+
+    class Sommets; //les sommets d'un chemin, vus par ::decoderChemin()
+
+    const uint32_t *getDonnees(size_t) const;
+    Vue getVue(size_t) const;
+    size_t trancheDuSommet(size_t) const;
+    size_t trancheDeLHeure(unsigned int) const;
+    size_t premierArret(size_t, unsigned int) const;
+    void liberer();
+
+    std::vector<Tranche> m_tranches;
+    std::vector<uint32_t> m_premiers; //le premier sommet de chaque tranche, pour trancheDuSommet()
+    std::vector<uint32_t> m_heuresDebut; //l'heure de début de chaque tranche, pour trancheDeLHeure()
+    unsigned int m_largeur; //en secondes
+    size_t m_nbArrets; //les sommets d'arrêts du réseau
+    unsigned int m_tempsDebut; //l'intervalle des données, en secondes depuis minuit
+    unsigned int m_tempsFin;
+    double m_distanceMaxMarche; //en km
+    double m_vitesseMarche; //en km/h
+    std::vector<unsigned int> m_idDeStation; //par indice de station (ordre de getStations()): le stationId
+    std::vector<Coordonnees> m_coordonnees; //par indice de station
+    TableCoordonnees m_coordsStations; //les mêmes, pour le filtre des stations à distance de marche
+    std::vector<uint32_t> m_derniereHeure; //par indice de station: l'heure de son dernier arrêt (aucun: max())
+    std::vector<std::string> m_idDuVoyage; //par indice de voyage (Troncon::voyage): le trip_id
+    std::vector<unsigned int> m_ligneDuVoyage; //par indice de voyage: l'identifiant de la ligne
+    int m_descripteur; //après charger(): le fichier, ouvert jusqu'à la destruction
+    std::string m_fichier;
+    mutable std::mutex m_verrouProjection;
+    mutable std::atomic<size_t> m_nbProjetees;
+};
+
+#endif //TP2_TRANCHESHORAIRES_H